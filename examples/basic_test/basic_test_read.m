@@ -1,47 +1,210 @@
-more off
-mat1=[1,2;3,4;5,6];
-vec1=[1,2,3,4,5,6,7,8];
-vec2=vec1';
-
-save("-v6", "./basic_test_octave.mat", "vec1", "mat1", "vec2")
-
-load("basic_test.mat", "-v6")
-
-
-disp('vector1=')
-disp(vector1)
-
-disp('vector2=')
-disp(vector2)
-
-disp('struct1=')
-disp(struct1)
-
-
-disp('matrix3d=')
-disp(matrix3d)
-disp('matrix432d=')
-disp(matrix432d)
-
-disp('matrix3d_rowmajor=')
-disp(matrix3d_rowmajor)
-disp('matrix432d_rowmajor=')
-disp(matrix432d_rowmajor)
-
-disp('matrix1=')
-disp(matrix1)
-
-disp('matrix1_ver2=')
-disp(matrix1_ver2)
-
-disp('matrix1_fromcolmajor=')
-disp(matrix1_fromcolmajor)
-class(matrix1_fromcolmajor)
-
-disp('boolmatrix=')
-disp(boolmatrix)
-class(boolmatrix)
-
-disp('mat432i16=')
-disp(mat432i16)
-class(mat432i16)
\ No newline at end of file
+more off
+mat1=[1,2;3,4;5,6];
+vec1=[1,2,3,4,5,6,7,8];
+vec2=vec1';
+
+save("-v6", "./basic_test_octave.mat", "vec1", "mat1", "vec2")
+
+load("basic_test.mat", "-v6")
+
+
+disp('vector1=')
+disp(vector1)
+
+disp('vector2=')
+disp(vector2)
+
+disp('struct1=')
+disp(struct1)
+
+
+disp('matrix3d=')
+disp(matrix3d)
+disp('matrix432d=')
+disp(matrix432d)
+
+disp('matrix3d_rowmajor=')
+disp(matrix3d_rowmajor)
+disp('matrix432d_rowmajor=')
+disp(matrix432d_rowmajor)
+
+disp('matrix1=')
+disp(matrix1)
+
+disp('matrix1_ver2=')
+disp(matrix1_ver2)
+
+disp('matrix1_fromcolmajor=')
+disp(matrix1_fromcolmajor)
+class(matrix1_fromcolmajor)
+
+disp('boolmatrix=')
+disp(boolmatrix)
+class(boolmatrix)
+
+disp('mat432i16=')
+disp(mat432i16)
+class(mat432i16)
+
+disp('sparse_csc=')
+disp(full(sparse_csc))
+disp('sparse_csr=')
+disp(full(sparse_csr))
+disp('sparse_coo=')
+disp(full(sparse_coo))
+isequal(sparse_csc, sparse_csr, sparse_coo)
+disp('sparse_logical=')
+disp(full(sparse_logical))
+class(sparse_logical)
+
+disp('complex_rowmajor=')
+disp(complex_rowmajor)
+disp('complex_colmajor=')
+disp(complex_colmajor)
+isequal(complex_rowmajor, complex_colmajor)
+disp('complex_single=')
+disp(complex_single)
+class(complex_single)
+disp('complex_view=')
+disp(complex_view)
+isequal(complex_view, complex_rowmajor(2:3,:))
+
+disp('ragged_cell=')
+disp(ragged_cell)
+size(ragged_cell{2})
+disp('ragged_cell_single=')
+disp(ragged_cell_single)
+class(ragged_cell_single{4})
+isequal(ragged_cell, cellfun(@double, ragged_cell_single, 'UniformOutput', false))
+
+disp('tensor_permuted=')
+size(tensor_permuted)
+isequal(tensor_permuted, permute(tensor, [3 2 1 4]))
+disp('cube_permuted=')
+size(cube_permuted)
+isequal(cube_permuted, permute(cube, [3 1 2]))
+
+disp('padded_view=')
+disp(padded_view)
+isequal(padded_view, padded(3:8, 4:12))
+
+disp('quantized_int16=')
+disp(quantized_int16)
+isequal(quantized_int16, int16([-32768 -32768 32767 -7 -3 3 1 -1 -7 3 0 32767 -32768 -32768]))
+disp('quantized_uint16=')
+disp(quantized_uint16)
+isequal(quantized_uint16, uint16([0 0 65535 3 65535 1 2 0 3 65535 0 65535]))
+disp('quantized_scaled=')
+disp(double(quantized_scaled)*quantized_scaled_scale+quantized_scaled_offset)
+isequal(quantized_scaled, int16([7 -7 0]))
+class(converted_single)
+
+disp('mask_bits=')
+disp(mask_bits)
+class(mask_bits)
+mask=(mod(0:140, 3)==0 | mod(0:140, 7)==0);
+isequal(mask_bits, reshape(mask, 3, 47))
+isequal(mask_row, mask, mask_column')
+class(mask_row)
+
+disp('string_utf8=')
+disp(string_utf8)
+disp('string_invalid_utf8=')
+disp(string_invalid_utf8)
+disp('strings_utf8=')
+disp(strings_utf8)
+isequal(strings_utf8, {string_utf8, string_invalid_utf8, 'ASCII'})
+
+disp('cell_nested=')
+disp(cell_nested)
+disp(cell_nested{2}.inner)
+isequal(cell_nested, {1, struct('a', 2, 'inner', struct('text', 'nested', 'b', 3)), 'last'})
+
+disp('records=')
+disp(records)
+disp(records(2))
+isequal(size(records), [1 3])
+isequal({records.value}, {[1 2], [3 4], [5 6]})
+isequal({records.label}, {'first', '', 'third'})
+isequal([records.valid], logical([1 0 1]))
+
+c=load("basic_test_compressed.mat");
+disp('compressed=')
+disp(c.compressed(1:3,1:3))
+isequal(c.uncompressed, c.next_compressed, c.after_next, c.compressed, c.streamed)
+isequal(c.struct_uncompressed, c.struct_compressed)
+isequal(c.string_uncompressed, c.string_compressed)
+
+t=load("basic_test_threads.mat");
+disp('fields of basic_test_threads.mat:')
+disp(fieldnames(t)')
+isequal(fieldnames(t)', {'threaded1', 'threaded2', 'threaded3', 'threaded_struct', 'threaded4', 'threaded5', 'threaded6'})
+isequal(t.threaded5, 5*10000+reshape(0:7999, 100, 80))
+isequal(t.threaded_struct.matrix, t.threaded3)
+
+a=load("basic_test_adaptive.mat");
+disp('adaptive compression:')
+isequal(a.smooth, a.raw_smooth, repmat(0:79, 100, 1))
+disp([min(a.noise(:)), max(a.noise(:))])
+disp(a.small)
+
+disp('basic_test_mmap.mat equals basic_test_memory.mat:')
+isequal(load("basic_test_mmap.mat"), load("basic_test_memory.mat"))
+disp('basic_test_stdio.mat equals basic_test_memory.mat:')
+isequal(load("basic_test_stdio.mat"), load("basic_test_memory.mat"))
+
+disp('backend of basic_test_backend.mat:')
+load("basic_test_backend.mat", "backend")
+disp(backend)
+
+disp('output of sinks with and without patch callback:')
+s=load("basic_test_sink.mat");
+sp=load("basic_test_sink_patch.mat");
+isequal(s, sp)
+isequal(rmfield(s, "streamed"), load("basic_test_memory.mat"))
+isequal(s.streamed, repmat(0:79, 100, 1))
+
+disp('basic_test_buffer.mat equals basic_test_memory.mat:')
+isequal(load("basic_test_buffer.mat"), load("basic_test_memory.mat"))
+
+disp('referenced arrays (zero-copy mode):')
+r=load("basic_test_ref.mat");
+isequal(r.copied, r.referenced, r.ref_struct.referenced, r.ref_cell{1}, reshape(uint16(0:59999), 300, 200))
+isequal(r.referenced_2d, r.ref_cell{2}, reshape(r.copied(1:6), 3, 2))
+class(r.referenced)
+
+disp('files written with a memory limit:')
+l=load("basic_test_limit.mat");
+isequal(l, load("basic_test_limit2.mat"))
+isequal(l.limited4, 4*10000+reshape(0:7999, 100, 80))
+
+disp('large row-major arrays:')
+lg=load("basic_test_large.mat");
+size(lg.large)
+isequal(lg.large, lg.large_1thread, (0:1000)'*10000+(0:1502))
+size(lg.large3d)
+isequal(lg.large3d, repmat(single((0:1022)'*10000+(0:516)), [1, 1, 3]))
+
+disp('row-major arrays equal the transpose of their memory in column-major order:')
+tr=load("basic_test_transpose.mat");
+names=fieldnames(tr);
+for i=1:numel(names)
+	if isempty(strfind(names{i}, '_t'))
+		printf('%s (%s, %dx%d): %d\n', names{i}, class(tr.(names{i})), rows(tr.(names{i})), columns(tr.(names{i})), isequal(tr.(names{i}), tr.([names{i} '_t'])'))
+	end
+end
+
+disp('multi-channel images equal their interleaved values split into planes:')
+ch=load("basic_test_channels.mat");
+for n={'rgb_uint8', 'rgba_uint8', 'rgb_single', 'rgba_single'}
+	img=ch.(n{1});
+	printf('%s (%s, %dx%dx%d): %d\n', n{1}, class(img), size(img, 1), size(img, 2), size(img, 3), isequal(img, permute(reshape(ch.([n{1} '_raw']), size(img, 3), size(img, 2), size(img, 1)), [3 2 1])))
+end
+
+disp('arrays with narrowed storage keep their class and values:')
+nw=load("basic_test_narrow.mat");
+for n={'uint8', 'int16', 'uint32', 'int32', 'neg_zero', 'nan'}
+	printf('%s: %s %d\n', n{1}, class(nw.(['narrow_' n{1}])), isequaln(nw.(['narrow_' n{1}]), nw.(['wide_' n{1}])) && strcmp(class(nw.(['narrow_' n{1}])), class(nw.(['wide_' n{1}]))))
+end
+disp('-0 stays -0:')
+1./nw.narrow_neg_zero(2)
\ No newline at end of file
@@ -1,131 +1,691 @@
-/*
-    Copyright (c) 2008-2020 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
-
-    This software is free software: you can redistribute it and/or modify
-    it under the terms of the GNU Lesser General Public License (LGPL) as published by
-    the Free Software Foundation, either version 2 of the License, or
-    (at your option) any later version.
-
-    This program is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with this program.  If not, see <http://www.gnu.org/licenses/>.
-
-
-*/
-
-
-#define _USE_MATH_DEFINES
-#include <iostream>
-#include <stdio.h>
-#include "tinymatwriter.h"
-#include <cmath>
-
-using namespace std;
-
-
-int main( int argc, const char* argv[] ) {
-    TinyMATWriterFile* mat=TinyMATWriter_open("basic_test.mat");
-	if (mat) {
-	    // a matrix in row-major form
-		double mat1[6]={
-			1,2,
-			3,4,
-			5,6
-		};
-		int32_t mat1_size[2] = {2,3};
-		// a matrix in column-major form (the same matrix as mat1)!!!
-		double mat1cm[6]={
-			1,3,5,
-			2,4,6
-		};
-		// a data vector
-		double vec1[8]={1,2,3,4,5,6,7,8};
-		// a 3D matrix in row-major
-		double mat3[3*3*3]= {
-		    1,2,3,
-			4,5,6,
-			7,8,9,
-			
-			10,20,30,
-			40,50,60,
-			70,80,90,
-			
-			100,200,300,
-			400,500,600,
-			700,800,900
-		};
-		int32_t mat3_size[3] = {3,3,3};
-		// another 3D matrix in row-major
-		double mat432[4*3*2]= {
-		    1,2,3,
-			4,5,6,
-			
-			10,20,30,
-			40,50,60,
-			
-			100,200,300,
-			400,500,600,
-			
-			1000,2000,3000,
-			4000,5000,6000,
-		};
-		int32_t mat432_size[3] = {3,2,4}; // columns, rows, matrices,...
-		int16_t mat432i16[4*3*2]= {
-		    1,2,3,
-			4,5,6,
-			
-			10,20,30,
-			40,50,60,
-			
-			100,200,300,
-			400,500,600,
-			
-			1000,-2000,3000,
-			-4000,5000,-6000,
-		};
-		int32_t mat432i16_size[3] = {3,2,4}; // columns, rows, matrices,...
-		
-		// a boolean matrix
-		bool matb[4*3*2] = {
-			true,false,true,
-			false,true,false,
-			
-			true,true,true,
-			false,false,false,
-			
-			true,false,true,
-			true,false,true,
-			
-			true,true,false,
-			false,true,true
-		};
-		int32_t matb_size[3] = {3,2,4}; // columns, rows, matrices,...
-		
-		// a struct as a map of doubles
-		std::map<std::string, double> mp1;
-		mp1["x"]=100;
-		mp1["y"]=200;
-		mp1["z"]=300;
-		mp1["longname"]=10000*M_PI;
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector1", vec1, 1,8);
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector2", vec1, 8,1);
-		TinyMATWriter_writeStruct(mat, "struct1", mp1);
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "matrix1", mat1, 2,3);
-		TinyMATWriter_writeMatrix2D_colmajor(mat, "matrix1_fromcolmajor", mat1cm, 2,3);
-		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix1_ver2", mat1, mat1_size, 2);
-		
-		TinyMATWriter_writeMatrixND_colmajor(mat, "matrix3d", mat3, mat3_size, 3);
-		TinyMATWriter_writeMatrixND_colmajor(mat, "matrix432d", mat432, mat432_size, 3);
-		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix3d_rowmajor", mat3, mat3_size, 3);
-		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix432d_rowmajor", mat432, mat432_size, 3);
-		TinyMATWriter_writeMatrixND_rowmajor(mat, "boolmatrix", matb, matb_size, 3);
-		TinyMATWriter_writeMatrixND_rowmajor(mat, "mat432i16", mat432i16, mat432i16_size, 3);
-
-		TinyMATWriter_close(mat);
-	}
-    return 0;
-}
+/*
+    Copyright (c) 2008-2020 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+
+#define _USE_MATH_DEFINES
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include "tinymatwriter.h"
+#include <cmath>
+
+using namespace std;
+
+// prints how a compressed variable was stored (see TinyMATWriter_setCompressionReport() )
+static void printCompressionDecision(const TinyMATWriterCompressionDecision* decision, void* /*userdata*/) {
+	std::cout<<decision->name<<": level "<<decision->level<<" (reason "<<decision->reason<<"), "<<decision->raw_size<<" -> "<<decision->stored_size
+	         <<" bytes, ratio "<<double(decision->stored_size)/double(decision->raw_size)<<", sample ratio "<<decision->sample_ratio<<"\n";
+}
+
+// writes the same variables into each file, which is written with a different backend
+static void writeBackendTest(TinyMATWriterFile* mat) {
+	std::vector<double> bmat(200*150);
+	for (size_t i=0; i<bmat.size(); i++) bmat[i]=i;
+	int32_t bmat_size[2] = {150,200}; // columns, rows
+	int32_t bcell_size[2] = {1,2}; // rows, columns
+	TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix", bmat.data(), bmat_size, 2);
+	TinyMATWriter_startStruct(mat, "struct");
+	TinyMATWriter_writeValue(mat, "value", 42.0);
+	TinyMATWriter_startCellArray(mat, "cell", bcell_size, 2);
+	TinyMATWriter_writeString(mat, "", "text");
+	TinyMATWriter_writeMatrix2D_rowmajor(mat, "", bmat.data(), 3,2);
+	TinyMATWriter_endCellArray(mat);
+	TinyMATWriter_endStruct(mat);
+	// a top-level cell array with a struct inside
+	TinyMATWriter_startCellArray(mat, "cell", bcell_size, 2);
+	TinyMATWriter_startStruct(mat, "");
+	TinyMATWriter_writeValue(mat, "value", 1.0);
+	TinyMATWriter_startStruct(mat, "inner");
+	TinyMATWriter_writeString(mat, "text", "nested");
+	TinyMATWriter_endStruct(mat);
+	TinyMATWriter_endStruct(mat);
+	TinyMATWriter_writeValue(mat, "", 2.0);
+	TinyMATWriter_endCellArray(mat);
+	TinyMATWriter_writeString(mat, "string", "written last");
+}
+
+// returns the contents of a file without the 128 byte header, which contains the date
+static std::string readFileData(const char* filename) {
+	std::string data;
+	FILE* f=fopen(filename, "rb");
+	if (f) {
+		char buf[4096];
+		size_t n;
+		while ((n=fread(buf, 1, sizeof(buf), f))>0) data.append(buf, n);
+		fclose(f);
+	}
+	return (data.size()>128)?data.substr(128):std::string();
+}
+
+// sink callbacks (see TinyMATWriter_openSink() ), that collect the output in a std::string
+static size_t appendToString(const void* data, size_t bytes, void* context) {
+	static_cast<std::string*>(context)->append(static_cast<const char*>(data), bytes);
+	return bytes;
+}
+static int patchString(uint64_t offset, const void* data, size_t bytes, void* context) {
+	std::string* output=static_cast<std::string*>(context);
+	if (offset+bytes>output->size()) return FALSE;
+	output->replace(static_cast<size_t>(offset), bytes, static_cast<const char*>(data), bytes);
+	return TRUE;
+}
+
+// writes data into a new file
+static void writeFileData(const char* filename, const std::string& data) {
+	FILE* f=fopen(filename, "wb");
+	if (f) {
+		fwrite(data.data(), 1, data.size(), f);
+		fclose(f);
+	}
+}
+
+// writes a rows x cols matrix in row-major order, and as name_t the same memory in column-major order, i.e. its transpose
+template<typename T>
+static void writeTransposeTest(TinyMATWriterFile* mat, const std::string& name, int32_t cols, int32_t rows, uint32_t modulus) {
+	T* data=new T[cols*rows];
+	for (int32_t i=0; i<cols*rows; i++) data[i]=static_cast<T>((i*7)%modulus);
+	TinyMATWriter_writeMatrix2D_rowmajor(mat, name.c_str(), data, cols, rows);
+	TinyMATWriter_writeMatrix2D_colmajor(mat, (name+"_t").c_str(), data, rows, cols);
+	delete[] data;
+}
+
+// writes a rows x cols image with c interleaved channels in row-major order, and as name_raw the interleaved values as a vector
+template<typename T>
+static void writeMultiChannelTest(TinyMATWriterFile* mat, const std::string& name, int32_t cols, int32_t rows, uint32_t c) {
+	T* data=new T[cols*rows*c];
+	for (int32_t i=0; i<cols*rows*static_cast<int32_t>(c); i++) data[i]=static_cast<T>((i*13)%251);
+	int32_t size[2] = {cols,rows};
+	TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name.c_str(), data, size, 2, c);
+	TinyMATWriter_writeVectorAsColumn(mat, (name+"_raw").c_str(), data, cols*rows*c);
+	delete[] data;
+}
+
+// prints the result of a check and counts the failed checks
+static int failedChecks=0;
+static void check(const std::string& what, bool ok) {
+	std::cout<<what<<": "<<(ok?"OK":"FAILED")<<"\n";
+	if (!ok) failedChecks++;
+}
+
+// the backend, that TINYMAT_BACKEND_MMAP and TINYMAT_BACKEND_AUTO for large files use on this system
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#  define EXPECTED_MMAP_BACKEND TINYMAT_BACKEND_MMAP
+#  define EXPECTED_LARGE_BACKEND TINYMAT_BACKEND_MMAP
+#else
+#  define EXPECTED_MMAP_BACKEND TINYMAT_BACKEND_MEMORY
+#  define EXPECTED_LARGE_BACKEND TINYMAT_BACKEND_STDIO
+#endif
+
+
+int main( int argc, const char* argv[] ) {
+    TinyMATWriterFile* mat=TinyMATWriter_open("basic_test.mat");
+	if (mat) {
+	    // a matrix in row-major form
+		double mat1[6]={
+			1,2,
+			3,4,
+			5,6
+		};
+		int32_t mat1_size[2] = {2,3};
+		// a matrix in column-major form (the same matrix as mat1)!!!
+		double mat1cm[6]={
+			1,3,5,
+			2,4,6
+		};
+		// a data vector
+		double vec1[8]={1,2,3,4,5,6,7,8};
+		// a 3D matrix in row-major
+		double mat3[3*3*3]= {
+		    1,2,3,
+			4,5,6,
+			7,8,9,
+			
+			10,20,30,
+			40,50,60,
+			70,80,90,
+			
+			100,200,300,
+			400,500,600,
+			700,800,900
+		};
+		int32_t mat3_size[3] = {3,3,3};
+		// another 3D matrix in row-major
+		double mat432[4*3*2]= {
+		    1,2,3,
+			4,5,6,
+			
+			10,20,30,
+			40,50,60,
+			
+			100,200,300,
+			400,500,600,
+			
+			1000,2000,3000,
+			4000,5000,6000,
+		};
+		int32_t mat432_size[3] = {3,2,4}; // columns, rows, matrices,...
+		int16_t mat432i16[4*3*2]= {
+		    1,2,3,
+			4,5,6,
+			
+			10,20,30,
+			40,50,60,
+			
+			100,200,300,
+			400,500,600,
+			
+			1000,-2000,3000,
+			-4000,5000,-6000,
+		};
+		int32_t mat432i16_size[3] = {3,2,4}; // columns, rows, matrices,...
+		
+		// a boolean matrix
+		bool matb[4*3*2] = {
+			true,false,true,
+			false,true,false,
+			
+			true,true,true,
+			false,false,false,
+			
+			true,false,true,
+			true,false,true,
+			
+			true,true,false,
+			false,true,true
+		};
+		int32_t matb_size[3] = {3,2,4}; // columns, rows, matrices,...
+		
+		// a struct as a map of doubles
+		std::map<std::string, double> mp1;
+		mp1["x"]=100;
+		mp1["y"]=200;
+		mp1["z"]=300;
+		mp1["longname"]=10000*M_PI;
+		
+		// a sparse 3x4 matrix [1 0 0 2; 0 3 0 0; 0 0 4 5] in compressed sparse column (CSC) form
+		int32_t sp_colptr[5]={0,1,2,3,5};
+		int32_t sp_rowind[5]={0,1,2,0,2};
+		double sp_csc[5]={1,3,4,2,5};
+		// ... the same matrix in compressed sparse row (CSR) form
+		int32_t sp_rowptr[4]={0,2,3,5};
+		int32_t sp_colind[5]={0,3,1,2,3};
+		double sp_csr[5]={1,2,3,4,5};
+		// ... and as list of coordinates (COO) in any order
+		int32_t sp_coorow[5]={2,0,1,0,2};
+		int32_t sp_coocol[5]={3,0,1,3,2};
+		double sp_coo[5]={5,1,3,2,4};
+		
+		// a complex matrix in row-major form (3 rows, 2 columns), real and imaginary parts are interleaved
+		std::complex<double> matc[6]={
+			{1,1},{2,-1},
+			{3,0.5},{4,0},
+			{5,2},{6,-3}
+		};
+		int32_t matc_size[2] = {2,3}; // columns, rows
+		// the same matrix in column-major form, as double and float
+		std::complex<double> matccm[6]={
+			{1,1},{3,0.5},{5,2},
+			{2,-1},{4,0},{6,-3}
+		};
+		std::complex<float> matccmf[6]={
+			{1,1},{3,0.5},{5,2},
+			{2,-1},{4,0},{6,-3}
+		};
+		int32_t matccm_size[2] = {3,2}; // rows, columns
+		// a view on the last two rows of matc, which is written without a copy
+		int32_t matcv_size[2] = {2,2}; // rows, columns
+		int64_t matcv_strides[2] = {2*sizeof(std::complex<double>), sizeof(std::complex<double>)};
+		TinyMATWriterView<std::complex<double> > matcv;
+		matcv.data=&matc[2];
+		matcv.sizes=matcv_size;
+		matcv.strides=matcv_strides;
+		matcv.ndims=2;
+		
+		// ragged data: 4 traces with 1, 0, 2 and 3 values, stored one after the other
+		double rg_values[6]={1,2,3,4,5,6};
+		uint64_t rg_offsets[5]={0,1,1,3,6};
+		int32_t rg_size[2] = {1,4}; // rows, columns
+		// the same traces as vector of vectors
+		std::vector<std::vector<float> > rg_vec(4);
+		rg_vec[0].push_back(1);
+		rg_vec[2].push_back(2); rg_vec[2].push_back(3);
+		rg_vec[3].push_back(4); rg_vec[3].push_back(5); rg_vec[3].push_back(6);
+		
+		// a C-order NHWC tensor (N=2, H=4, W=5, C=3), which is written as HxWxCxN array
+		double tensor[2*4*5*3];
+		for (int i=0; i<2*4*5*3; i++) tensor[i]=i;
+		int32_t tensor_size[4] = {3,5,4,2}; // C, W, H, N (the first axis varies fastest)
+		uint32_t tensor_perm[4] = {2,1,0,3};
+		// a 6x7x8 uint8 array, whose last axis becomes the first
+		uint8_t cube[6*7*8];
+		for (int i=0; i<6*7*8; i++) cube[i]=(uint8_t)i;
+		int32_t cube_size[3] = {6,7,8};
+		uint32_t cube_perm[3] = {2,0,1};
+		
+		// a row-major 10x13 int16 image, whose rows are padded to 16 values, and a view on the 6x9 submatrix starting at row 2, column 3
+		int16_t padded[10*16];
+		for (int i=0; i<10*16; i++) padded[i]=(i%16<13)?(int16_t)i:-1;
+		int32_t paddedv_size[2] = {6,9}; // rows, columns
+		int64_t paddedv_strides[2] = {16*sizeof(int16_t), sizeof(int16_t)};
+		TinyMATWriterView<int16_t> paddedv;
+		paddedv.data=&padded[2*16+3];
+		paddedv.sizes=paddedv_size;
+		paddedv.strides=paddedv_strides;
+		paddedv.ndims=2;
+		
+		// values, which are quantized to int16 and uint16 while they are written: NaN, saturation and ties, which are rounded away from zero,
+		// the first 8 values are converted with SSE2, the rest one by one
+		double qi16[14]={NAN, -1e6, 1e6, -6.5, -2.5, 2.5, 0.5, -0.5, -6.5, 2.5, 0.49999999999999994, 1e6, NAN, -1e6};
+		float qu16[12]={NAN, -5, 70000, 2.5f, 65534.5f, 0.5f, 1.5f, -0.4f, 2.5f, 65534.5f, NAN, 1e9f};
+		double qscaled[3]={13.25, 6.75, 10};
+		int32_t qi16_size[2] = {1,14}; // rows, columns
+		int32_t qu16_size[2] = {1,12}; // rows, columns
+		int32_t qscaled_size[2] = {1,3}; // rows, columns
+		
+		// a 3x47 logical mask as packed bits (141 bits, so the last of the 3 words is only partly used) and as std::vector<bool>,
+		// element i is true, if i is a multiple of 3 or 7
+		uint64_t mask_bits[3]={0,0,0};
+		std::vector<bool> mask_vec(141);
+		for (int i=0; i<141; i++) {
+			mask_vec[i]=(i%3==0 || i%7==0);
+			if (mask_vec[i]) mask_bits[i/64]|=uint64_t(1)<<(i%64);
+		}
+		int32_t mask_size[2] = {3,47}; // rows, columns
+		
+		// UTF-8 strings with 2-, 3- and 4-byte characters ("Grüße μm € 😀", the emoji becomes a UTF-16 surrogate pair)
+		// and with invalid bytes, which are stored as Latin-1 characters ("café ÿÃ")
+		const char* utf8="Gr\xC3\xBC\xC3\x9F" "e \xCE\xBC" "m \xE2\x82\xAC \xF0\x9F\x98\x80";
+		const char* invalid_utf8="caf\xE9 \xFF\xC3";
+		std::vector<std::string> utf8_vec;
+		utf8_vec.push_back(utf8);
+		utf8_vec.push_back(invalid_utf8);
+		utf8_vec.push_back("ASCII");
+		
+		// a cell array with a number, a struct with a nested struct and a string
+		int32_t cell_nested_size[2] = {1,3}; // rows, columns
+		int32_t records_size[2] = {1,3}; // rows, columns
+		const double records_value[3*2] = {1,2, 3,4, 5,6}; // two values per element
+		const char* records_label[3] = {"first", NULL, "third"};
+		const bool records_valid[3] = {true, false, true};
+		const TinyMATWriterStructField records_fields[3] = {
+			TinyMATWriterStructField("value", records_value, TINYMAT_FIELD_DOUBLE, 2),
+			TinyMATWriterStructField("label", records_label, TINYMAT_FIELD_STRING),
+			TinyMATWriterStructField("valid", records_valid, TINYMAT_FIELD_LOGICAL)
+		};
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector1", vec1, 1,8);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector2", vec1, 8,1);
+		TinyMATWriter_writeStruct(mat, "struct1", mp1);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "matrix1", mat1, 2,3);
+		TinyMATWriter_writeMatrix2D_colmajor(mat, "matrix1_fromcolmajor", mat1cm, 2,3);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix1_ver2", mat1, mat1_size, 2);
+		
+		TinyMATWriter_writeMatrixND_colmajor(mat, "matrix3d", mat3, mat3_size, 3);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "matrix432d", mat432, mat432_size, 3);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix3d_rowmajor", mat3, mat3_size, 3);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "matrix432d_rowmajor", mat432, mat432_size, 3);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "boolmatrix", matb, matb_size, 3);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "mat432i16", mat432i16, mat432i16_size, 3);
+		
+		TinyMATWriter_writeSparseCSC(mat, "sparse_csc", 3, 4, sp_colptr, sp_rowind, sp_csc);
+		TinyMATWriter_writeSparseCSR(mat, "sparse_csr", 3, 4, sp_rowptr, sp_colind, sp_csr);
+		TinyMATWriter_writeSparseCOO(mat, "sparse_coo", 3, 4, sp_coorow, sp_coocol, sp_coo, 5);
+		TinyMATWriter_writeSparseCSC(mat, "sparse_logical", 3, 4, sp_colptr, sp_rowind, NULL);
+		
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "complex_rowmajor", matc, matc_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "complex_colmajor", matccm, matccm_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "complex_single", matccmf, matccm_size, 2);
+		TinyMATWriter_writeMatrixND_view(mat, "complex_view", matcv);
+		
+		TinyMATWriter_writeRaggedCellArray(mat, "ragged_cell", rg_size, 2, rg_values, rg_offsets, TINYMAT_FIELD_DOUBLE);
+		TinyMATWriter_writeRaggedCellArray(mat, "ragged_cell_single", rg_vec);
+		
+		TinyMATWriter_writeMatrixND_colmajor(mat, "tensor", tensor, tensor_size, 4);
+		TinyMATWriter_writeMatrixND_permuted(mat, "tensor_permuted", tensor, tensor_size, 4, tensor_perm);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "cube", cube, cube_size, 3);
+		TinyMATWriter_writeMatrixND_permuted(mat, "cube_permuted", cube, cube_size, 3, cube_perm);
+		
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "padded", padded, 16, 10);
+		TinyMATWriter_writeMatrixND_view(mat, "padded_view", paddedv);
+		
+		TinyMATWriter_writeMatrixND_colmajor_converted(mat, "quantized_int16", qi16, qi16_size, 2, TinyMATWriterConversion(TINYMAT_CONVERT_INT16));
+		TinyMATWriter_writeMatrixND_colmajor_converted(mat, "quantized_uint16", qu16, qu16_size, 2, TinyMATWriterConversion(TINYMAT_CONVERT_UINT16));
+		TinyMATWriter_writeMatrixND_colmajor_converted(mat, "quantized_scaled", qscaled, qscaled_size, 2, TinyMATWriterConversion(TINYMAT_CONVERT_INT16, 0.5, 10));
+		TinyMATWriter_writeMatrixND_colmajor_converted(mat, "converted_single", qi16, qi16_size, 2, TinyMATWriterConversion(TINYMAT_CONVERT_SINGLE));
+		
+		TinyMATWriter_writeLogicalBitsND_colmajor(mat, "mask_bits", mask_bits, mask_size, 2);
+		TinyMATWriter_writeContainerAsRow(mat, "mask_row", mask_vec);
+		TinyMATWriter_writeContainerAsColumn(mat, "mask_column", mask_vec);
+		
+		TinyMATWriter_writeString(mat, "string_utf8", utf8);
+		TinyMATWriter_writeString(mat, "string_invalid_utf8", invalid_utf8);
+		TinyMATWriter_writeStringVector(mat, "strings_utf8", utf8_vec);
+		
+		TinyMATWriter_startCellArray(mat, "cell_nested", cell_nested_size, 2);
+		TinyMATWriter_writeValue(mat, "", 1.0);
+		TinyMATWriter_startStruct(mat, "");
+		TinyMATWriter_writeValue(mat, "a", 2.0);
+		TinyMATWriter_startStruct(mat, "inner");
+		TinyMATWriter_writeString(mat, "text", "nested");
+		TinyMATWriter_writeValue(mat, "b", 3.0);
+		TinyMATWriter_endStruct(mat);
+		TinyMATWriter_endStruct(mat);
+		TinyMATWriter_writeString(mat, "", "last");
+		TinyMATWriter_endCellArray(mat);
+		
+		TinyMATWriter_writeStructArray(mat, "records", records_size, 2, records_fields, 3);
+
+		TinyMATWriter_close(mat);
+	}
+	
+	// compressed variables (miCOMPRESSED, requires MATLAB 7 or later) next to uncompressed copies of the same data
+	mat=TinyMATWriter_open("basic_test_compressed.mat");
+	if (mat) {
+		// a smooth 40x30 matrix in column-major form, which compresses well
+		std::vector<double> cmat(40*30);
+		for (size_t i=0; i<cmat.size(); i++) cmat[i]=floor(i/40.0)+sin(i*0.1);
+		int32_t cmat_size[2] = {40,30}; // rows, columns
+		std::map<std::string, double> cmp;
+		cmp["x"]=1;
+		cmp["y"]=2;
+		cmp["longname"]=M_PI;
+		
+		TinyMATWriter_writeMatrixND_colmajor(mat, "uncompressed", cmat.data(), cmat_size, 2);
+		TinyMATWriter_writeStruct(mat, "struct_uncompressed", cmp);
+		// only the next variable is compressed
+		TinyMATWriter_setNextCompression(mat, TINYMAT_COMPRESSION_BEST);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "next_compressed", cmat.data(), cmat_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "after_next", cmat.data(), cmat_size, 2);
+		// all following variables are compressed
+		TinyMATWriter_setCompression(mat, TINYMAT_COMPRESSION_DEFAULT);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "compressed", cmat.data(), cmat_size, 2);
+		TinyMATWriter_writeStruct(mat, "struct_compressed", cmp);
+		TinyMATWriter_writeString(mat, "string_compressed", "compressed text");
+		// arrays above 1kB are compressed while they are written, instead of staging them in memory
+		TinyMATWriter_setCompressionStreaming(mat, 1024);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "streamed", cmat.data(), cmat_size, 2);
+		TinyMATWriter_setCompressionStreaming(mat, TINYMAT_COMPRESSION_STREAMING_DEFAULT);
+		TinyMATWriter_setCompression(mat, TINYMAT_COMPRESSION_NONE);
+		TinyMATWriter_writeString(mat, "string_uncompressed", "compressed text");
+		
+		TinyMATWriter_close(mat);
+	}
+	
+	// compressed variables, which are compressed in parallel on 4 threads, the file keeps the order of the calls
+	mat=TinyMATWriter_open("basic_test_threads.mat");
+	if (mat) {
+		// each matrix holds v*10000+(0:7999), reshaped to 100x80
+		std::vector<double> tmat(100*80);
+		int32_t tmat_size[2] = {100,80}; // rows, columns
+		TinyMATWriter_setCompression(mat, TINYMAT_COMPRESSION_DEFAULT);
+		TinyMATWriter_setCompressionThreads(mat, 4);
+		for (int v=1; v<=6; v++) {
+			for (size_t i=0; i<tmat.size(); i++) tmat[i]=v*10000+i;
+			TinyMATWriter_writeMatrixND_colmajor(mat, (std::string("threaded")+char('0'+v)).c_str(), tmat.data(), tmat_size, 2);
+			if (v==3) {
+				// a struct between the arrays
+				TinyMATWriter_startStruct(mat, "threaded_struct");
+				TinyMATWriter_writeMatrixND_colmajor(mat, "matrix", tmat.data(), tmat_size, 2);
+				TinyMATWriter_writeString(mat, "text", "between threaded3 and threaded4");
+				TinyMATWriter_endStruct(mat);
+			}
+		}
+		
+		TinyMATWriter_close(mat);
+	}
+	
+	// the adaptive compression policy decides for each variable, whether it is stored raw, fast or with the configured level
+	mat=TinyMATWriter_open("basic_test_adaptive.mat");
+	if (mat) {
+		std::vector<double> smooth(100*80), noise(100*80);
+		int32_t amat_size[2] = {100,80}; // rows, columns
+		uint64_t state=12345;
+		for (size_t i=0; i<smooth.size(); i++) {
+			smooth[i]=floor(i/100.0);
+			state=state*6364136223846793005ULL+1442695040888963407ULL;
+			noise[i]=double(state>>11)/9007199254740992.0;
+		}
+		double small[4]={1,2,3,4};
+		TinyMATWriter_setCompression(mat, TINYMAT_COMPRESSION_BEST);
+		TinyMATWriter_setAdaptiveCompression(mat, TRUE);
+		TinyMATWriter_addCompressionRule(mat, "raw_*", TINYMAT_COMPRESSION_NONE);
+		TinyMATWriter_setCompressionReport(mat, printCompressionDecision, NULL);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "smooth", smooth.data(), amat_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "noise", noise.data(), amat_size, 2);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "small", small, 2,2);
+		TinyMATWriter_writeMatrixND_colmajor(mat, "raw_smooth", smooth.data(), amat_size, 2);
+		
+		TinyMATWriter_close(mat);
+	}
+	
+	// the same variables, written with the memory, the memory-mapped and the stdio backend, which have to produce the same file
+	TinyMATWriterOptions options;
+	options.backend=TINYMAT_BACKEND_MEMORY;
+	mat=TinyMATWriter_openWithOptions("basic_test_memory.mat", &options);
+	if (mat) {
+		writeBackendTest(mat);
+		TinyMATWriter_close(mat);
+	}
+	options.backend=TINYMAT_BACKEND_MMAP;
+	mat=TinyMATWriter_openWithOptions("basic_test_mmap.mat", &options);
+	if (mat) {
+		writeBackendTest(mat);
+		TinyMATWriter_close(mat);
+		const std::string mmap_data=readFileData("basic_test_mmap.mat");
+		check("basic_test_mmap.mat equals basic_test_memory.mat", !mmap_data.empty() && mmap_data==readFileData("basic_test_memory.mat"));
+	}
+	options.backend=TINYMAT_BACKEND_STDIO;
+	mat=TinyMATWriter_openWithOptions("basic_test_stdio.mat", &options);
+	if (mat) {
+		writeBackendTest(mat);
+		TinyMATWriter_close(mat);
+		const std::string stdio_data=readFileData("basic_test_stdio.mat");
+		check("basic_test_stdio.mat equals basic_test_memory.mat", !stdio_data.empty() && stdio_data==readFileData("basic_test_memory.mat"));
+	}
+	
+	// TinyMATWriter_backend() returns the backend, that is actually used for the options
+	struct {
+		const char* filename;
+		int backend;
+		uint64_t size_hint;
+		int expected;
+	} backend_tests[] = {
+		{"basic_test_backend.mat", TINYMAT_BACKEND_MEMORY, 0, TINYMAT_BACKEND_MEMORY},
+		{"basic_test_backend.mat", TINYMAT_BACKEND_STDIO, 0, TINYMAT_BACKEND_STDIO},
+		{"basic_test_backend.mat", TINYMAT_BACKEND_MMAP, 0, EXPECTED_MMAP_BACKEND},
+		{"basic_test_backend.mat", TINYMAT_BACKEND_AUTO, 1024*1024, TINYMAT_BACKEND_MEMORY},
+		{"basic_test_backend.mat", TINYMAT_BACKEND_AUTO, TINYMAT_BACKEND_AUTO_MEMORY_LIMIT, EXPECTED_LARGE_BACKEND},
+		{NULL, TINYMAT_BACKEND_AUTO, 0, TINYMAT_BACKEND_MEMORY}
+	};
+	for (size_t i=0; i<sizeof(backend_tests)/sizeof(backend_tests[0]); i++) {
+		TinyMATWriterOptions backend_options;
+		backend_options.backend=backend_tests[i].backend;
+		backend_options.size_hint=backend_tests[i].size_hint;
+		mat=TinyMATWriter_openWithOptions(backend_tests[i].filename, &backend_options);
+		const int backend=TinyMATWriter_backend(mat);
+		std::ostringstream what;
+		what<<"backend "<<backend_tests[i].backend<<" with size hint "<<backend_tests[i].size_hint<<" uses backend "<<backend;
+		check(what.str(), mat && backend==backend_tests[i].expected);
+		if (mat) {
+			TinyMATWriter_writeValue(mat, "backend", backend);
+			TinyMATWriter_close(mat);
+		}
+	}
+	
+	// the output of a sink is collected in memory and then written into a file, with the patch callback
+	// the compressed array is streamed into the sink and its size is patched afterwards
+	std::string sink_outputs[2];
+	for (int patch=0; patch<=1; patch++) {
+		std::string& sink_output=sink_outputs[patch];
+		mat=TinyMATWriter_openSink(appendToString, patch?patchString:NULL, NULL, &sink_output);
+		if (mat) {
+			check("openSink() uses TINYMAT_BACKEND_CUSTOM", TinyMATWriter_backend(mat)==TINYMAT_BACKEND_CUSTOM);
+			writeBackendTest(mat);
+			std::vector<double> smat(100*80);
+			for (size_t i=0; i<smat.size(); i++) smat[i]=floor(i/100.0);
+			int32_t smat_size[2] = {100,80}; // rows, columns
+			TinyMATWriter_setCompression(mat, TINYMAT_COMPRESSION_DEFAULT);
+			TinyMATWriter_setCompressionStreaming(mat, 1024);
+			TinyMATWriter_writeMatrixND_colmajor(mat, "streamed", smat.data(), smat_size, 2);
+			TinyMATWriter_close(mat);
+			writeFileData(patch?"basic_test_sink_patch.mat":"basic_test_sink.mat", sink_output);
+		}
+	}
+	check("sinks with and without patch callback write the same file", sink_outputs[0].size()>128 && sink_outputs[1].size()>128 && sink_outputs[0].substr(128)==sink_outputs[1].substr(128));
+	
+	// a file, that only exists in memory, is handed over as buffer, which is then written to disk
+	mat=TinyMATWriter_openMemory();
+	if (mat) {
+		writeBackendTest(mat);
+		uint8_t* buffer=NULL;
+		size_t buffer_size=0;
+		check("closeAndTakeBuffer() returns the file", TinyMATWriter_closeAndTakeBuffer(mat, &buffer, &buffer_size) && buffer && buffer_size>128);
+		if (buffer) {
+			const std::string buffer_data(reinterpret_cast<const char*>(buffer), buffer_size);
+			TinyMATWriter_freeBuffer(buffer);
+			writeFileData("basic_test_buffer.mat", buffer_data);
+			check("the buffer equals basic_test_memory.mat", buffer_size>128 && buffer_data.substr(128)==readFileData("basic_test_memory.mat"));
+		}
+	}
+	
+	// arrays in zero-copy mode are referenced by the memory backend (they have to stay valid until the file is closed),
+	// inside a struct or cell array they are copied
+	std::vector<uint16_t> rmat(300*200);
+	for (size_t i=0; i<rmat.size(); i++) rmat[i]=static_cast<uint16_t>(i);
+	int32_t rmat_size[2] = {300,200}; // rows, columns
+	int32_t rcell_size[2] = {1,2}; // rows, columns
+	options.backend=TINYMAT_BACKEND_MEMORY;
+	mat=TinyMATWriter_openWithOptions("basic_test_ref.mat", &options);
+	if (mat) {
+		TinyMATWriter_writeMatrixND_colmajor(mat, "copied", rmat.data(), rmat_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor_ref(mat, "referenced", rmat.data(), rmat_size, 2);
+		TinyMATWriter_startStruct(mat, "ref_struct");
+		TinyMATWriter_writeMatrixND_colmajor_ref(mat, "referenced", rmat.data(), rmat_size, 2);
+		TinyMATWriter_endStruct(mat);
+		TinyMATWriter_startCellArray(mat, "ref_cell", rcell_size, 2);
+		TinyMATWriter_writeMatrixND_colmajor_ref(mat, "", rmat.data(), rmat_size, 2);
+		TinyMATWriter_writeMatrix2D_colmajor_ref(mat, "", rmat.data(), 2, 3);
+		TinyMATWriter_endCellArray(mat);
+		TinyMATWriter_writeMatrix2D_colmajor_ref(mat, "referenced_2d", rmat.data(), 2, 3);
+		TinyMATWriter_close(mat);
+	}
+	
+	// with a memory limit, completed variables are written to the file, so the memory buffer does not hold the whole file
+	std::vector<double> lmat(100*80);
+	int32_t lmat_size[2] = {100,80}; // rows, columns
+	options.backend=TINYMAT_BACKEND_MEMORY;
+	options.memory_limit=16*1024;
+	mat=TinyMATWriter_openWithOptions("basic_test_limit.mat", &options);
+	if (mat) {
+		for (int v=1; v<=4; v++) {
+			for (size_t i=0; i<lmat.size(); i++) lmat[i]=v*10000+i;
+			TinyMATWriter_writeMatrixND_colmajor(mat, (std::string("limited")+char('0'+v)).c_str(), lmat.data(), lmat_size, 2);
+		}
+		// the buffer does not hold the whole file any more
+		uint8_t* buffer=NULL;
+		size_t buffer_size=0;
+		check("closeAndTakeBuffer() fails after a flush", !TinyMATWriter_closeAndTakeBuffer(mat, &buffer, &buffer_size) && !buffer);
+	}
+	options.memory_limit=0;
+	mat=TinyMATWriter_openWithOptions("basic_test_limit2.mat", &options);
+	if (mat) {
+		check("setMemoryLimit()", TinyMATWriter_setMemoryLimit(mat, 16*1024));
+		for (int v=1; v<=4; v++) {
+			for (size_t i=0; i<lmat.size(); i++) lmat[i]=v*10000+i;
+			TinyMATWriter_writeMatrixND_colmajor(mat, (std::string("limited")+char('0'+v)).c_str(), lmat.data(), lmat_size, 2);
+		}
+		TinyMATWriter_close(mat);
+	}
+	mat=TinyMATWriter_openMemory();
+	if (mat) {
+		check("setMemoryLimit() fails without a file", !TinyMATWriter_setMemoryLimit(mat, 16*1024));
+		TinyMATWriter_close(mat);
+	}
+	
+	// large row-major arrays with odd sizes are transposed in tiles, in parallel
+	mat=TinyMATWriter_open("basic_test_large.mat");
+	if (mat) {
+		// element (r,c) of the 1001x1503 matrix and of each of the 3 1023x517 matrices is r*10000+c (zero-based)
+		std::vector<double> large(1001*1503);
+		for (size_t r=0; r<1001; r++) {
+			for (size_t c=0; c<1503; c++) large[r*1503+c]=r*10000+c;
+		}
+		std::vector<float> large3d(3*1023*517);
+		for (size_t m=0; m<3; m++) {
+			for (size_t r=0; r<1023; r++) {
+				for (size_t c=0; c<517; c++) large3d[(m*1023+r)*517+c]=r*10000+c;
+			}
+		}
+		int32_t large3d_size[3] = {517,1023,3}; // columns, rows, matrices
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "large", large.data(), 1503, 1001);
+		TinyMATWriter_writeMatrixND_rowmajor(mat, "large3d", large3d.data(), large3d_size, 3);
+		TinyMATWriter_setTransposeThreads(mat, 1);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "large_1thread", large.data(), 1503, 1001);
+		TinyMATWriter_close(mat);
+	}
+	
+	// row-major arrays of all element sizes are transposed in SSE2 registers
+	mat=TinyMATWriter_open("basic_test_transpose.mat");
+	if (mat) {
+		const int32_t transpose_sizes[2][2] = {{47,33}, {129,67}}; // columns, rows
+		for (int i=0; i<2; i++) {
+			const int32_t cols=transpose_sizes[i][0];
+			const int32_t rows=transpose_sizes[i][1];
+			const std::string suffix=(i==0)?"":"_large";
+			writeTransposeTest<uint8_t>(mat, "rm_uint8"+suffix, cols, rows, 251);
+			writeTransposeTest<uint16_t>(mat, "rm_uint16"+suffix, cols, rows, 65521);
+			writeTransposeTest<int32_t>(mat, "rm_int32"+suffix, cols, rows, 2147483647);
+			writeTransposeTest<double>(mat, "rm_double"+suffix, cols, rows, 1000003);
+			writeTransposeTest<bool>(mat, "rm_bool"+suffix, cols, rows, 2);
+		}
+		TinyMATWriter_close(mat);
+	}
+	
+	// images with 3 and 4 interleaved channels are split into planes while they are transposed
+	mat=TinyMATWriter_open("basic_test_channels.mat");
+	if (mat) {
+		writeMultiChannelTest<uint8_t>(mat, "rgb_uint8", 53, 37, 3);
+		writeMultiChannelTest<uint8_t>(mat, "rgba_uint8", 53, 37, 4);
+		writeMultiChannelTest<float>(mat, "rgb_single", 53, 37, 3);
+		writeMultiChannelTest<float>(mat, "rgba_single", 53, 37, 4);
+		TinyMATWriter_close(mat);
+	}
+	
+	// with storage narrowing, integer-valued arrays are stored with the narrowest integer type, but are still read as double
+	mat=TinyMATWriter_open("basic_test_narrow.mat");
+	if (mat) {
+		double narrow_uint8[4]={0,1,200,255};
+		double narrow_int16[4]={-300,0,32767,-32768};
+		double narrow_uint32[3]={0,70000,4294967295.0};
+		int32_t narrow_int32[3]={1,2,3};
+		double neg_zero[3]={1,-0.0,2};
+		double not_a_number[3]={1,NAN,2};
+		for (int narrow=1; narrow>=0; narrow--) {
+			// first the narrowed arrays, then the same arrays with their own type
+			const std::string prefix=narrow?"narrow_":"wide_";
+			TinyMATWriter_setStorageNarrowing(mat, narrow);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"uint8").c_str(), narrow_uint8, 4);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"int16").c_str(), narrow_int16, 4);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"uint32").c_str(), narrow_uint32, 3);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"int32").c_str(), narrow_int32, 3);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"neg_zero").c_str(), neg_zero, 3);
+			TinyMATWriter_writeVectorAsRow(mat, (prefix+"nan").c_str(), not_a_number, 3);
+		}
+		TinyMATWriter_close(mat);
+	}
+    return (failedChecks>0)?1:0;
+}
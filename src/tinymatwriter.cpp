@@ -1,2147 +1,5679 @@
-/*
-    Copyright (c) 2008-2020 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
-
-    This software is free software: you can redistribute it and/or modify
-    it under the terms of the GNU Lesser General Public License (LGPL) as published by
-    the Free Software Foundation, either version 2 of the License, or
-    (at your option) any later version.
-
-    This program is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with this program.  If not, see <http://www.gnu.org/licenses/>.
-
-
-*/
-#include <math.h>
-#include <float.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <list>
-#include <algorithm>
-#include <stdexcept>
-
-//#include <iostream>
-
-#include "tinymatwriter.h"
-
-/** \brief if defined, files are beeing created in a memory buffer and are only written to disk at the end. 
-*          if undefined, the files are written directly to disk, including move operations on disk, which can be a factor 2-3 slower. */
-#define TINYMAT_WRITE_VIA_MEMORY
-
-#ifndef __WINDOWS__
-# if defined(WIN32) || defined(WIN64) || defined(_MSC_VER) || defined(_WIN32)
-#  define __WINDOWS__
-# endif
-#endif
-
-#ifndef __LINUX__
-# if defined(linux)
-#  define __LINUX__
-# endif
-#endif
-#ifdef TINYMAT_USES_QVARIANT
-//#  include <QDebug>
-#  include <QPoint>
-#  include <QSize>
-#endif
-
-#define TINYMAT_ORDER_UNKNOWN 0
-#define TINYMAT_ORDER_BIGENDIAN 1
-#define TINYMAT_ORDER_LITTLEENDIAN 2
-
-
-#if defined(__GNUC__) || defined(__GNUG__)
-#define TINYMAT_inlineattrib  inline
-// use this for no-inline:
-//#define TINYMAT_inlineattrib  __attribute__((noinline))
-#else
-#define TINYMAT_inlineattrib inline
-#endif
-
-
-
-
-#define TINYMAT_mxCHAR_CLASS_CLASS_arrayflags 0x00000004
-#define TINYMAT_mxDOUBLE_CLASS_arrayflags 0x00000006
-#define TINYMAT_mxSINGLE_CLASS_arrayflags 0x00000007
-#define TINYMAT_mxINT8_CLASS_arrayflags 0x00000008
-#define TINYMAT_mxUINT8_CLASS_arrayflags 0x00000009
-#define TINYMAT_mxINT16_CLASS_arrayflags 0x0000000A
-#define TINYMAT_mxUINT16_CLASS_arrayflags 0x0000000B
-#define TINYMAT_mxINT32_CLASS_arrayflags 0x0000000C
-#define TINYMAT_mxUINT32_CLASS_arrayflags 0x0000000D
-#define TINYMAT_mxINT64_CLASS_arrayflags 0x0000000E
-#define TINYMAT_mxUINT64_CLASS_arrayflags 0x0000000F
-#define TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags (TINYMAT_mxUINT8_CLASS_arrayflags+(0x0002<<8))
-
-
-#define TINYMAT_miINT8 1
-#define TINYMAT_miUINT8 2
-#define TINYMAT_miINT16 3
-#define TINYMAT_miUINT16 4
-#define TINYMAT_miINT32 5
-#define TINYMAT_miUINT32 6
-#define TINYMAT_miSINGLE 7
-#define TINYMAT_miDOUBLE 9
-#define TINYMAT_miINT64 12
-#define TINYMAT_miUINT64 13
-#define TINYMAT_miMATRIX 14
-#define TINYMAT_miCOMPRESSED 15
-#define TINYMAT_miUTF8 16
-#define TINYMAT_miUTF16 17
-#define TINYMAT_miUTF32 18
-
-struct TinyMATWriterStruct {
-  inline TinyMATWriterStruct() :
-    sizepos(-1),
-    data_start(-1)
-  {
-  }
-  /** \brief position of the size-data field */
-  long sizepos;
-  long data_start;
-  std::vector<std::string> itemnames;
-};
-
-struct TinyMATWriterCell {
-  inline TinyMATWriterCell() :
-    sizepos(-1),
-    data_start(-1)
-  {
-  }
-  /** \brief position of the size-data field */
-  long sizepos;
-  long data_start;
-};
-
-enum class TinyMATWriterStackItem {
-  Cell,
-  Struct
-};
-
-/*! \brief this struct represents a mat file
-    \ingroup TinyMATwriter
-    \internal
- */
-struct TinyMATWriterFile {
-    TinyMATWriterFile() :
-      file(NULL),
-      filedata(NULL),
-      filedata_size(0),
-      filedata_current(0),
-      filedata_count(0),
-      byteorder(TINYMAT_ORDER_UNKNOWN)
-    {
-    }
-
-    /** \brief the libc file handle */
-    FILE* file;
-    /** \brief Zwischenspeicher-Array beim Schreiben von Matlab-Daten */
-    uint8_t* filedata;
-    /** \brief Gre von filedata */
-    size_t filedata_size;
-    /** \brief aktuelle Position in filedata */
-    size_t filedata_current;
-    /** \brief tatschliche Datenbytes in filedata */
-    size_t filedata_count;
-
-    /** \brief specifies the byte order of the system (and the written file!) */
-    uint8_t byteorder;
-
-    std::vector<TinyMATWriterStruct> structures;
-    std::vector<TinyMATWriterCell> cells;
-    std::vector<TinyMATWriterStackItem> stack;
-
-    inline void startStruct() {
-      structures.push_back(TinyMATWriterStruct());
-      stack.push_back(TinyMATWriterStackItem::Struct);
-    }
-
-    void endStruct() {
-      structures.pop_back();
-      stack.pop_back();
-    }
-
-    inline TinyMATWriterStruct& lastStruct() {
-      return structures[structures.size()-1];
-    }
-
-    inline void addStructItemName(const std::string& name) {
-      if (structures.size()>0 && stack.size()>0 && stack[stack.size()-1]==TinyMATWriterStackItem::Struct) {
-        lastStruct().itemnames.push_back(name);
-      }
-    }
-
-    inline void startCell() {
-      cells.push_back(TinyMATWriterCell());
-      stack.push_back(TinyMATWriterStackItem::Cell);
-    }
-
-    void endCell() {
-      cells.pop_back();
-      stack.pop_back();
-    }
-
-    inline TinyMATWriterCell& lastCell() {
-      return cells[cells.size()-1];
-    }
-    
-};
-
-
-int TinyMATWriter_fOK(const TinyMATWriterFile* mat)  {
-    return (mat && (mat->file!=NULL));
-}
-
-
-/*! \brief determines the byte order of the system
-    \ingroup tinymatwriter
-    \internal
-
-    \return TINYMAT_ORDER_BIGENDIAN or TINYMAT_ORDER_LITTLEENDIAN, or TINYMAT_ORDER_UNKNOWN if the byte order cannot be determined
- */
- TINYMAT_inlineattrib static int TinyMAT_get_byteorder()
-{
-        union {
-                long l;
-                char c[4];
-        } test;
-        test.l = 1;
-        if( test.c[3] && !test.c[2] && !test.c[1] && !test.c[0] )
-                return TINYMAT_ORDER_BIGENDIAN;
-
-        if( !test.c[3] && !test.c[2] && !test.c[1] && test.c[0] )
-                return TINYMAT_ORDER_LITTLEENDIAN;
-
-        return TINYMAT_ORDER_UNKNOWN;
-}
-
-
- TINYMAT_inlineattrib static int TinyMAT_fclose(TinyMATWriterFile* file) {
-     //std::cout<<"TinyMAT_fclose()\n";
-     //std::cout.flush();
-     if (!file) return 0;
-     if (!file->file) {
-       delete file;
-       return 0;
-     }
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-     if (file->filedata_count>0 && file->filedata) {
-       fseek(file->file, 0, SEEK_SET);
-       fwrite(file->filedata, 1, file->filedata_count, file->file);
-       file->filedata_size = 0;
-       file->filedata_current = 0;
-       file->filedata_count = 0;
-       free(file->filedata);
-     }
-#endif
-     int ret= fclose(file->file);
-     delete file;
-     return ret;
- }
-
- TINYMAT_inlineattrib static TinyMATWriterFile* TinyMAT_fopen(const char* filename, size_t bufSize=1024*100) {
-     //std::cout<<"TinyMAT_fopen()\n";
-     //std::cout.flush();
-     TinyMATWriterFile* mat=new TinyMATWriterFile;
-#ifdef HAVE_FOPEN_S
-     if (fopen_s(&(mat->file), filename, "wb+") == 0) {
-#else
-     if ((mat->file=fopen(filename, "wb+")) != NULL) {
-#endif
-       if (mat->file) {
-         if (bufSize > 0) {
-           setvbuf(mat->file, NULL, _IOFBF, bufSize);
-         }
-         else {
-           setvbuf(mat->file, NULL, _IOFBF, BUFSIZ);
-         }
-       }
-       mat->byteorder = (uint8_t)TinyMAT_get_byteorder();
-     }
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-      mat->filedata_size = std::max<size_t>(bufSize, BUFSIZ);
-      mat->filedata_current = 0;
-      mat->filedata_count = 0;
-      mat->filedata = (uint8_t*)malloc(mat->filedata_size);
-      if (!mat->filedata) {
-        delete mat;
-        return NULL;
-      }
-#endif
-     return mat;
- }
-
-  TINYMAT_inlineattrib static long TinyMAT_ftell(TinyMATWriterFile* file) {
-     //std::cout<<"TinyMAT_ftell()\n";
-     //std::cout.flush();
-     if (!file || !file->file) return 0;
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-     return static_cast<long>(file->filedata_current);
-#else
-     return ftell(file->file);
-#endif
- }
- TINYMAT_inlineattrib static int TinyMAT_fseek(TinyMATWriterFile* file, long offset) {
-     //std::cout<<"TinyMAT_fseek()\n";
-     //std::cout.flush();
-     if (!file || !file->file) return 0;
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-       long start = 0;
-       int res = 0;
-       if (start + offset < 0) {
-         throw std::runtime_error("seek before start of file");
-         res=-1;
-       } else if (static_cast<size_t>(start + offset) > file->filedata_count) {
-         throw std::runtime_error("seek after end of file");
-         res=-1;
-       } else {
-         file->filedata_current = start + offset;
-         res=0;
-       }
-       return res;
-#else
-       return fseek(file->file, offset, SEEK_SET);
-#endif
- }
-
- /** \brief grows the internal memory array for file writing by \a size_increment bytes */
- TINYMAT_inlineattrib static void TinyMAT_growMem(uint32_t size_increment, TinyMATWriterFile* file) {
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-   if (file->filedata_current + size_increment + 100 >= file->filedata_size) {
-     size_t newsize = file->filedata_size;
-     while (file->filedata_current + size_increment + 100 >= newsize) {
-       if (newsize < 100 * 1024 * 1024) newsize = newsize * 2;
-       else if (newsize < 1000 * 1024 * 1024) newsize = newsize * 3 / 2;
-       else newsize = newsize * 6 / 5;
-     }
-     file->filedata = (uint8_t*)realloc(file->filedata, newsize);
-     file->filedata_size = newsize;
-   }
-#endif
- }
-
-
-TINYMAT_inlineattrib static int TinyMAT_fwrite(const void* data, uint32_t size, uint32_t count, TinyMATWriterFile* file)
-{
-     //std::cout<<"TinyMAT_fwrite()\n";
-     if (!file || !file->file || !data || size*count<=0) return 0;
-     int res = 0;
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-       if (file->filedata_current + size*count + 100 >= file->filedata_size) {
-         TinyMAT_growMem(size*count, file);
-       }
-#ifdef HAVE_MEMCPY_S
-       memcpy_s(&(file->filedata[file->filedata_current]), file->filedata_size- file->filedata_current, data, size*count);
-#else
-       memcpy(&(file->filedata[file->filedata_current]), data, size*count);
-#endif
-       file->filedata_current = file->filedata_current + size*count;
-       file->filedata_count = std::max(file->filedata_count, file->filedata_current);
-       res=size*count;
-#else
-       res = (int)fwrite(data, 1, size*count, file->file);
-#endif
-     return res;
-}
-
-template<typename T>
-TINYMAT_inlineattrib static int TinyMAT_fwritesmall(T data, TinyMATWriterFile* file)
-{
-     if (!file || !file->file) return 0;
-     int res = 0;
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-     if (file->filedata_current + sizeof(T) + 100 >= file->filedata_size) {
-       TinyMAT_growMem(sizeof(T), file);
-     }
-     T* datap = reinterpret_cast<T*>(&(file->filedata[file->filedata_current]));
-     *datap = data;
-     file->filedata_current = file->filedata_current + sizeof(T);
-     file->filedata_count = std::max(file->filedata_count, file->filedata_current);
-     res=sizeof(T);
-#else
-     res = (int)fwrite(&data, 1, sizeof(T), file->file);
-#endif
-     return res;
-}
-
-TINYMAT_inlineattrib static int TinyMAT_fread(void* data, uint32_t size, uint32_t count, TinyMATWriterFile* file)
-{
-     //std::cout<<"TinyMAT_fwrite()\n";
-     if (!file || !file->file || !data || size*count<=0) return 0;
-     int res = 0;
-#ifdef TINYMAT_WRITE_VIA_MEMORY
-       int cnt = std::min<int>(size*count, static_cast<int>(file->filedata_size - file->filedata_current));
-       if (static_cast<uint32_t>(cnt) != size*count) {
-         throw std::runtime_error("read after end of file");
-       }
-#ifdef HAVE_MEMCPY_S
-       memcpy_s(data, size*count, &(file->filedata[file->filedata_current]), cnt);
-#else
-       memcpy(data, &(file->filedata[file->filedata_current]), cnt);
-#endif
-       file->filedata_current = file->filedata_current + cnt;
-       res = cnt;
-#else
-       res = (int)fread(data, 1, size*count, file->file);
-#endif
-     return res;
-}
-
-
-
-TINYMAT_inlineattrib static void TinyMAT_writeU8(TinyMATWriterFile* filen, uint8_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write8(TinyMATWriterFile* filen, int8_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_writeU16(TinyMATWriterFile* filen, uint16_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write16(TinyMATWriterFile* filen, int16_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_writeU32(TinyMATWriterFile* filen, uint32_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write32(TinyMATWriterFile* filen, int32_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_writeU64(TinyMATWriterFile* filen, uint64_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write64(TinyMATWriterFile* filen, int64_t data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write64d(TinyMATWriterFile* filen, double data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-TINYMAT_inlineattrib static void TinyMAT_write32f(TinyMATWriterFile* filen, float data) {
-    TinyMAT_fwritesmall(data, filen);
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u64(TinyMATWriterFile* mat, uint64_t data) {
-    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miUINT64));
-    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write64(mat, data);
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i64(TinyMATWriterFile* mat, int64_t data) {
-    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miINT64));
-    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write64(mat, data);
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u32(TinyMATWriterFile* mat, uint32_t data) {
-    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miUINT32));
-    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write32(mat, data);
-    TinyMAT_write32(mat, static_cast<uint32_t>(0)); // write padding
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i32(TinyMATWriterFile* mat, int32_t data) {
-    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write32(mat, data);
-    TinyMAT_write32(mat, static_cast<uint32_t>(0)); // write padding
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElementS_i32(TinyMATWriterFile* mat, int32_t data) {
-    TinyMAT_writeU16(mat, static_cast<uint16_t>(TINYMAT_miINT32));
-    TinyMAT_writeU16(mat, static_cast<uint16_t>(sizeof(data)));
-    TinyMAT_write32(mat, data);
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u16(TinyMATWriterFile* mat, uint16_t data) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT16));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_writeU16(mat, data);
-    TinyMAT_writeU16(mat, static_cast<uint16_t>(0)); // write padding
-    TinyMAT_write32(mat, static_cast<uint32_t>(0));
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i16(TinyMATWriterFile* mat, int16_t data) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT16));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write16(mat, data);
-    TinyMAT_writeU16(mat, static_cast<uint16_t>(0)); // write padding
-    TinyMAT_write32(mat, static_cast<uint32_t>(0));
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_dbl(TinyMATWriterFile* mat, double data) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miDOUBLE));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
-    TinyMAT_write64d(mat, data);
-    // no padding required
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_dbla(TinyMATWriterFile* mat, const double* data, uint32_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miDOUBLE));
-    if (!data) items=0;
-    TinyMAT_writeU32(mat, items*sizeof(*data));
-    if (items>0 && data){
-        TinyMAT_fwrite(data, sizeof(*data), items, mat);
-    }
-    // no padding required
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_flta(TinyMATWriterFile* mat, const float* data, uint32_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miSINGLE));
-    if (!data) items=0;
-    TinyMAT_writeU32(mat, items*sizeof(*data));
-    if (items>0 && data){
-        TinyMAT_fwrite(data, sizeof(*data), items, mat);
-        // write padding
-        if (items%2==1) TinyMAT_write32(mat, static_cast<uint32_t>(0));
-    }
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u32a(TinyMATWriterFile* mat, const uint32_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT32));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // write padding
-        if (items%2==1) TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-    }
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i32a(TinyMATWriterFile* mat, const int32_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // write padding
-        if (items%2==1) TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-    }
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u16a(TinyMATWriterFile* mat, const uint16_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT16));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // write padding
-        if (items%4==1) {
-            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
-        } else if (items%4==2) {
-            TinyMAT_write32(mat, static_cast<uint32_t>(0));
-        } else if (items%4==3) {
-            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
-        }
-
-    }
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i16a(TinyMATWriterFile* mat, const int16_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT16));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // write padding
-        if (items%4==1) {
-            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
-        } else if (items%4==2) {
-            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-        } else if (items%4==3) {
-            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
-        }
-    }
-}
-
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u64a(TinyMATWriterFile* mat, const uint64_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT64));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // no padding required
-    }
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i64a(TinyMATWriterFile* mat, const int64_t* data, size_t items) {
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT64));
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
-    if (items>0) {
-        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
-        // no padding required
-    }
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i8a(TinyMATWriterFile* mat, const int8_t* data, uint32_t slen) {
-    size_t pad=(slen)%8;
-    uint32_t cla=TINYMAT_miINT8;
-    TinyMAT_writeU32(mat, cla);
-    TinyMAT_writeU32(mat, slen);
-    if (slen>0 && data) {
-        TinyMAT_fwrite(data, 1, slen, mat);
-        if (pad>0) {
-          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
-          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
-        }
-    }
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u8a(TinyMATWriterFile* mat, const uint8_t* data, uint32_t slen) {
-    size_t pad=(slen)%8;
-    uint32_t cla=TINYMAT_miUINT8;
-    TinyMAT_writeU32(mat, cla);
-    TinyMAT_writeU32(mat, slen);
-    if (slen>0 && data) {
-        TinyMAT_fwrite(data, 1, slen, mat);
-        if (pad>0) {
-          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
-          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
-        }
-    }
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_stringas8bit(TinyMATWriterFile* mat, const char* data, uint32_t slen) {
-    TinyMAT_writeDatElement_i8a(mat, (const int8_t*)(data), slen);
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_string(TinyMATWriterFile* mat, const char* data, uint32_t slen) {
-    size_t pad=(2*slen)%8;
-    int16_t* tmp=NULL;
-    if (slen>0 && data) {
-        tmp=(int16_t*)malloc(slen*2);
-        for (uint32_t i=0; i<slen; i++) {
-            tmp[i]=data[i];
-        }
-    }
-    uint32_t cla=TINYMAT_miUINT16;
-    TinyMAT_writeU32(mat, cla);
-    TinyMAT_writeU32(mat, slen*2);
-    if (slen>0 && tmp) {
-        TinyMAT_fwrite(tmp, 2, slen, mat);
-        // write padding
-        if (pad>0) {
-          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
-          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
-        }
-    } else {
-
-    }
-    if (tmp) free(tmp);
-
-}
-
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_stringas8bit(TinyMATWriterFile* mat, const char* data) {
-    TinyMAT_writeDatElement_stringas8bit(mat, data, (uint32_t)strlen(data));
-}
-TINYMAT_inlineattrib static void TinyMAT_writeDatElement_string(TinyMATWriterFile* mat, const char* data) {
-    TinyMAT_writeDatElement_string(mat, data, (uint32_t)strlen(data));
-}
-
-TINYMAT_inlineattrib static size_t TinyMAT_DatElement_realstringlen8bit(const char* data) {
-    if (!data) return 0;
-    size_t slen=strlen(data);
-    if (slen==0) return 0;
-    size_t pad=slen%8;
-    if (pad>0) {
-        slen=slen+(8-pad);
-    }
-    return slen;
-}
-TINYMAT_inlineattrib static size_t TinyMAT_DatElement_realstringlen16bit(const char* data) {
-    if (!data) return 0;
-    size_t slen=strlen(data)*2;
-    if (slen==0) return 0;
-    size_t pad=slen%8;
-    if (pad>0) {
-        slen=slen+(8-pad);
-    }
-    return slen;
-}
-
-
-
-
-
-
-
-
-
-
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const double *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxDOUBLE_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_dbla(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const float *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxSINGLE_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_flta(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint64_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxUINT64_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_u64a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int64_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxINT64_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_i64a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-
-
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint32_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxUINT32_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_u32a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int32_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxINT32_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_i32a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint16_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxUINT16_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_u16a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int16_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxINT16_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_i16a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-
-
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint8_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxUINT8_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_u8a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int8_t *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxINT8_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        TinyMAT_writeDatElement_i8a(mat, data_real, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-}
-
-void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const bool *data_real, const int32_t *sizes, uint32_t ndims)
-{
-    if (!data_real || !sizes || ndims<=0) {
-        TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-        mat->addStructItemName(name);
-        uint32_t nentries=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-        }
-
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags, 0};
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        int8_t* dat=NULL;
-        if (nentries>0) {
-            dat=(int8_t*)malloc(nentries*sizeof(int8_t*));
-            for (uint32_t i=0; i<nentries; i++) {
-                dat[i]=(data_real[i]?1:0);
-            }
-        }
-        TinyMAT_writeDatElement_i8a(mat, dat, nentries);
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-        if (dat) free(dat);
-    }
-}
-
-
-TinyMATWriterFile* TinyMATWriter_open(const char* filename, const char* description, size_t bufSize) {
-    TinyMATWriterFile* mat=TinyMAT_fopen(filename, bufSize);
-
-    if (TinyMATWriter_fOK(mat)) {
-        // setup and write Description field (116 bytes)
-        char stdmsg[512];
-        for (int i=0; i<512; i++) stdmsg[i]='\0';
-        time_t rawtime;
-        ::time(&rawtime);
-        struct tm * timeinfo;
-#ifdef HAVE_GMTIME_S
-        struct tm ti;
-        ::gmtime_s(&ti, &rawtime);
-        timeinfo=&ti;
-#else
-        timeinfo = ::gmtime(&rawtime);
-#endif
-#ifdef HAVE_SPRINTF_S
-        sprintf_s(stdmsg, 512,"MATLAB 5.0 MAT-file, written by TinyMAT, %d-%02d-%02d %02d:%02d:%02d UTC", 1900+timeinfo->tm_year, timeinfo->tm_mon+1, timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-#else
-        sprintf(stdmsg, "MATLAB 5.0 MAT-file, written by TinyMAT, %d-%02d-%02d %02d:%02d:%02d UTC", 1900+timeinfo->tm_year, timeinfo->tm_mon+1, timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-#endif
-        size_t slstd=strlen(stdmsg);
-        char desc[116];
-        size_t sl=0;
-        if (description) sl=strlen(description);
-        if (slstd>0) {
-            for (size_t i=0; i<slstd; i++) {
-                desc[i]=stdmsg[i];
-            }
-        }
-        size_t maxv=slstd;
-        if (sl>0) {
-            maxv=maxv+2+sl;
-        }
-        if (maxv>116) maxv=116;
-        if (sl>0) {
-            desc[slstd]=':';
-            desc[slstd+1]=' ';
-            for (size_t i=slstd+2; i<sl; i++) {
-                desc[i]=description[i];
-            }
-        }
-        if (maxv<116) {
-            desc[maxv]='\0';
-            for (size_t i=maxv+1; i<116; i++) {
-                desc[i]=' ';
-            }
-        } else {
-            desc[115]='\0';
-        }
-        TinyMAT_fwrite(desc, 1, 116,mat);
-        
-        // write "Header Subsystem Data Offset Field" (not used, i.e. write 00000000)
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(0x00000000));
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(0x00000000));
-        
-        // write "Header Flag Fields"
-        TinyMAT_writeU16(mat, static_cast<uint16_t>(0x0100)); // version
-        TinyMAT_write8(mat, (int8_t)'I'); // endian indicator
-        TinyMAT_write8(mat, (int8_t)'M');
-        return mat;
-    } else {
-        delete mat;
-        return NULL;
-    }
-}
-
-#define TINYMAT_mxCELL_CLASS_arrayflags 0x00000001
-#define TINYMAT_mxSTRUCT_CLASS_arrayflags 0x00000002
-
-
-void TinyMATWriter_writeDoubleList(TinyMATWriterFile *mat, const char *name, const std::list<double> &data, bool columnVector)
-{
-    mat->addStructItemName(name);
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxDOUBLE_CLASS_arrayflags, 0};
-
-
-    size_bytes+=16; // array flags
-    size_bytes+=16; // dimensions flags
-    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
-    size_bytes+=8+8*(uint32_t)data.size(); // actual data
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    if (columnVector) {
-        TinyMAT_writeU32(mat, (uint32_t)1);
-        TinyMAT_writeU32(mat, (uint32_t)data.size());
-    } else {
-        TinyMAT_writeU32(mat, (uint32_t)data.size());
-        TinyMAT_writeU32(mat, (uint32_t)1);
-    }
-
-    // write field name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    double * d=NULL;
-    if (data.size()>0) {
-        d=(double*)malloc(data.size()*sizeof(double));
-        int i=0;
-        for (std::list<double>::const_iterator it=data.begin(); it!=data.end(); it++) {
-            d[i]=*it;
-            i++;
-        }
-    }
-
-    // write data type
-    TinyMAT_writeDatElement_dbla(mat, d, (uint32_t)data.size());
-    if (d) free(d);
-}
-
-
-void TinyMATWriter_writeDoubleVector(TinyMATWriterFile *mat, const char *name, const std::vector<double> &data, bool columnVector)
-{
-    mat->addStructItemName(name);
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxDOUBLE_CLASS_arrayflags, 0};
-
-
-    size_bytes+=16; // array flags
-    size_bytes+=16; // dimensions flags
-    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
-    size_bytes+=8+8*(uint32_t)data.size(); // actual data
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    if (columnVector) {
-        TinyMAT_writeU32(mat, (uint32_t)1);
-        TinyMAT_writeU32(mat, (uint32_t)data.size());
-    } else {
-        TinyMAT_writeU32(mat, (uint32_t)data.size());
-        TinyMAT_writeU32(mat, (uint32_t)1);
-    }
-
-    // write field name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    double * d=NULL;
-    if (data.size()>0) {
-        d=(double*)malloc(data.size()*sizeof(double));
-        int i=0;
-        for (std::vector<double>::const_iterator it=data.begin(); it!=data.end(); it++) {
-            d[i]=*it;
-            i++;
-        }
-    }
-
-    // write data type
-    TinyMAT_writeDatElement_dbla(mat, d, (uint32_t)data.size());
-    if (d) free(d);
-}
-
-
-
-
-void TinyMATWriter_writeEmptyMatrix(TinyMATWriterFile *mat, const char *name)
-{
-
-  mat->addStructItemName(name);
-  uint32_t size_bytes = 0;
-  uint32_t arrayflags[2] = { TINYMAT_mxDOUBLE_CLASS_arrayflags, 0 };
-
-
-  size_bytes += 16; // array flags
-  size_bytes += 16; // dimensions flags
-  size_bytes += 8 + (uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
-  size_bytes += 8 + 8 * 0; // actual data
-
-                           // write tag header
-  TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-  TinyMAT_writeU32(mat, size_bytes);
-
-  // write arrayflags
-  TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-  // write field dimensions
-  TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-  TinyMAT_writeU32(mat, (uint32_t)8);
-  TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-  TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
-
-  // write field name
-  TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-  // write no-double-data element
-  TinyMAT_writeDatElement_dbla(mat, NULL, 0);
-
-}
-
-void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const char *data)
-{
-    TinyMATWriter_writeString(mat, name, data, (uint32_t)strlen(data));
-}
-
-
-void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const std::string &data)
-{
-    TinyMATWriter_writeString(mat, name, data.c_str(), (uint32_t)data.size());
-}
-
-void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const char *data, uint32_t slen)
-{
-    mat->addStructItemName(name);
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2];
-    arrayflags[0]=TINYMAT_mxCHAR_CLASS_CLASS_arrayflags;
-    arrayflags[1]=0;
-
-
-
-    size_bytes+=16; // array flags
-    size_bytes+=16; // dimensions flags
-    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
-    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen16bit(data); // actual data
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    TinyMAT_writeU32(mat, 1);
-    TinyMAT_writeU32(mat, slen);
-
-    // write field name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-
-    // write data type
-    TinyMAT_writeDatElement_string(mat, data, slen);
-}
-
-
-
-
-
-void TinyMATWriter_close(TinyMATWriterFile* mat) {
-    if (mat) {
-        while (mat->structures.size()>0) {
-            TinyMATWriter_endStruct(mat);
-        }
-        if (mat) TinyMAT_fclose(mat);
-    }
-}
-
-std::string TinyMAT_combineStrings(const std::vector<std::string>& fieldnames, int32_t* maxlen_out=NULL, int32_t minlen=32) {
-    std::vector<std::string> names;
-    int32_t maxlen=0;
-    for (auto i = fieldnames.begin(); i != fieldnames.end(); ++i) {
-        std::string ni=*i;
-        while (static_cast<int32_t>(ni.size())>(minlen-1)) {
-            ni.erase(ni.size()-1, 1);
-        }
-        if ((int32_t)ni.size()>maxlen) maxlen=(int32_t)ni.size();
-        names.push_back(ni);
-    }
-    if (maxlen<minlen) maxlen=minlen;
-    // pad all field names to maxlen
-    std::string joinednames;
-    for (size_t ii=0; ii<names.size(); ii++) {
-        while ((int64_t)names[ii].size()<maxlen) {
-            names[ii].push_back('\0');
-        }
-        joinednames.append(names[ii]);
-    }
-    if (maxlen_out) *maxlen_out=maxlen;
-    return joinednames;
-}
-
-
-
-void TinyMATWriter_startStruct(TinyMATWriterFile *mat, const char *name) {
-    mat->addStructItemName(name);
-    mat->startStruct();
-
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
-    
-
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    mat->lastStruct().sizepos=TinyMAT_ftell(mat);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    TinyMAT_write32(mat, (int32_t)1);
-    TinyMAT_write32(mat, (int32_t)1);
-
-    // write struct name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    mat->lastStruct().data_start=TinyMAT_ftell(mat);
-}
-
-
-void TinyMATWriter_endStruct(TinyMATWriterFile* mat) {
-    /*
-        This function is a bit mean:
-          It first reads the data written in the array so far (since the associated call to TinyMATWriter_startStruct(mat, name))
-          into a memory array. Then it takes the collected field names from the uppermost TinyMATWriterStruct item in the
-          structures-stack of TinyMATWriterFile, writes these names as item-names for the struct and rewrites the temporarily
-          stored data. This way, the API can internally collect the item names, which have to be put into the file BEFORE the
-          actual data.
-    */
-    TinyMATWriterStruct& struc=mat->lastStruct();
-
-    long start=TinyMAT_ftell(mat);
-    long ssize=start-struc.data_start;
-    uint8_t* tmpdata=(uint8_t*)malloc(ssize*sizeof(uint8_t));
-    TinyMAT_fseek(mat, struc.data_start);
-    TinyMAT_fread(tmpdata, ssize, 1, mat);
-
-
-    int32_t maxlen=0;
-    std::string joinednames=TinyMAT_combineStrings(struc.itemnames, &maxlen);
-
-
-    TinyMAT_fseek(mat, struc.data_start);
-    // write field name length
-    TinyMAT_writeDatElementS_i32(mat, maxlen);
-
-    // write field names
-    TinyMAT_writeDatElement_stringas8bit(mat, joinednames.c_str(), (uint32_t)joinednames.size());
-    
-    TinyMAT_fwrite(tmpdata, ssize, 1, mat);
-
-    free(tmpdata);
-
-
-    long endpos=TinyMAT_ftell(mat);
-    TinyMAT_fseek(mat, struc.sizepos);
-    uint32_t size_bytes=endpos-struc.sizepos-4;
-    TinyMAT_writeU32(mat, size_bytes);
-    TinyMAT_fseek(mat, endpos);
-    mat->endStruct();
-}
-
-
-void TinyMATWriter_writeStruct(TinyMATWriterFile *mat, const char *name, const std::map<std::string, double> &data)
-{
-    mat->addStructItemName(name);
-    mat->startStruct();
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
-    std::map<std::string, double>::const_iterator i;
-    std::vector<std::string> names;
-    int32_t maxlen=0;
-    for (i = data.begin(); i != data.end(); ++i) {
-        std::string ni=i->first;
-        while (ni.size()>31) {
-            ni.erase(ni.size()-1, 1);
-        }
-        if ((int32_t)ni.size()>maxlen) maxlen=(int32_t)ni.size();
-        names.push_back(ni);
-    }
-    if (maxlen<32) maxlen=32;
-    // pad all field names to maxlen
-    std::string joinednames;
-    for (size_t ii=0; ii<names.size(); ii++) {
-        while ((int64_t)names[ii].size()<maxlen) {
-            names[ii].push_back('\0');
-        }
-        joinednames.append(names[ii]);
-    }
-
-
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    long sizepos;
-    sizepos=TinyMAT_ftell(mat);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    TinyMAT_write32(mat, (int32_t)1);
-    TinyMAT_write32(mat, (int32_t)1);
-
-    // write struct name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    // write field name length
-    TinyMAT_writeDatElementS_i32(mat, maxlen);
-
-    // write field names
-    TinyMAT_writeDatElement_stringas8bit(mat, joinednames.c_str(), (uint32_t)joinednames.size());
-
-    // write data type
-    for (i = data.begin(); i != data.end(); ++i) {
-        double v=i->second;
-        TinyMATWriter_writeMatrix2D_colmajor(mat, "", &v, 1, 1);
-    }
-
-    long endpos;
-    endpos=TinyMAT_ftell(mat);
-    TinyMAT_fseek(mat, sizepos);
-    size_bytes=endpos-sizepos-4;
-    TinyMAT_writeU32(mat, size_bytes);
-    TinyMAT_fseek(mat, endpos);
-    mat->endStruct();
-}
-
-void TinyMATWriter_startCellArray(TinyMATWriterFile * mat, const char * name, const int32_t * sizes, uint32_t ndims)
-{
-  mat->addStructItemName(name);
-  mat->startCell();
-
-  uint32_t size_bytes = 0;
-  uint32_t arrayflags[2] = { TINYMAT_mxCELL_CLASS_arrayflags, 0 };
-
-
-  // write tag header
-  TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-  mat->lastCell().sizepos = TinyMAT_ftell(mat);
-  TinyMAT_writeU32(mat, size_bytes);
-
-  // write arrayflags
-  TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-  // write field dimensions
-  TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
-
-  // write struct name
-  TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-  mat->lastCell().data_start = TinyMAT_ftell(mat);
-
-
-}
-
-void TinyMATWriter_endCellArray(TinyMATWriterFile * mat)
-{
-  TinyMATWriterCell& cell = mat->lastCell();
-
-  long endpos = TinyMAT_ftell(mat);
-  TinyMAT_fseek(mat, cell.sizepos);
-  uint32_t size_bytes = endpos - cell.sizepos - 4;
-  TinyMAT_writeU32(mat, size_bytes);
-  TinyMAT_fseek(mat, endpos);
-
-  mat->endCell();
-}
-
-
-void TinyMATWriter_writeStringList(TinyMATWriterFile *mat, const char *name, const std::list<std::string> &data)
-{
-    mat->addStructItemName(name);
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    long sizepos=TinyMAT_ftell(mat);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    TinyMAT_write32(mat, (int32_t)1);
-    TinyMAT_write32(mat, (int32_t)data.size());
-
-    // write field name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    // write data type
-    for (std::list<std::string>::const_iterator it=data.begin(); it!=data.end(); it++) {
-        std::string a=*it;
-        TinyMATWriter_writeString(mat, "", a.c_str(), (uint32_t)a.size());
-    }
-
-    long endpos=TinyMAT_ftell(mat);
-    TinyMAT_fseek(mat, sizepos);
-    size_bytes=endpos-sizepos-4;
-    TinyMAT_writeU32(mat, size_bytes);
-    TinyMAT_fseek(mat, endpos);
-}
-
-
-void TinyMATWriter_writeStringVector(TinyMATWriterFile *mat, const char *name, const std::vector<std::string> &data)
-{
-    mat->addStructItemName(name);
-    uint32_t size_bytes=0;
-    uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
-
-    // write tag header
-    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-    long sizepos=TinyMAT_ftell(mat);
-    TinyMAT_writeU32(mat, size_bytes);
-
-    // write arrayflags
-    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-    // write field dimensions
-    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-    TinyMAT_writeU32(mat, (uint32_t)8);
-    TinyMAT_write32(mat, (int32_t)1);
-    TinyMAT_write32(mat, (int32_t)data.size());
-
-    // write field name
-    TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-    // write data type
-    for (std::vector<std::string>::const_iterator it=data.begin(); it!=data.end(); it++) {
-        std::string a=*it;
-        TinyMATWriter_writeString(mat, "", a.c_str(), (uint32_t)a.size());
-    }
-
-    long endpos=TinyMAT_ftell(mat);
-    TinyMAT_fseek(mat, sizepos);
-    size_bytes=endpos-sizepos-4;
-    TinyMAT_writeU32(mat, size_bytes);
-    TinyMAT_fseek(mat, endpos);
-}
-
-
-#ifdef TINYMAT_USES_QVARIANT
-    void TinyMATWriter_writeQVariantList(TinyMATWriterFile *mat, const char *name, const QVariantList &data)
-    {
-        mat->addStructItemName(name);
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
-
-
-
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-        TinyMAT_writeU32(mat, (uint32_t)8);
-        TinyMAT_write32(mat, (int32_t)1);
-        TinyMAT_write32(mat, (int32_t)data.size());
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        for (int i=0; i<data.size(); i++) {
-            if (data[i].type()==QVariant::String) {
-                QByteArray a=data[i].toString().toLatin1();
-                TinyMATWriter_writeString(mat, "", a.data(), a.size());
-            } else if (data[i].type()==QVariant::Map) {
-                QVariantMap a=data[i].toMap();
-                TinyMATWriter_writeQVariantMap(mat, "", a);
-            } else if (data[i].type()==QVariant::List) {
-                QVariantList a=data[i].toList();
-                //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
-                TinyMATWriter_writeQVariantList(mat, "", a);
-
-            } else if (data[i].canConvert(QVariant::Double)) {
-                double a=data[i].toDouble();
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
-            } else if (data[i].canConvert(QVariant::PointF)) {
-                double a[2]={data[i].toPointF().x(), data[i].toPointF().y()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (data[i].canConvert(QVariant::Point)) {
-                double a[2]={(double)data[i].toPoint().x(), (double)data[i].toPoint().y()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (data[i].canConvert(QVariant::SizeF)) {
-                double a[2]={data[i].toSizeF().width(), data[i].toSizeF().height()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (data[i].canConvert(QVariant::Size)) {
-                double a[2]={(double)data[i].toSize().width(), (double)data[i].toSize().height()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (data[i].canConvert(QVariant::String)) {
-                QByteArray a=data[i].toString().toLatin1();
-                TinyMATWriter_writeString(mat, "", a.data(), a.size());
-            } else {
-                TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
-            }
-        }
-
-        long endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-
-    void TinyMATWriter_writeQStringList(TinyMATWriterFile *mat, const char *name, const QStringList &data)
-    {
-        mat->addStructItemName(name);
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-        TinyMAT_writeU32(mat, (uint32_t)8);
-        TinyMAT_write32(mat, (int32_t)1);
-        TinyMAT_write32(mat, (int32_t)data.size());
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        for (int i=0; i<data.size(); i++) {
-            QByteArray a=data[i].toLatin1();
-            TinyMATWriter_writeString(mat, "", a.data(), a.size());
-        }
-
-        long endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-    }
-
-    void TinyMATWriter_writeQVariantMatrix_listofcols(TinyMATWriterFile *mat, const char *name, const QList<QList<QVariant> > &data)
-    {
-        mat->addStructItemName(name);
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
-
-
-        int32_t maxrows=0;
-        for (int i=0; i<data.size(); i++) {
-            for (int j=0; j<data[i].size(); j++) {
-                maxrows=qMax(maxrows, data[i].size());
-            }
-        }
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos;
-        sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-        TinyMAT_writeU32(mat, (uint32_t)8);
-        TinyMAT_write32(mat, (int32_t)maxrows);
-        TinyMAT_write32(mat, (int32_t)data.size());
-
-        // write field name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write data type
-        for (int j=0; j<maxrows; j++) {
-            for (int i=0; i<data.size(); i++) {
-                QVariant v;
-                if (j<data[i].size()) {
-                    v=data[i].operator[](j);
-                }
-                //std::cout<<"+++ "<<i<<"/"<<j<<":   "<<TinyMAT_ftell(mat)<<" "<<(TinyMAT_ftell(mat)%8)<<"  write '"<<v.toString().toStdString()<<"'\n";
-                if (v.type()==QVariant::String) {
-                    QByteArray a=v.toString().toLatin1();
-                    //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
-                    TinyMATWriter_writeString(mat, "", a.data(), a.size());
-                } else if (v.type()==QVariant::Map) {
-                    QVariantMap a=v.toMap();
-                    TinyMATWriter_writeQVariantMap(mat, "", a);
-
-                } else if (v.type()==QVariant::List) {
-                    QVariantList a=v.toList();
-                    //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
-                    TinyMATWriter_writeQVariantList(mat, "", a);
-                } else if (v.canConvert(QVariant::Double)) {
-                    double a=v.toDouble();
-                    //std::cout<<i<<" "<<j<<" "<<a<<"\n";
-                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
-                } else if (v.canConvert(QVariant::PointF)) {
-                    double a[2]={v.toPointF().x(), v.toPointF().y()};
-                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-                } else if (v.canConvert(QVariant::Point)) {
-                    double a[2]={(double)v.toPoint().x(), (double)v.toPoint().y()};
-                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-                } else if (v.canConvert(QVariant::SizeF)) {
-                    double a[2]={v.toSizeF().width(), v.toSizeF().height()};
-                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-                } else if (v.canConvert(QVariant::Size)) {
-                    double a[2]={(double)v.toSize().width(), (double)v.toSize().height()};
-                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-                } else if (v.canConvert(QVariant::String)) {
-                    QByteArray a=v.toString().toLatin1();
-                    TinyMATWriter_writeString(mat, "", a.data(), a.size());
-                } else {
-                    //std::cout<<i<<" "<<j<<" "<<"EMPTY"<<"\n";
-                    TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
-                }
-                //std::cout<<"### "<<i<<"/"<<j<<":   "<<TinyMAT_ftell(mat)<<" "<<(TinyMAT_ftell(mat)%8)<<"\n";
-            }
-        }
-
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        //fsetpos(mat->file, &sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-        //fsetpos(mat->file, &endpos);
-        //std::cout<<endpos<<" "<<TinyMAT_ftell(mat)<<"\n";
-    }
-
-
-
-
-    void TinyMATWriter_writeQVariantMap(TinyMATWriterFile *mat, const char *name, const QVariantMap &data)
-    {
-        mat->addStructItemName(name);
-        mat->startStruct();
-        uint32_t size_bytes=0;
-        uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
-        QVariantMap::ConstIterator i;
-        QList<QByteArray> names;
-        int32_t maxlen=0;
-        for (i = data.begin(); i != data.end(); ++i) {
-            QString ni=i.key();
-            QByteArray n=ni.toLocal8Bit();
-            n=n.left(31);
-            maxlen=qMax(maxlen, (int32_t)n.size());
-            names<<n;
-        }
-        if (maxlen<32) maxlen=32;
-        // pad all field names to maxlen
-        for (int ii=0; ii<names.size(); ii++) {
-            while (names[ii].size()<maxlen) {
-                names[ii].append('\0');
-            }
-        }
-
-
-
-        // write tag header
-        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
-        long sizepos;
-        sizepos=TinyMAT_ftell(mat);
-        TinyMAT_writeU32(mat, size_bytes);
-
-        // write arrayflags
-        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
-
-        // write field dimensions
-        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
-        TinyMAT_writeU32(mat, (uint32_t)8);
-        TinyMAT_write32(mat, (int32_t)1);
-        TinyMAT_write32(mat, (int32_t)1);
-
-        // write struct name
-        TinyMAT_writeDatElement_stringas8bit(mat, name);
-
-        // write field name length
-        TinyMAT_writeDatElementS_i32(mat, maxlen);
-
-        // write field names
-        QByteArray joinednames;//=names.join();
-        for (int i=0; i<names.size(); i++)  {
-            joinednames+=names[i];
-        }
-        TinyMAT_writeDatElement_i8a(mat, (int8_t*)joinednames.data(), joinednames.size());
-
-        // write data type
-        for (i = data.begin(); i != data.end(); ++i) {
-            QVariant v=i.value();
-            QString n=i.key();
-
-            if (v.type()==QVariant::String) {
-                QByteArray a=v.toString().toLatin1();
-                TinyMATWriter_writeString(mat, "", a.data(), a.size());
-            } else if (v.type()==QVariant::List) {
-                QVariantList a=v.toList();
-                TinyMATWriter_writeQVariantList(mat, "", a);
-            } else if (v.type()==QVariant::Map) {
-                QVariantMap a=v.toMap();
-                TinyMATWriter_writeQVariantMap(mat, "", a);
-            } else if (v.canConvert(QVariant::Double)) {
-                double a=v.toDouble();
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
-            } else if (v.canConvert(QVariant::PointF)) {
-                double a[2]={v.toPointF().x(), v.toPointF().y()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (v.canConvert(QVariant::Point)) {
-                double a[2]={(double)v.toPoint().x(), (double)v.toPoint().y()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (v.canConvert(QVariant::SizeF)) {
-                double a[2]={v.toSizeF().width(), v.toSizeF().height()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (v.canConvert(QVariant::Size)) {
-                double a[2]={(double)v.toSize().width(), (double)v.toSize().height()};
-                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
-            } else if (v.canConvert(QVariant::String)) {
-                QByteArray a=v.toString().toLatin1();
-                TinyMATWriter_writeString(mat, "", a.data(), a.size());
-            } else {
-                TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
-            }
-        }
-
-        long endpos;
-        endpos=TinyMAT_ftell(mat);
-        TinyMAT_fseek(mat, sizepos);
-        size_bytes=endpos-sizepos-4;
-        TinyMAT_writeU32(mat, size_bytes);
-        TinyMAT_fseek(mat, endpos);
-        mat->endStruct();
-    }
-
-#endif
-
-#ifdef TINYMAT_USES_OPENCV
-void TinyMATWriter_writeCVMat(TinyMATWriterFile* mat, const char* name, const cv::Mat& img) {
-    if (img.rows<=0 || img.cols<=0) {
-      //throw std::runtime_error("OpenCV Matrix has too many dimensions or is empty");
-      TinyMATWriter_writeEmptyMatrix(mat, name);
-    } else {
-      //mat->addStructItemName(name);
-      int32_t sizes[2] = { img.cols, img.rows };
-      uint32_t ndims = 2;
-      cv::Mat tmp = img.clone(); // make a full copy of the input matrix. The copy will contain the data in continuous form!!!
-      if (tmp.depth() == CV_8U) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (uint8_t*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_8S) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (int8_t*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_16U) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (uint16_t*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_16S) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (int16_t*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_32S) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (int32_t*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_32F) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (float*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else if (tmp.depth() == CV_64F) {
-        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (double*)tmp.data, sizes, ndims, (uint32_t)img.channels());
-      } else {
-        throw std::runtime_error("OpenCV Matrix has a datatype which is not supported by TinyMATWriter_writeCVMat()");
-      }
-    }
-}
-
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2d>& data_vec) {
-  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
-  double* tmp = (double*)malloc(data_vec.size() * 2 * sizeof(double));
-  int i = 0;
-  for (auto& it : data_vec) {
-
-    tmp[0 + i] = it.x;
-    tmp[(data_vec.size()) + i] = it.y;
-    i++;
-  }
-  TinyMATWriter_writeMatrix2D_rowmajor<double>(mat, name, tmp, (int32_t)data_vec.size(), 2);
-  free(tmp);
-}
-
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2i>& data_vec) {
-  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
-  int* tmp = (int*)malloc(data_vec.size() * 2 * sizeof(int));
-  int i = 0;
-  for (auto& it : data_vec) {
-
-    tmp[0 + i] = it.x;
-    tmp[(data_vec.size()) + i] = it.y;
-    i++;
-  }
-  TinyMATWriter_writeMatrix2D_rowmajor<int>(mat, name, tmp, (int32_t)data_vec.size(), 2);
-  free(tmp);
-}
-
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2f>& data_vec) {
-  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
-  float* tmp = (float*)malloc(data_vec.size() * 2 * sizeof(float));
-  int i = 0;
-  for (auto& it : data_vec) {
-
-    tmp[0 + i] = it.x;
-    tmp[(data_vec.size()) + i] = it.y;
-    i++;
-  }
-  TinyMATWriter_writeMatrix2D_rowmajor<float>(mat, name, tmp, (int32_t)data_vec.size(), 2);
-  free(tmp);
-}
-
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2l>& data_vec) {
-  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
-  int64_t* tmp = (int64_t*)malloc(data_vec.size() * 2 * sizeof(int64_t));
-  int i = 0;
-  for (auto& it : data_vec) {
-
-    tmp[0 + i] = it.x;
-    tmp[(data_vec.size()) + i] = it.y;
-    i++;
-  }
-  TinyMATWriter_writeMatrix2D_rowmajor<int64_t>(mat, name, tmp, (int32_t)data_vec.size(), 2);
-  free(tmp);
-}
-
-#endif
-
-void TinyMATWriter_writeMatrixND_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) {
-	TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, sizes, ndims);
-}
-
-void TinyMATWriter_writeMatrix2D_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows) {
-	int32_t siz[2]={cols, rows};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
-}
-
-void TinyMATWriter_writeString_exp(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen) {
-	TinyMATWriter_writeString(mat, name, data, slen);
-}
-
-void TinyMATWriter_writeMatrixND_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) {
-	TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, sizes, ndims);
-}
-
-void TinyMATWriter_writeMatrix2D_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows) {
-    int32_t siz[2]={rows, cols};
-    TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, siz, 2);
-}
-
-long TinyMATWriter_ftell(TinyMATWriterFile* file) {
-	return static_cast<long>(file->filedata_current);
-}
-
-uint8_t* TinyMATWriter_data(TinyMATWriterFile* file) {
-	return file->filedata;
-}
+/*
+    Copyright (c) 2008-2020 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <list>
+#include <algorithm>
+#include <stdexcept>
+
+//#include <iostream>
+
+#include "tinymatwriter.h"
+
+#ifdef TINYMAT_USES_ZLIB
+#  include <zlib.h>
+#endif
+
+/** \brief if defined, the library does not use threads (e.g. parallel compression), set automatically for WASM-builds without pthreads */
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__) && !defined(TINYMAT_NO_THREADS)
+#  define TINYMAT_NO_THREADS
+#endif
+#ifndef TINYMAT_NO_THREADS
+#  include <thread>
+#  include <mutex>
+#  include <condition_variable>
+#  include <deque>
+#endif
+
+/** \brief defined, if the SSE2 kernels are available (part of every x86-64 CPU), define TINYMAT_NO_SIMD to always use the scalar kernels */
+#if !defined(TINYMAT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2))
+#  define TINYMAT_HAS_SSE2
+#  include <emmintrin.h>
+#endif
+
+/** \brief defined, if the \c TINYMAT_BACKEND_MMAP backend is available (POSIX systems only) */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#  define TINYMAT_HAS_MMAP
+#  include <sys/mman.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#  include <limits.h>
+#  include <errno.h>
+#  ifndef IOV_MAX
+#    define IOV_MAX 1024
+#  endif
+#endif
+
+/** \brief the backend used by TinyMATWriter_open() and for \c TINYMAT_BACKEND_AUTO without a size hint:
+ *          - if TINYMAT_WRITE_VIA_MMAP is defined, the output is written into a memory-mapped file,
+ *          - if TINYMAT_WRITE_VIA_MEMORY is defined, files are beeing created in a memory buffer and are only written to disk at the end,
+ *          - otherwise the files are written directly to disk, including move operations on disk, which can be a factor 2-3 slower.
+ */
+#if defined(TINYMAT_WRITE_VIA_MMAP) && defined(TINYMAT_HAS_MMAP)
+#  define TINYMAT_BACKEND_DEFAULT TINYMAT_BACKEND_MMAP
+#elif defined(TINYMAT_WRITE_VIA_MEMORY) || defined(TINYMAT_WRITE_VIA_MMAP)
+#  define TINYMAT_BACKEND_DEFAULT TINYMAT_BACKEND_MEMORY
+#else
+#  define TINYMAT_BACKEND_DEFAULT TINYMAT_BACKEND_STDIO
+#endif
+
+#ifndef __WINDOWS__
+# if defined(WIN32) || defined(WIN64) || defined(_MSC_VER) || defined(_WIN32)
+#  define __WINDOWS__
+# endif
+#endif
+
+#ifndef __LINUX__
+# if defined(linux)
+#  define __LINUX__
+# endif
+#endif
+#ifdef TINYMAT_USES_QVARIANT
+//#  include <QDebug>
+#  include <QPoint>
+#  include <QSize>
+#endif
+
+#define TINYMAT_ORDER_UNKNOWN 0
+#define TINYMAT_ORDER_BIGENDIAN 1
+#define TINYMAT_ORDER_LITTLEENDIAN 2
+
+
+#if defined(__GNUC__) || defined(__GNUG__)
+#define TINYMAT_inlineattrib  inline
+// use this for no-inline:
+//#define TINYMAT_inlineattrib  __attribute__((noinline))
+#else
+#define TINYMAT_inlineattrib inline
+#endif
+
+
+
+
+#define TINYMAT_mxCHAR_CLASS_CLASS_arrayflags 0x00000004
+#define TINYMAT_mxDOUBLE_CLASS_arrayflags 0x00000006
+#define TINYMAT_mxSINGLE_CLASS_arrayflags 0x00000007
+#define TINYMAT_mxINT8_CLASS_arrayflags 0x00000008
+#define TINYMAT_mxUINT8_CLASS_arrayflags 0x00000009
+#define TINYMAT_mxINT16_CLASS_arrayflags 0x0000000A
+#define TINYMAT_mxUINT16_CLASS_arrayflags 0x0000000B
+#define TINYMAT_mxINT32_CLASS_arrayflags 0x0000000C
+#define TINYMAT_mxUINT32_CLASS_arrayflags 0x0000000D
+#define TINYMAT_mxINT64_CLASS_arrayflags 0x0000000E
+#define TINYMAT_mxUINT64_CLASS_arrayflags 0x0000000F
+#define TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags (TINYMAT_mxUINT8_CLASS_arrayflags+(0x0002<<8))
+#define TINYMAT_mxSPARSE_CLASS_arrayflags 0x00000005
+#define TINYMAT_mxSPARSE_LOGICAL_CLASS_arrayflags (TINYMAT_mxSPARSE_CLASS_arrayflags+(0x0002<<8))
+/** \brief flag in the array flags of complex arrays, which are followed by the imaginary part after the real part */
+#define TINYMAT_mxCOMPLEX_flag 0x00000800
+
+
+#define TINYMAT_miINT8 1
+#define TINYMAT_miUINT8 2
+#define TINYMAT_miINT16 3
+#define TINYMAT_miUINT16 4
+#define TINYMAT_miINT32 5
+#define TINYMAT_miUINT32 6
+#define TINYMAT_miSINGLE 7
+#define TINYMAT_miDOUBLE 9
+#define TINYMAT_miINT64 12
+#define TINYMAT_miUINT64 13
+#define TINYMAT_miMATRIX 14
+#define TINYMAT_miCOMPRESSED 15
+#define TINYMAT_miUTF8 16
+#define TINYMAT_miUTF16 17
+#define TINYMAT_miUTF32 18
+
+struct TinyMATWriterStruct {
+  inline TinyMATWriterStruct() :
+    sizepos(-1),
+    data_start(-1)
+  {
+  }
+  /** \brief position of the size-data field */
+  long sizepos;
+  long data_start;
+  std::vector<std::string> itemnames;
+};
+
+struct TinyMATWriterCell {
+  inline TinyMATWriterCell() :
+    sizepos(-1),
+    data_start(-1)
+  {
+  }
+  /** \brief position of the size-data field */
+  long sizepos;
+  long data_start;
+};
+
+enum class TinyMATWriterStackItem {
+  Cell,
+  Struct
+};
+
+/*! \brief a block of data, that is not copied into a TinyMATWriterBuffer, but inserted in front of TinyMATWriterReference::buffer_pos when the buffer is written
+
+    This is either an array of the caller (see TinyMATWriter_writeMatrixND_colmajor_ref() ) or a block, that is owned by the
+    reference itself (e.g. the field names of a struct, see TinyMATWriter_endStruct() ).
+    \ingroup tinymatwriter
+    \internal
+ */
+struct TinyMATWriterReference {
+    inline TinyMATWriterReference(const void* data_, size_t size_, size_t buffer_pos_, uint64_t preceding_) :
+      data(data_),
+      size(size_),
+      buffer_pos(buffer_pos_),
+      preceding(preceding_)
+    {
+    }
+
+    /** \brief memory of the caller, or owned->data() */
+    const void* data;
+    /** \brief size of data in bytes */
+    size_t size;
+    /** \brief the referenced data is inserted in front of this position of the buffer */
+    size_t buffer_pos;
+    /** \brief sum of the sizes of all references before this one */
+    uint64_t preceding;
+    /** \brief holds data, if it is not memory of the caller */
+    std::shared_ptr<std::vector<uint8_t> > owned;
+};
+
+/*! \brief a growable memory buffer, used as file-cache and to stage variables before they are compressed
+    \ingroup TinyMATwriter
+    \internal
+ */
+struct TinyMATWriterBuffer {
+    inline TinyMATWriterBuffer() :
+      data(NULL),
+      size(0),
+      current(0),
+      count(0),
+      mapped_fd(-1)
+    {
+    }
+
+    /** \brief the memory array */
+    uint8_t* data;
+    /** \brief allocated size of data */
+    size_t size;
+    /** \brief current read/write position in data */
+    size_t current;
+    /** \brief number of valid bytes in data */
+    size_t count;
+    /** \brief if >=0, data is a memory-mapped view of this file descriptor (see TinyMAT_mapMem() ), otherwise it is allocated with malloc() */
+    int mapped_fd;
+    /** \brief blocks, that are inserted into data when the buffer is written, ordered by TinyMATWriterReference::buffer_pos */
+    std::vector<TinyMATWriterReference> references;
+};
+
+/*! \brief a rule of a TinyMATWriterCompressionPolicy: top-level variables with a name matching pattern are stored with level
+    \ingroup TinyMATwriter
+    \internal
+ */
+struct TinyMATWriterCompressionRule {
+    /** \brief pattern for the variable name, may contain the wildcards \c * and \c ? */
+    std::string pattern;
+    int level;
+};
+
+/*! \brief the policy that decides how each top-level variable is stored (see TinyMAT_decideCompression() )
+    \ingroup TinyMATwriter
+    \internal
+
+    A policy is never changed, once it is in use by a TinyMATWriterFile, as it is shared with the compression worker threads.
+    The setters replace it by a modified copy instead.
+ */
+struct TinyMATWriterCompressionPolicy {
+    inline TinyMATWriterCompressionPolicy() :
+      adaptive(false),
+      min_size(256),
+      raw_ratio(0.9),
+      fast_ratio(0.6),
+      sample_size(3*16*1024)
+    {
+    }
+
+    /** \brief if \c true, the payload of each variable is sampled to choose between raw storage, fast and strong compression */
+    bool adaptive;
+    /** \brief (adaptive only) variables with fewer bytes are stored raw */
+    uint64_t min_size;
+    /** \brief (adaptive only) variables are stored raw, if a trial compression of a sample does not reach this ratio (compressed/raw) */
+    double raw_ratio;
+    /** \brief (adaptive only) variables are compressed with TINYMAT_COMPRESSION_FAST, if a trial compression of a sample does not reach this ratio (compressed/raw) */
+    double fast_ratio;
+    /** \brief (adaptive only) number of bytes used for the trial compression, taken in three slices from the start, middle and end of the variable */
+    size_t sample_size;
+    /** \brief rules for variable names, the first matching rule decides the level */
+    std::vector<TinyMATWriterCompressionRule> rules;
+
+    /** \brief returns \c true, if this policy may decide something else than the configured compression level */
+    inline bool isActive() const {
+      return adaptive || rules.size()>0;
+    }
+};
+
+#ifdef TINYMAT_USES_ZLIB
+/*! \brief matches \a str against \a pattern, which may contain the wildcards \c * (any sequence) and \c ? (any character)
+    \ingroup tinymatwriter
+    \internal
+ */
+static bool TinyMAT_matchPattern(const char* pattern, const char* str) {
+    const char* star=NULL;
+    const char* star_str=NULL;
+    while (*str) {
+        if (*pattern=='?' || *pattern==*str) {
+            pattern++;
+            str++;
+        } else if (*pattern=='*') {
+            star=pattern++;
+            star_str=str;
+        } else if (star) {
+            pattern=star+1;
+            str=++star_str;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern=='*') pattern++;
+    return (*pattern==0);
+}
+
+/*! \brief reads the variable name from a complete miMATRIX element \a data (as written into TinyMATWriterFile::staging)
+    \ingroup tinymatwriter
+    \internal
+ */
+static std::string TinyMAT_elementName(const uint8_t* data, size_t size) {
+    // miMATRIX tag (8 bytes), array flags (16 bytes), dimensions (8 bytes tag + padded data), name
+    size_t pos=8+16;
+    uint32_t tag[2];
+    if (pos+8>size) return std::string();
+    memcpy(tag, &(data[pos]), 8);
+    pos=pos+8+((tag[1]+7)/8)*8;
+    if (pos+8>size) return std::string();
+    memcpy(tag, &(data[pos]), 8);
+    if ((tag[0]>>16)!=0) {
+        // small data element format
+        return std::string(reinterpret_cast<const char*>(&(data[pos+4])), std::min<uint32_t>(tag[0]>>16, 4));
+    }
+    if (pos+8+tag[1]>size) return std::string();
+    return std::string(reinterpret_cast<const char*>(&(data[pos+8])), tag[1]);
+}
+
+/*! \brief compresses \a size bytes from \a data into a zlib-stream in \a out
+    \ingroup tinymatwriter
+    \internal
+
+    This produces the same bytes as TinyMAT_writeCompressedElement(), but does not touch the file, so it may be called from worker threads.
+ */
+static void TinyMAT_deflateBlock(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out) {
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit(&strm, level)!=Z_OK) {
+        throw std::runtime_error("could not initialize zlib for writing a compressed variable");
+    }
+    out.resize(deflateBound(&strm, static_cast<uLong>(size)));
+    strm.next_in=const_cast<Bytef*>(data);
+    strm.avail_in=static_cast<uInt>(size);
+    strm.next_out=out.data();
+    strm.avail_out=static_cast<uInt>(out.size());
+    const int zres=deflate(&strm, Z_FINISH);
+    out.resize(strm.total_out);
+    deflateEnd(&strm);
+    if (zres!=Z_STREAM_END) {
+        throw std::runtime_error("error while compressing a variable with zlib");
+    }
+}
+
+/*! \brief decides, with which compression level the top-level variable \a name (complete miMATRIX element in \a data) is stored
+    \ingroup tinymatwriter
+    \internal
+
+    \param policy the policy of the file
+    \param name name of the variable
+    \param data the uncompressed miMATRIX element
+    \param size number of bytes in \a data
+    \param level the compression level configured for this variable (TinyMATWriter_setCompression(), TinyMATWriter_setNextCompression() )
+    \param[out] reason why this level was chosen (\c TINYMAT_DECISION_... )
+    \param[out] sample_ratio ratio (compressed/raw) of the trial compression, or -1 if there was none
+    \return the compression level, \c TINYMAT_COMPRESSION_NONE stores the variable raw
+
+    This does not touch the file, so it may be called from worker threads.
+ */
+static int TinyMAT_decideCompression(const TinyMATWriterCompressionPolicy* policy, const std::string& name, const uint8_t* data, size_t size, int level, int* reason, double* sample_ratio) {
+    *reason=TINYMAT_DECISION_LEVEL;
+    *sample_ratio=-1;
+    if (!policy) return level;
+    for (size_t i=0; i<policy->rules.size(); i++) {
+        if (TinyMAT_matchPattern(policy->rules[i].pattern.c_str(), name.c_str())) {
+            *reason=TINYMAT_DECISION_RULE;
+            return policy->rules[i].level;
+        }
+    }
+    if (!policy->adaptive || level<=TINYMAT_COMPRESSION_NONE) return level;
+    if (size<policy->min_size) {
+        *reason=TINYMAT_DECISION_SMALL;
+        return TINYMAT_COMPRESSION_NONE;
+    }
+
+    // trial compression of three slices from the start, middle and end of the variable
+    std::vector<uint8_t> sample;
+    if (size<=policy->sample_size) {
+        sample.assign(data, data+size);
+    } else {
+        const size_t slice=std::max<size_t>(policy->sample_size/3, 1);
+        const size_t starts[3]={0, (size-slice)/2, size-slice};
+        sample.reserve(3*slice);
+        for (int i=0; i<3; i++) {
+            sample.insert(sample.end(), data+starts[i], data+starts[i]+slice);
+        }
+    }
+    std::vector<uint8_t> compressed;
+    TinyMAT_deflateBlock(sample.data(), sample.size(), TINYMAT_COMPRESSION_FAST, compressed);
+    *sample_ratio=static_cast<double>(compressed.size())/static_cast<double>(std::max<size_t>(sample.size(), 1));
+    if (*sample_ratio>=policy->raw_ratio) {
+        *reason=TINYMAT_DECISION_INCOMPRESSIBLE;
+        return TINYMAT_COMPRESSION_NONE;
+    }
+    if (*sample_ratio>=policy->fast_ratio) {
+        *reason=TINYMAT_DECISION_POORLY_COMPRESSIBLE;
+        return std::min<int>(level, TINYMAT_COMPRESSION_FAST);
+    }
+    *reason=TINYMAT_DECISION_COMPRESSIBLE;
+    return level;
+}
+#endif
+
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+/*! \brief a top-level variable that is compressed by a TinyMATWriterCompressionPool
+    \ingroup TinyMATwriter
+    \internal
+ */
+struct TinyMATWriterCompressionJob {
+    inline TinyMATWriterCompressionJob() :
+      level(0),
+      reason(TINYMAT_DECISION_LEVEL),
+      sample_ratio(-1),
+      done(false)
+    {
+    }
+    inline ~TinyMATWriterCompressionJob() {
+      if (raw.data) free(raw.data);
+    }
+
+    /** \brief the uncompressed miMATRIX element (the former staging buffer of the file) */
+    TinyMATWriterBuffer raw;
+    /** \brief zlib compression level, replaced by the decision of policy (if set) in the worker thread */
+    int level;
+    /** \brief the compression policy of the file, when the variable was written */
+    std::shared_ptr<const TinyMATWriterCompressionPolicy> policy;
+    /** \brief name of the variable, valid once done is set */
+    std::string name;
+    /** \brief why level was chosen, valid once done is set */
+    int reason;
+    /** \brief result of the trial compression, valid once done is set */
+    double sample_ratio;
+    /** \brief the compressed zlib-stream (empty, if the variable is stored raw), valid once done is set */
+    std::vector<uint8_t> compressed;
+    /** \brief error message, if the compression failed */
+    std::string error;
+    /** \brief set by the worker thread, when compressed (or error) is available */
+    bool done;
+};
+
+/*! \brief a pool of worker threads that compress top-level variables in parallel
+    \ingroup TinyMATwriter
+    \internal
+
+    Variables are handed to the pool with submit() in API-call order and are kept in pending
+    until they are committed to the file in the same order (see TinyMAT_commitCompressionJobs() ).
+ */
+struct TinyMATWriterCompressionPool {
+    explicit TinyMATWriterCompressionPool(int nthreads) :
+      stop(false),
+      max_pending(2*static_cast<size_t>(nthreads))
+    {
+      for (int i=0; i<nthreads; i++) {
+        threads.push_back(std::thread(&TinyMATWriterCompressionPool::run, this));
+      }
+    }
+    ~TinyMATWriterCompressionPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop=true;
+      }
+      work_cv.notify_all();
+      for (size_t i=0; i<threads.size(); i++) {
+        threads[i].join();
+      }
+      for (size_t i=0; i<spare.size(); i++) {
+        if (spare[i].data) free(spare[i].data);
+      }
+    }
+
+    /** \brief hands \a job to the worker threads and appends it to pending */
+    void submit(const std::shared_ptr<TinyMATWriterCompressionJob>& job) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(job);
+      }
+      pending.push_back(job);
+      work_cv.notify_one();
+    }
+
+    /** \brief returns \c true, if \a job has been processed by a worker thread. If \a block is set, this waits for the job. */
+    bool isDone(const std::shared_ptr<TinyMATWriterCompressionJob>& job, bool block) {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (block) {
+        done_cv.wait(lock, [&job]() { return job->done; });
+      }
+      return job->done;
+    }
+
+    /** \brief the worker thread function */
+    void run() {
+      for (;;) {
+        std::shared_ptr<TinyMATWriterCompressionJob> job;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          work_cv.wait(lock, [this]() { return stop || !queue.empty(); });
+          if (stop && queue.empty()) return;
+          job=queue.front();
+          queue.pop_front();
+        }
+        std::vector<uint8_t> compressed;
+        std::string error, name;
+        int level=job->level, reason=TINYMAT_DECISION_LEVEL;
+        double sample_ratio=-1;
+        try {
+          name=TinyMAT_elementName(job->raw.data, job->raw.count);
+          if (job->policy) {
+            level=TinyMAT_decideCompression(job->policy.get(), name, job->raw.data, job->raw.count, level, &reason, &sample_ratio);
+          }
+          if (level>TINYMAT_COMPRESSION_NONE) {
+            TinyMAT_deflateBlock(job->raw.data, job->raw.count, level, compressed);
+          }
+        } catch (std::exception& e) {
+          error=e.what();
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          job->compressed.swap(compressed);
+          job->error=error;
+          job->name=name;
+          job->level=level;
+          job->reason=reason;
+          job->sample_ratio=sample_ratio;
+          job->done=true;
+        }
+        done_cv.notify_all();
+      }
+    }
+
+    std::vector<std::thread> threads;
+    /** \brief jobs waiting for a worker thread */
+    std::deque<std::shared_ptr<TinyMATWriterCompressionJob> > queue;
+    /** \brief all submitted jobs, that have not yet been committed to the file, in API-call order (only accessed by the writing thread) */
+    std::deque<std::shared_ptr<TinyMATWriterCompressionJob> > pending;
+    /** \brief staging buffers of committed jobs, which are reused for the next variables (only accessed by the writing thread) */
+    std::vector<TinyMATWriterBuffer> spare;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    bool stop;
+    /** \brief the writing thread blocks, if more jobs than this are pending, which limits the memory used for staging */
+    size_t max_pending;
+};
+#else
+struct TinyMATWriterCompressionPool; // forward, not available in this build
+#endif
+
+#ifdef TINYMAT_USES_ZLIB
+/*! \brief a top-level variable that is compressed while it is written, instead of being staged as a whole (see TinyMAT_startStreaming() )
+    \ingroup TinyMATwriter
+    \internal
+ */
+struct TinyMATWriterDeflateStream {
+    inline TinyMATWriterDeflateStream() :
+      sizepos(0),
+      startpos(0),
+      raw_size(0),
+      level(TINYMAT_COMPRESSION_NONE),
+      reason(TINYMAT_DECISION_LEVEL),
+      sample_ratio(-1)
+    {
+      memset(&strm, 0, sizeof(strm));
+    }
+
+    z_stream strm;
+    /** \brief output chunk of the deflate stream, the only memory used in addition to the output */
+    std::vector<uint8_t> out;
+    /** \brief position of the size field of the miCOMPRESSED element */
+    long sizepos;
+    /** \brief position of the variable in the file */
+    long startpos;
+    /** \brief size of the uncompressed miMATRIX element */
+    uint64_t raw_size;
+    std::string name;
+    /** \brief compression level, \c TINYMAT_COMPRESSION_NONE if the policy decided to write the variable raw */
+    int level;
+    int reason;
+    double sample_ratio;
+};
+#else
+struct TinyMATWriterDeflateStream; // forward, not available in this build
+#endif
+
+/*! \brief this struct represents a mat file
+    \ingroup TinyMATwriter
+    \internal
+ */
+struct TinyMATWriterFile {
+    TinyMATWriterFile() :
+      file(NULL),
+      backend(TINYMAT_BACKEND_STDIO),
+      sink_pos(0),
+      sink_end(0),
+      byteorder(TINYMAT_ORDER_UNKNOWN),
+      staging_active(false),
+      variable_depth(0),
+      compression_level(TINYMAT_COMPRESSION_NONE),
+      next_compression_level(-1),
+      current_compression_level(TINYMAT_COMPRESSION_NONE),
+      compression_pool(NULL),
+      compression_report(NULL),
+      compression_report_userdata(NULL),
+      streaming_threshold(TINYMAT_COMPRESSION_STREAMING_DEFAULT),
+      streamed(NULL),
+      zerocopy_candidate(NULL),
+      memory_limit(0),
+      flushed(0),
+      transpose_threads(TINYMAT_TRANSPOSE_THREADS_AUTO),
+      narrow_storage(false),
+      string_encoding(TINYMAT_STRING_ENCODING_UTF8)
+    {
+    }
+
+    /** \brief the libc file handle (not used by \c TINYMAT_BACKEND_CUSTOM ) */
+    FILE* file;
+    /** \brief the I/O backend, that is used for this file (\c TINYMAT_BACKEND_MEMORY, \c TINYMAT_BACKEND_STDIO, \c TINYMAT_BACKEND_MMAP or \c TINYMAT_BACKEND_CUSTOM ) */
+    int backend;
+    /** \brief Zwischenspeicher-Array beim Schreiben von Matlab-Daten (only used with \c TINYMAT_BACKEND_MEMORY and \c TINYMAT_BACKEND_MMAP ) */
+    TinyMATWriterBuffer filedata;
+    /** \brief the callbacks of a \c TINYMAT_BACKEND_CUSTOM file */
+    TinyMATWriterSink sink;
+    /** \brief current write position in sink */
+    uint64_t sink_pos;
+    /** \brief number of bytes written to sink */
+    uint64_t sink_end;
+
+    /** \brief specifies the byte order of the system (and the written file!) */
+    uint8_t byteorder;
+
+    /** \brief while \c true, all output goes to staging instead of the file, so the current top-level variable can be compressed as a whole */
+    bool staging_active;
+    /** \brief holds the (uncompressed) top-level variable that is currently written, if staging_active is set */
+    TinyMATWriterBuffer staging;
+    /** \brief nesting depth of variables that are currently written (0: between top-level variables) */
+    int variable_depth;
+    /** \brief compression level for top-level variables (TINYMAT_COMPRESSION_NONE ... TINYMAT_COMPRESSION_BEST) */
+    int compression_level;
+    /** \brief compression level for the next top-level variable only, or -1 to use compression_level */
+    int next_compression_level;
+    /** \brief compression level of the top-level variable that is currently written */
+    int current_compression_level;
+    /** \brief if set, top-level variables are compressed in parallel by this pool of worker threads */
+    TinyMATWriterCompressionPool* compression_pool;
+    /** \brief policy for adaptive compression and name rules, NULL if never configured */
+    std::shared_ptr<const TinyMATWriterCompressionPolicy> compression_policy;
+    /** \brief called with every decision of the compression policy */
+    TinyMATWriterCompressionReportFunction compression_report;
+    /** \brief user data for compression_report */
+    void* compression_report_userdata;
+    /** \brief compressed top-level variables of at least this size (in bytes) are compressed while they are written, 0 to always stage them */
+    uint64_t streaming_threshold;
+    /** \brief the top-level variable that is currently compressed while it is written, or NULL */
+    TinyMATWriterDeflateStream* streamed;
+    /** \brief while an array with TinyMATWriterArrayLayout::reference is written: the array of the caller, that may be referenced instead of copied into filedata (see TinyMATWriterZeroCopyScope ) */
+    const void* zerocopy_candidate;
+    /** \brief completed variables are written to the file, when filedata holds more than this many bytes (0: no limit) */
+    uint64_t memory_limit;
+    /** \brief number of bytes, that have already been written from filedata to the file (i.e. file position of filedata.data[0]) */
+    uint64_t flushed;
+    /** \brief number of threads for TinyMATWriter_transposeMatrices(), or TINYMAT_TRANSPOSE_THREADS_AUTO */
+    int transpose_threads;
+    /** \brief if set, numeric arrays are stored with the narrowest integer type, that holds all values (see TinyMATWriter_setStorageNarrowing() ) */
+    bool narrow_storage;
+    /** \brief encoding of the strings passed to the writer (see TinyMATWriter_setStringEncoding() ) */
+    int string_encoding;
+
+    std::vector<TinyMATWriterStruct> structures;
+    std::vector<TinyMATWriterCell> cells;
+    std::vector<TinyMATWriterStackItem> stack;
+
+    inline void startStruct() {
+      structures.push_back(TinyMATWriterStruct());
+      stack.push_back(TinyMATWriterStackItem::Struct);
+    }
+
+    void endStruct() {
+      structures.pop_back();
+      stack.pop_back();
+    }
+
+    inline TinyMATWriterStruct& lastStruct() {
+      return structures[structures.size()-1];
+    }
+
+    inline void addStructItemName(const std::string& name) {
+      if (structures.size()>0 && stack.size()>0 && stack[stack.size()-1]==TinyMATWriterStackItem::Struct) {
+        lastStruct().itemnames.push_back(name);
+      }
+    }
+
+    inline void startCell() {
+      cells.push_back(TinyMATWriterCell());
+      stack.push_back(TinyMATWriterStackItem::Cell);
+    }
+
+    void endCell() {
+      cells.pop_back();
+      stack.pop_back();
+    }
+
+    inline TinyMATWriterCell& lastCell() {
+      return cells[cells.size()-1];
+    }
+    
+};
+
+
+int TinyMATWriter_fOK(const TinyMATWriterFile* mat)  {
+    return (mat && (mat->file!=NULL || mat->backend==TINYMAT_BACKEND_CUSTOM || (mat->backend==TINYMAT_BACKEND_MEMORY && mat->filedata.data!=NULL)));
+}
+
+
+/*! \brief determines the byte order of the system
+    \ingroup tinymatwriter
+    \internal
+
+    \return TINYMAT_ORDER_BIGENDIAN or TINYMAT_ORDER_LITTLEENDIAN, or TINYMAT_ORDER_UNKNOWN if the byte order cannot be determined
+ */
+ TINYMAT_inlineattrib static int TinyMAT_get_byteorder()
+{
+        union {
+                long l;
+                char c[4];
+        } test;
+        test.l = 1;
+        if( test.c[3] && !test.c[2] && !test.c[1] && !test.c[0] )
+                return TINYMAT_ORDER_BIGENDIAN;
+
+        if( !test.c[3] && !test.c[2] && !test.c[1] && test.c[0] )
+                return TINYMAT_ORDER_LITTLEENDIAN;
+
+        return TINYMAT_ORDER_UNKNOWN;
+}
+
+
+ /** \brief grows the memory array \a buf, so it can take at least \a size_increment more bytes at its current position */
+ TINYMAT_inlineattrib static void TinyMAT_growMem(size_t size_increment, TinyMATWriterBuffer* buf) {
+   if (buf->current + size_increment + 100 >= buf->size) {
+     size_t newsize = std::max<size_t>(buf->size, BUFSIZ);
+     while (buf->current + size_increment + 100 >= newsize) {
+       if (newsize < 100 * 1024 * 1024) newsize = newsize * 2;
+       else if (newsize < 1000 * 1024 * 1024) newsize = newsize * 3 / 2;
+       else newsize = newsize * 6 / 5;
+     }
+#ifdef TINYMAT_HAS_MMAP
+     if (buf->mapped_fd >= 0) {
+       // grow the file and its mapping, the OS keeps the contents, so nothing is copied
+       if (ftruncate(buf->mapped_fd, static_cast<off_t>(newsize)) != 0) {
+         throw std::runtime_error("could not grow memory-mapped MAT-file");
+       }
+#  ifdef MREMAP_MAYMOVE
+       void* newmap = mremap(buf->data, buf->size, newsize, MREMAP_MAYMOVE);
+#  else
+       munmap(buf->data, buf->size);
+       void* newmap = mmap(NULL, newsize, PROT_READ | PROT_WRITE, MAP_SHARED, buf->mapped_fd, 0);
+#  endif
+       if (newmap == MAP_FAILED) {
+         buf->data = NULL;
+         buf->size = 0;
+         throw std::runtime_error("could not remap memory-mapped MAT-file");
+       }
+       buf->data = static_cast<uint8_t*>(newmap);
+       buf->size = newsize;
+       return;
+     }
+#endif
+     uint8_t* newdata = (uint8_t*)realloc(buf->data, newsize);
+     if (!newdata) {
+       throw std::runtime_error("could not allocate memory for MAT-file");
+     }
+     buf->data = newdata;
+     buf->size = newsize;
+   }
+ }
+
+ /** \brief maps the file \a fd with \a size bytes into \a buf, returns \c false if this is not possible (then \a buf is unchanged) */
+ TINYMAT_inlineattrib static bool TinyMAT_mapMem(int fd, size_t size, TinyMATWriterBuffer* buf) {
+#ifdef TINYMAT_HAS_MMAP
+   if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+   void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (map == MAP_FAILED) return false;
+   buf->data = static_cast<uint8_t*>(map);
+   buf->size = size;
+   buf->current = 0;
+   buf->count = 0;
+   buf->mapped_fd = fd;
+   return true;
+#else
+   (void)fd; (void)size; (void)buf;
+   return false;
+#endif
+ }
+
+ /** \brief releases the memory held by \a buf */
+ TINYMAT_inlineattrib static void TinyMAT_freeMem(TinyMATWriterBuffer* buf) {
+#ifdef TINYMAT_HAS_MMAP
+   if (buf->mapped_fd >= 0) {
+     if (buf->data) munmap(buf->data, buf->size);
+     buf->data = NULL;
+     buf->mapped_fd = -1;
+   }
+#endif
+   if (buf->data) free(buf->data);
+   buf->data = NULL;
+   buf->size = 0;
+   buf->current = 0;
+   buf->count = 0;
+   buf->references.clear();
+ }
+
+ /** \brief returns \c true, if \a file has an open output (a file or a custom sink) */
+ TINYMAT_inlineattrib static bool TinyMAT_isOpen(const TinyMATWriterFile* file) {
+     return file && (file->file!=NULL || file->backend==TINYMAT_BACKEND_CUSTOM || (file->backend==TINYMAT_BACKEND_MEMORY && file->filedata.data!=NULL));
+ }
+
+ /** \brief returns \c true, if the output of \a file can be read back and overwritten at any position (i.e. it is not a custom sink) */
+ TINYMAT_inlineattrib static bool TinyMAT_isSeekable(const TinyMATWriterFile* file) {
+     return file->backend!=TINYMAT_BACKEND_CUSTOM;
+ }
+
+ /** \brief returns \c true, if data that has already been written to the output of \a file can be overwritten (back-patched) */
+ TINYMAT_inlineattrib static bool TinyMAT_canPatch(const TinyMATWriterFile* file) {
+     return TinyMAT_isSeekable(file) || file->sink.patch!=NULL;
+ }
+
+ /** \brief returns the memory buffer that currently receives the output, or NULL if the output goes directly into the file */
+ TINYMAT_inlineattrib static TinyMATWriterBuffer* TinyMAT_activeMem(TinyMATWriterFile* file) {
+   if (file->staging_active) return &(file->staging);
+   if (file->backend==TINYMAT_BACKEND_MEMORY || file->backend==TINYMAT_BACKEND_MMAP) return &(file->filedata);
+   return NULL;
+ }
+
+ /** \brief number of referenced bytes, that are inserted in front of position \a pos of \a buf */
+ TINYMAT_inlineattrib static uint64_t TinyMAT_referencedBefore(const TinyMATWriterBuffer* buf, size_t pos) {
+   if (buf->references.empty()) return 0;
+   std::vector<TinyMATWriterReference>::const_iterator it=std::upper_bound(buf->references.begin(), buf->references.end(), pos,
+       [](size_t p, const TinyMATWriterReference& r) { return p<r.buffer_pos; });
+   if (it==buf->references.begin()) return 0;
+   --it;
+   return it->preceding+it->size;
+ }
+
+ /** \brief converts the position \a offset in the output of \a buf into a position in \a buf, which has to lie outside of the referenced blocks */
+ TINYMAT_inlineattrib static uint64_t TinyMAT_unreferencedPosition(const TinyMATWriterBuffer* buf, uint64_t offset) {
+   if (buf->references.empty()) return offset;
+   // first reference, which ends behind offset
+   std::vector<TinyMATWriterReference>::const_iterator it=std::upper_bound(buf->references.begin(), buf->references.end(), offset,
+       [](uint64_t o, const TinyMATWriterReference& r) { return o<r.buffer_pos+r.preceding+r.size; });
+   if (it!=buf->references.end() && it->buffer_pos+it->preceding<=offset) {
+     throw std::runtime_error("cannot seek into an array, that is referenced in zero-copy mode");
+   }
+   if (it==buf->references.begin()) return offset;
+   --it;
+   return offset-(it->preceding+it->size);
+ }
+
+ /** \brief inserts the block \a bytes at position \a offset of the output of \a buf, without moving the data behind it (see TinyMATWriterReference ) */
+ TINYMAT_inlineattrib static void TinyMAT_insertMem(TinyMATWriterBuffer* buf, uint64_t offset, const std::shared_ptr<std::vector<uint8_t> >& bytes) {
+   // first reference, which starts at or behind offset
+   std::vector<TinyMATWriterReference>::iterator it=std::lower_bound(buf->references.begin(), buf->references.end(), offset,
+       [](const TinyMATWriterReference& r, uint64_t o) { return r.buffer_pos+r.preceding<o; });
+   uint64_t preceding=0;
+   if (it!=buf->references.begin()) {
+     const TinyMATWriterReference& prev=*(it-1);
+     preceding=prev.preceding+prev.size;
+     if (offset<preceding+prev.buffer_pos) {
+       throw std::runtime_error("cannot insert data into an array, that is referenced in zero-copy mode");
+     }
+   }
+   if (offset-preceding>buf->count) {
+     throw std::runtime_error("insert after end of file");
+   }
+   TinyMATWriterReference ins(bytes->data(), bytes->size(), static_cast<size_t>(offset-preceding), preceding);
+   ins.owned=bytes;
+   it=buf->references.insert(it, ins);
+   for (++it; it!=buf->references.end(); ++it) {
+     it->preceding+=bytes->size();
+   }
+ }
+
+ /** \brief splits the output of \a buf into the pieces of \a buf and the referenced blocks between them, in the order they have to be written */
+ TINYMAT_inlineattrib static std::vector<std::pair<const void*, size_t> > TinyMAT_memSegments(const TinyMATWriterBuffer& buf) {
+   std::vector<std::pair<const void*, size_t> > segments;
+   segments.reserve(buf.references.size()*2+1);
+   size_t last=0;
+   for (const TinyMATWriterReference& r: buf.references) {
+     if (r.buffer_pos>last) segments.push_back(std::make_pair(static_cast<const void*>(buf.data+last), r.buffer_pos-last));
+     if (r.size>0) segments.push_back(std::make_pair(r.data, r.size));
+     last=r.buffer_pos;
+   }
+   if (buf.count>last) segments.push_back(std::make_pair(static_cast<const void*>(buf.data+last), buf.count-last));
+   return segments;
+ }
+
+ /*! \brief writes the contents of TinyMATWriterFile::filedata, together with the referenced blocks, to the current position of the file
+     \ingroup tinymatwriter
+     \internal
+
+     \return \c true on success
+  */
+ static bool TinyMAT_writeMemToFile(TinyMATWriterFile* file) {
+   const TinyMATWriterBuffer& buf=file->filedata;
+   if (buf.references.empty()) {
+     return fwrite(buf.data, 1, buf.count, file->file)==buf.count;
+   }
+   const std::vector<std::pair<const void*, size_t> > segments=TinyMAT_memSegments(buf);
+#ifdef TINYMAT_HAS_MMAP
+   // gather all segments with as few system calls as possible
+   if (fflush(file->file)!=0) return false;
+   const int fd=fileno(file->file);
+   std::vector<struct iovec> iov(segments.size());
+   for (size_t i=0; i<segments.size(); i++) {
+     iov[i].iov_base=const_cast<void*>(segments[i].first);
+     iov[i].iov_len=segments[i].second;
+   }
+   size_t first=0;
+   while (first<iov.size()) {
+     const ssize_t written=writev(fd, &(iov[first]), static_cast<int>(std::min<size_t>(iov.size()-first, IOV_MAX)));
+     if (written<0) {
+       if (errno==EINTR) continue;
+       return false;
+     }
+     size_t rest=static_cast<size_t>(written);
+     while (first<iov.size() && rest>=iov[first].iov_len) {
+       rest-=iov[first].iov_len;
+       first++;
+     }
+     if (rest>0) {
+       iov[first].iov_base=static_cast<uint8_t*>(iov[first].iov_base)+rest;
+       iov[first].iov_len-=rest;
+     }
+   }
+   return true;
+#else
+   for (size_t i=0; i<segments.size(); i++) {
+     if (fwrite(segments[i].first, 1, segments[i].second, file->file)!=segments[i].second) return false;
+   }
+   return true;
+#endif
+ }
+
+ /** \brief copies all referenced blocks into \a buf, so it contains the complete output */
+ TINYMAT_inlineattrib static void TinyMAT_resolveReferences(TinyMATWriterBuffer& buf) {
+   if (buf.references.empty()) return;
+   const uint64_t total=buf.count+buf.references.back().preceding+buf.references.back().size;
+   TinyMATWriterBuffer res;
+   res.size=static_cast<size_t>(total)+BUFSIZ;
+   res.data=(uint8_t*)malloc(res.size);
+   if (!res.data) {
+     throw std::runtime_error("could not allocate memory for the arrays, that are referenced in zero-copy mode");
+   }
+   size_t last=0;
+   for (const TinyMATWriterReference& r: buf.references) {
+     memcpy(res.data+res.count, buf.data+last, r.buffer_pos-last);
+     res.count+=r.buffer_pos-last;
+     memcpy(res.data+res.count, r.data, r.size);
+     res.count+=r.size;
+     last=r.buffer_pos;
+   }
+   memcpy(res.data+res.count, buf.data+last, buf.count-last);
+   res.count+=buf.count-last;
+   res.current=buf.current+static_cast<size_t>(TinyMAT_referencedBefore(&buf, buf.current));
+   TinyMAT_freeMem(&buf);
+   buf=res;
+ }
+
+ /*! \brief writes all completed top-level variables of \c TINYMAT_BACKEND_MEMORY to the file and empties the memory buffer for reuse
+     \ingroup tinymatwriter
+     \internal
+
+     \param file the MAT-file
+     \param limit only flush, if the buffer holds more than this many bytes
+
+     Nothing is written while a top-level variable is open, as it may still be patched.
+  */
+ static void TinyMAT_flushMem(TinyMATWriterFile* file, uint64_t limit) {
+   if (file->backend!=TINYMAT_BACKEND_MEMORY || !file->file || !file->filedata.data || file->variable_depth>0 || file->staging_active) return;
+   const uint64_t bytes=file->filedata.count+TinyMAT_referencedBefore(&(file->filedata), file->filedata.count);
+   if (bytes==0 || bytes<=limit) return;
+   if (!TinyMAT_writeMemToFile(file)) {
+     throw std::runtime_error("could not write to the MAT-file");
+   }
+   file->flushed+=bytes;
+   file->filedata.references.clear();
+   file->filedata.current=0;
+   file->filedata.count=0;
+ }
+
+ TINYMAT_inlineattrib static int TinyMAT_fclose(TinyMATWriterFile* file) {
+     //std::cout<<"TinyMAT_fclose()\n";
+     //std::cout.flush();
+     if (!file) return 0;
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+     if (file->compression_pool) {
+       delete file->compression_pool;
+       file->compression_pool=NULL;
+     }
+#endif
+#ifdef TINYMAT_USES_ZLIB
+     if (file->streamed) {
+       deflateEnd(&(file->streamed->strm));
+       delete file->streamed;
+       file->streamed=NULL;
+     }
+#endif
+     TinyMAT_freeMem(&(file->staging));
+     int ret=0;
+     if (file->backend==TINYMAT_BACKEND_CUSTOM) {
+       if (file->sink.flush && !file->sink.flush(file->sink.context)) ret=-1;
+     } else if (file->file) {
+#ifdef TINYMAT_HAS_MMAP
+       if (file->filedata.mapped_fd >= 0) {
+         // the output is already in the file, only cut off the unused part of the mapping
+         const int fd = file->filedata.mapped_fd;
+         const size_t count = file->filedata.count;
+         TinyMAT_freeMem(&(file->filedata));
+         if (ftruncate(fd, static_cast<off_t>(count)) != 0) ret=-1;
+       }
+#endif
+       if (file->backend==TINYMAT_BACKEND_MEMORY && file->filedata.count>0 && file->filedata.data) {
+         fseek(file->file, static_cast<long>(file->flushed), SEEK_SET);
+         if (!TinyMAT_writeMemToFile(file)) ret=-1;
+       }
+       if (fclose(file->file)!=0) ret=-1;
+     }
+     TinyMAT_freeMem(&(file->filedata));
+     delete file;
+     return ret;
+ }
+
+ /*! \brief resolves \c TINYMAT_BACKEND_AUTO (and backends, that are not available in this build) into the backend that is actually used
+     \ingroup tinymatwriter
+     \internal
+  */
+ TINYMAT_inlineattrib static int TinyMAT_resolveBackend(const char* filename, const TinyMATWriterOptions* options) {
+     int backend=options->backend;
+     if (backend==TINYMAT_BACKEND_AUTO) {
+       if (options->sink.write) {
+         backend=TINYMAT_BACKEND_CUSTOM;
+       } else if (!filename) {
+         backend=TINYMAT_BACKEND_MEMORY;
+       } else if (options->size_hint==0) {
+         backend=TINYMAT_BACKEND_DEFAULT;
+       } else if (options->size_hint<TINYMAT_BACKEND_AUTO_MEMORY_LIMIT) {
+         backend=TINYMAT_BACKEND_MEMORY;
+       } else {
+#ifdef TINYMAT_HAS_MMAP
+         backend=TINYMAT_BACKEND_MMAP;
+#else
+         backend=TINYMAT_BACKEND_STDIO;
+#endif
+       }
+     }
+     return backend;
+ }
+
+ TINYMAT_inlineattrib static TinyMATWriterFile* TinyMAT_fopen(const char* filename, const TinyMATWriterOptions* options) {
+     //std::cout<<"TinyMAT_fopen()\n";
+     //std::cout.flush();
+     TinyMATWriterFile* mat=new TinyMATWriterFile;
+     mat->backend=TinyMAT_resolveBackend(filename, options);
+     mat->byteorder = (uint8_t)TinyMAT_get_byteorder();
+     const size_t bufSize=options->buffer_size;
+     if (mat->backend==TINYMAT_BACKEND_CUSTOM) {
+       if (!options->sink.write) {
+         delete mat;
+         return NULL;
+       }
+       mat->sink=options->sink;
+       return mat;
+     }
+     if (!filename && mat->backend!=TINYMAT_BACKEND_MEMORY) {
+       delete mat;
+       return NULL;
+     }
+     // without a filename, the file only exists in memory
+     if (filename) {
+#ifdef HAVE_FOPEN_S
+       if (fopen_s(&(mat->file), filename, "wb+") != 0) {
+         mat->file=NULL;
+       }
+#else
+       mat->file=fopen(filename, "wb+");
+#endif
+       if (!mat->file) {
+         delete mat;
+         return NULL;
+       }
+       if (bufSize > 0) {
+         setvbuf(mat->file, NULL, _IOFBF, bufSize);
+       }
+       else {
+         setvbuf(mat->file, NULL, _IOFBF, BUFSIZ);
+       }
+     }
+     if (mat->backend==TINYMAT_BACKEND_MMAP) {
+       if (TinyMAT_mapMem(fileno(mat->file), std::max<size_t>(std::max<uint64_t>(bufSize, options->size_hint), BUFSIZ), &(mat->filedata))) {
+         return mat;
+       }
+       // fall back to a heap buffer, if the file cannot be mapped
+       mat->backend=TINYMAT_BACKEND_MEMORY;
+     }
+     if (mat->backend==TINYMAT_BACKEND_MEMORY) {
+       uint64_t initial = std::max<uint64_t>(bufSize, options->size_hint);
+       if (mat->file && options->memory_limit>0) {
+         mat->memory_limit = options->memory_limit;
+         initial = std::min<uint64_t>(initial, options->memory_limit);
+       }
+       mat->filedata.size = std::max<size_t>(static_cast<size_t>(initial), BUFSIZ);
+       mat->filedata.current = 0;
+       mat->filedata.count = 0;
+       mat->filedata.data = (uint8_t*)malloc(mat->filedata.size);
+       if (!mat->filedata.data) {
+         if (mat->file) fclose(mat->file);
+         delete mat;
+         return NULL;
+       }
+     } else {
+       mat->backend=TINYMAT_BACKEND_STDIO;
+     }
+     return mat;
+ }
+
+  TINYMAT_inlineattrib static long TinyMAT_ftell(TinyMATWriterFile* file) {
+     //std::cout<<"TinyMAT_ftell()\n";
+     //std::cout.flush();
+     if (!TinyMAT_isOpen(file)) return 0;
+#ifdef TINYMAT_USES_ZLIB
+     if (file->streamed && file->streamed->level>TINYMAT_COMPRESSION_NONE) {
+       // logical position in the uncompressed variable
+       return file->streamed->startpos+static_cast<long>(file->streamed->raw_size);
+     }
+#endif
+     TinyMATWriterBuffer* mem=TinyMAT_activeMem(file);
+     if (mem==&(file->filedata)) {
+       return static_cast<long>(file->flushed+mem->current+TinyMAT_referencedBefore(mem, mem->current));
+     } else if (mem) {
+       return static_cast<long>(mem->current+TinyMAT_referencedBefore(mem, mem->current));
+     } else if (file->backend==TINYMAT_BACKEND_CUSTOM) {
+       return static_cast<long>(file->sink_pos);
+     } else {
+       return ftell(file->file);
+     }
+ }
+ TINYMAT_inlineattrib static int TinyMAT_fseek(TinyMATWriterFile* file, long offset) {
+     //std::cout<<"TinyMAT_fseek()\n";
+     //std::cout.flush();
+     if (!TinyMAT_isOpen(file)) return 0;
+#ifdef TINYMAT_USES_ZLIB
+     if (file->streamed && file->streamed->level>TINYMAT_COMPRESSION_NONE) {
+       throw std::runtime_error("cannot seek inside a variable that is compressed while it is written");
+     }
+#endif
+     TinyMATWriterBuffer* mem=TinyMAT_activeMem(file);
+     if (mem) {
+       long start = 0;
+       int res = 0;
+       if (mem==&(file->filedata) && offset>=0) {
+         if (static_cast<uint64_t>(offset)<file->flushed) {
+           throw std::runtime_error("cannot seek into the part of the file, that has already been flushed");
+         }
+         offset = static_cast<long>(TinyMAT_unreferencedPosition(mem, static_cast<uint64_t>(offset)-file->flushed));
+       } else if (offset>=0) {
+         offset = static_cast<long>(TinyMAT_unreferencedPosition(mem, static_cast<uint64_t>(offset)));
+       }
+       if (start + offset < 0) {
+         throw std::runtime_error("seek before start of file");
+         res=-1;
+       } else if (static_cast<size_t>(start + offset) > mem->count) {
+         throw std::runtime_error("seek after end of file");
+         res=-1;
+       } else {
+         mem->current = start + offset;
+         res=0;
+       }
+       return res;
+     } else if (file->backend==TINYMAT_BACKEND_CUSTOM) {
+       if (offset < 0 || static_cast<uint64_t>(offset) > file->sink_end) {
+         throw std::runtime_error("seek outside of the data written to the sink");
+       }
+       file->sink_pos = static_cast<uint64_t>(offset);
+       return 0;
+     } else {
+       return fseek(file->file, offset, SEEK_SET);
+     }
+ }
+
+
+/** \brief writes to the memory cache or file, bypassing a TinyMATWriterFile::streamed variable */
+TINYMAT_inlineattrib static int TinyMAT_fwriteDirect(const void* data, uint32_t size, uint32_t count, TinyMATWriterFile* file)
+{
+     //std::cout<<"TinyMAT_fwrite()\n";
+     if (!TinyMAT_isOpen(file) || !data || size*count<=0) return 0;
+     int res = 0;
+     TinyMATWriterBuffer* mem=TinyMAT_activeMem(file);
+     if (mem==&(file->filedata) && data==file->zerocopy_candidate
+         && file->backend==TINYMAT_BACKEND_MEMORY && file->variable_depth==1 && mem->current==mem->count) {
+       // zero-copy mode: only remember the array of the caller
+       mem->references.push_back(TinyMATWriterReference(data, size*count, mem->current, TinyMAT_referencedBefore(mem, mem->current)));
+       res=size*count;
+     } else if (mem) {
+       if (mem->current<mem->count && !mem->references.empty()
+           && TinyMAT_referencedBefore(mem, mem->current+size*count-1)!=TinyMAT_referencedBefore(mem, mem->current)) {
+         throw std::runtime_error("cannot overwrite an array, that is referenced in zero-copy mode");
+       }
+       if (mem->current + size*count + 100 >= mem->size) {
+         TinyMAT_growMem(size*count, mem);
+       }
+#ifdef HAVE_MEMCPY_S
+       memcpy_s(&(mem->data[mem->current]), mem->size- mem->current, data, size*count);
+#else
+       memcpy(&(mem->data[mem->current]), data, size*count);
+#endif
+       mem->current = mem->current + size*count;
+       mem->count = std::max(mem->count, mem->current);
+       res=size*count;
+     } else if (file->backend==TINYMAT_BACKEND_CUSTOM) {
+       const size_t bytes=size*count;
+       if (file->sink_pos==file->sink_end) {
+         if (file->sink.write(data, bytes, file->sink.context)!=bytes) {
+           throw std::runtime_error("could not write to the sink of the MAT-file");
+         }
+         file->sink_end+=bytes;
+       } else {
+         if (!file->sink.patch || file->sink_pos+bytes>file->sink_end) {
+           throw std::runtime_error("the sink of the MAT-file cannot be overwritten");
+         }
+         if (!file->sink.patch(file->sink_pos, data, bytes, file->sink.context)) {
+           throw std::runtime_error("could not patch the sink of the MAT-file");
+         }
+       }
+       file->sink_pos+=bytes;
+       res=static_cast<int>(bytes);
+     } else {
+       res = (int)fwrite(data, 1, size*count, file->file);
+     }
+     return res;
+}
+
+#ifdef TINYMAT_USES_ZLIB
+/*! \brief feeds \a bytes bytes from \a data into the deflate stream of TinyMATWriterFile::streamed and writes the compressed output chunk-wise
+    \ingroup tinymatwriter
+    \internal
+ */
+static int TinyMAT_deflateWrite(TinyMATWriterFile* file, const void* data, uint32_t bytes) {
+    TinyMATWriterDeflateStream* zs=file->streamed;
+    zs->strm.next_in=static_cast<Bytef*>(const_cast<void*>(data));
+    zs->strm.avail_in=bytes;
+    while (zs->strm.avail_in>0) {
+        zs->strm.next_out=zs->out.data();
+        zs->strm.avail_out=static_cast<uInt>(zs->out.size());
+        if (deflate(&(zs->strm), Z_NO_FLUSH)==Z_STREAM_ERROR) {
+            throw std::runtime_error("error while compressing a variable with zlib");
+        }
+        TinyMAT_fwriteDirect(zs->out.data(), 1, static_cast<uint32_t>(zs->out.size()-zs->strm.avail_out), file);
+    }
+    zs->raw_size+=bytes;
+    return static_cast<int>(bytes);
+}
+#endif
+
+TINYMAT_inlineattrib static int TinyMAT_fwrite(const void* data, uint32_t size, uint32_t count, TinyMATWriterFile* file)
+{
+#ifdef TINYMAT_USES_ZLIB
+     if (file && file->streamed && file->streamed->level>TINYMAT_COMPRESSION_NONE) {
+       if (!data || size*count<=0) return 0;
+       return TinyMAT_deflateWrite(file, data, size*count);
+     }
+#endif
+     return TinyMAT_fwriteDirect(data, size, count, file);
+}
+
+template<typename T>
+TINYMAT_inlineattrib static int TinyMAT_fwritesmall(T data, TinyMATWriterFile* file)
+{
+     if (!TinyMAT_isOpen(file)) return 0;
+#ifdef TINYMAT_USES_ZLIB
+     if (file->streamed && file->streamed->level>TINYMAT_COMPRESSION_NONE) {
+       return TinyMAT_deflateWrite(file, &data, sizeof(T));
+     }
+#endif
+     int res = 0;
+     TinyMATWriterBuffer* mem=TinyMAT_activeMem(file);
+     if (mem) {
+       if (mem->current + sizeof(T) + 100 >= mem->size) {
+         TinyMAT_growMem(sizeof(T), mem);
+       }
+       T* datap = reinterpret_cast<T*>(&(mem->data[mem->current]));
+       *datap = data;
+       mem->current = mem->current + sizeof(T);
+       mem->count = std::max(mem->count, mem->current);
+       res=sizeof(T);
+     } else {
+       res = TinyMAT_fwriteDirect(&data, sizeof(T), 1, file);
+     }
+     return res;
+}
+
+/** \brief reserves \a bytes bytes at the current position of the memory cache, which the caller fills directly
+    \return a pointer to the reserved bytes, or NULL if the output does not go into a memory buffer (or is compressed while it is written), then the data has to be written with TinyMAT_fwrite()
+ */
+TINYMAT_inlineattrib static uint8_t* TinyMAT_reserveMem(TinyMATWriterFile* file, size_t bytes)
+{
+#ifdef TINYMAT_USES_ZLIB
+     if (file->streamed && file->streamed->level>TINYMAT_COMPRESSION_NONE) return NULL;
+#endif
+     TinyMATWriterBuffer* mem=TinyMAT_activeMem(file);
+     if (!mem || mem->current!=mem->count) return NULL;
+     TinyMAT_growMem(bytes, mem);
+     uint8_t* res=&(mem->data[mem->current]);
+     mem->current = mem->current + bytes;
+     mem->count = mem->current;
+     return res;
+}
+
+
+
+TINYMAT_inlineattrib static void TinyMAT_writeU8(TinyMATWriterFile* filen, uint8_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write8(TinyMATWriterFile* filen, int8_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_writeU16(TinyMATWriterFile* filen, uint16_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write16(TinyMATWriterFile* filen, int16_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_writeU32(TinyMATWriterFile* filen, uint32_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write32(TinyMATWriterFile* filen, int32_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_writeU64(TinyMATWriterFile* filen, uint64_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write64(TinyMATWriterFile* filen, int64_t data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write64d(TinyMATWriterFile* filen, double data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+TINYMAT_inlineattrib static void TinyMAT_write32f(TinyMATWriterFile* filen, float data) {
+    TinyMAT_fwritesmall(data, filen);
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u64(TinyMATWriterFile* mat, uint64_t data) {
+    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miUINT64));
+    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write64(mat, data);
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i64(TinyMATWriterFile* mat, int64_t data) {
+    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miINT64));
+    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write64(mat, data);
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u32(TinyMATWriterFile* mat, uint32_t data) {
+    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miUINT32));
+    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write32(mat, data);
+    TinyMAT_write32(mat, static_cast<uint32_t>(0)); // write padding
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i32(TinyMATWriterFile* mat, int32_t data) {
+    TinyMAT_write32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_write32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write32(mat, data);
+    TinyMAT_write32(mat, static_cast<uint32_t>(0)); // write padding
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementS_i32(TinyMATWriterFile* mat, int32_t data) {
+    TinyMAT_writeU16(mat, static_cast<uint16_t>(TINYMAT_miINT32));
+    TinyMAT_writeU16(mat, static_cast<uint16_t>(sizeof(data)));
+    TinyMAT_write32(mat, data);
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u16(TinyMATWriterFile* mat, uint16_t data) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT16));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_writeU16(mat, data);
+    TinyMAT_writeU16(mat, static_cast<uint16_t>(0)); // write padding
+    TinyMAT_write32(mat, static_cast<uint32_t>(0));
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i16(TinyMATWriterFile* mat, int16_t data) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT16));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write16(mat, data);
+    TinyMAT_writeU16(mat, static_cast<uint16_t>(0)); // write padding
+    TinyMAT_write32(mat, static_cast<uint32_t>(0));
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_dbl(TinyMATWriterFile* mat, double data) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miDOUBLE));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(sizeof(data)));
+    TinyMAT_write64d(mat, data);
+    // no padding required
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_dbla(TinyMATWriterFile* mat, const double* data, uint32_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miDOUBLE));
+    if (!data) items=0;
+    TinyMAT_writeU32(mat, items*sizeof(*data));
+    if (items>0 && data){
+        TinyMAT_fwrite(data, sizeof(*data), items, mat);
+    }
+    // no padding required
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_flta(TinyMATWriterFile* mat, const float* data, uint32_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miSINGLE));
+    if (!data) items=0;
+    TinyMAT_writeU32(mat, items*sizeof(*data));
+    if (items>0 && data){
+        TinyMAT_fwrite(data, sizeof(*data), items, mat);
+        // write padding
+        if (items%2==1) TinyMAT_write32(mat, static_cast<uint32_t>(0));
+    }
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u32a(TinyMATWriterFile* mat, const uint32_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT32));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // write padding
+        if (items%2==1) TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+    }
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i32a(TinyMATWriterFile* mat, const int32_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // write padding
+        if (items%2==1) TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+    }
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u16a(TinyMATWriterFile* mat, const uint16_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT16));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // write padding
+        if (items%4==1) {
+            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
+        } else if (items%4==2) {
+            TinyMAT_write32(mat, static_cast<uint32_t>(0));
+        } else if (items%4==3) {
+            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
+        }
+
+    }
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i16a(TinyMATWriterFile* mat, const int16_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT16));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // write padding
+        if (items%4==1) {
+            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
+        } else if (items%4==2) {
+            TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+        } else if (items%4==3) {
+            TinyMAT_writeU16(mat, static_cast<uint16_t>(0));
+        }
+    }
+}
+
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u64a(TinyMATWriterFile* mat, const uint64_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miUINT64));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // no padding required
+    }
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i64a(TinyMATWriterFile* mat, const int64_t* data, size_t items) {
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT64));
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(*data)));
+    if (items>0) {
+        TinyMAT_fwrite(data, sizeof(*data), (uint32_t)items, mat);
+        // no padding required
+    }
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_i8a(TinyMATWriterFile* mat, const int8_t* data, uint32_t slen) {
+    size_t pad=(slen)%8;
+    uint32_t cla=TINYMAT_miINT8;
+    TinyMAT_writeU32(mat, cla);
+    TinyMAT_writeU32(mat, slen);
+    if (slen>0 && data) {
+        TinyMAT_fwrite(data, 1, slen, mat);
+        if (pad>0) {
+          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
+          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
+        }
+    }
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_u8a(TinyMATWriterFile* mat, const uint8_t* data, uint32_t slen) {
+    size_t pad=(slen)%8;
+    uint32_t cla=TINYMAT_miUINT8;
+    TinyMAT_writeU32(mat, cla);
+    TinyMAT_writeU32(mat, slen);
+    if (slen>0 && data) {
+        TinyMAT_fwrite(data, 1, slen, mat);
+        if (pad>0) {
+          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
+          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
+        }
+    }
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_stringas8bit(TinyMATWriterFile* mat, const char* data, uint32_t slen) {
+    TinyMAT_writeDatElement_i8a(mat, (const int8_t*)(data), slen);
+}
+
+/*! \brief decodes the UTF-8 sequence at \a s[pos] (of \a len bytes) into the code point \a cp and returns its length in bytes
+    \ingroup tinymatwriter
+    \internal
+
+    Invalid, overlong or truncated sequences and encoded surrogates are not decoded: then the first byte is returned as a Latin-1 character.
+ */
+TINYMAT_inlineattrib static uint32_t TinyMAT_decodeUTF8(const uint8_t* s, size_t len, size_t pos, uint32_t& cp) {
+    const uint32_t b0=s[pos];
+    cp=b0;
+    uint32_t n=0;
+    uint32_t minimum=0;
+    if (b0>=0xC2 && b0<=0xDF) { n=2; cp=b0&0x1F; minimum=0x80; }
+    else if (b0>=0xE0 && b0<=0xEF) { n=3; cp=b0&0x0F; minimum=0x800; }
+    else if (b0>=0xF0 && b0<=0xF4) { n=4; cp=b0&0x07; minimum=0x10000; }
+    else { return 1; }
+    if (pos+n>len) { cp=b0; return 1; }
+    for (uint32_t i=1; i<n; i++) {
+        const uint32_t b=s[pos+i];
+        if ((b&0xC0)!=0x80) { cp=b0; return 1; }
+        cp=(cp<<6)|(b&0x3F);
+    }
+    if (cp<minimum || cp>0x10FFFF || (cp>=0xD800 && cp<=0xDFFF)) { cp=b0; return 1; }
+    return n;
+}
+
+/*! \brief returns the number of UTF-16 code units (i.e. MATLAB characters) of the \a slen bytes in \a data (see TinyMATWriter_setStringEncoding() )
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static size_t TinyMAT_utf16Length(const TinyMATWriterFile* mat, const char* data, size_t slen) {
+    if (!data || mat->string_encoding!=TINYMAT_STRING_ENCODING_UTF8) return data?slen:0;
+    const uint8_t* s=reinterpret_cast<const uint8_t*>(data);
+    size_t units=0;
+    size_t pos=0;
+    while (pos<slen) {
+#ifdef TINYMAT_HAS_SSE2
+        // skip blocks of ASCII characters
+        if (pos+16<=slen && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+pos)))==0) {
+            pos+=16;
+            units+=16;
+            continue;
+        }
+#endif
+        if (s[pos]<0x80) {
+            pos++;
+            units++;
+        } else {
+            uint32_t cp=0;
+            pos+=TinyMAT_decodeUTF8(s, slen, pos, cp);
+            units+=(cp>=0x10000)?2:1;
+        }
+    }
+    return units;
+}
+
+/*! \brief encodes the bytes \a s[pos...len-1] as UTF-16 into \a dst, until \a capacity code units are filled or the end is reached
+    \ingroup tinymatwriter
+    \internal
+
+    \return the number of code units written, \a pos is advanced to the first byte that was not encoded
+ */
+TINYMAT_inlineattrib static size_t TinyMAT_encodeUTF16(uint16_t* dst, size_t capacity, const uint8_t* s, size_t len, size_t& pos, bool utf8) {
+    size_t n=0;
+#ifdef TINYMAT_HAS_SSE2
+    const __m128i zero=_mm_setzero_si128();
+#endif
+    while (pos<len && n<capacity) {
+#ifdef TINYMAT_HAS_SSE2
+        // widen blocks of 16 ASCII (or Latin-1) characters
+        if (pos+16<=len && n+16<=capacity) {
+            const __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+pos));
+            if (!utf8 || _mm_movemask_epi8(v)==0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+n), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+n+8), _mm_unpackhi_epi8(v, zero));
+                pos+=16;
+                n+=16;
+                continue;
+            }
+        }
+#endif
+        if (!utf8 || s[pos]<0x80) {
+            dst[n++]=s[pos++];
+        } else {
+            uint32_t cp=0;
+            const uint32_t bytes=TinyMAT_decodeUTF8(s, len, pos, cp);
+            if (cp>=0x10000) {
+                // a surrogate pair is not split between two blocks
+                if (n+2>capacity) break;
+                dst[n++]=static_cast<uint16_t>(0xD800+((cp-0x10000)>>10));
+                dst[n++]=static_cast<uint16_t>(0xDC00+((cp-0x10000)&0x3FF));
+            } else {
+                dst[n++]=static_cast<uint16_t>(cp);
+            }
+            pos+=bytes;
+        }
+    }
+    return n;
+}
+
+/*! \brief writes the \a slen bytes in \a data as character data element with \a units UTF-16 code units (see TinyMAT_utf16Length() )
+    \ingroup tinymatwriter
+    \internal
+
+    The characters are encoded directly into the memory cache, or block-wise on the stack, if the output goes into a file.
+ */
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_string(TinyMATWriterFile* mat, const char* data, uint32_t slen, size_t units) {
+    const uint32_t cla=TINYMAT_miUINT16;
+    TinyMAT_writeU32(mat, cla);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(units*2));
+    if (units>0 && data) {
+        const uint8_t* s=reinterpret_cast<const uint8_t*>(data);
+        const bool utf8=(mat->string_encoding==TINYMAT_STRING_ENCODING_UTF8);
+        size_t pos=0;
+        uint16_t* reserved=reinterpret_cast<uint16_t*>(TinyMAT_reserveMem(mat, units*2));
+        if (reserved) {
+            TinyMAT_encodeUTF16(reserved, units, s, slen, pos, utf8);
+        } else {
+            uint16_t block[4096];
+            while (pos<slen) {
+                const size_t n=TinyMAT_encodeUTF16(block, sizeof(block)/sizeof(uint16_t), s, slen, pos, utf8);
+                TinyMAT_fwrite(block, 2, static_cast<uint32_t>(n), mat);
+            }
+        }
+        // write padding
+        const size_t pad=(2*units)%8;
+        if (pad>0) {
+          static const uint8_t paddata[8] = { 0,0,0,0,0,0,0,0 };
+          TinyMAT_fwrite(paddata, static_cast<uint32_t>(8 - pad), 1, mat);
+        }
+    }
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_stringas8bit(TinyMATWriterFile* mat, const char* data) {
+    TinyMAT_writeDatElement_stringas8bit(mat, data, (uint32_t)strlen(data));
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_string(TinyMATWriterFile* mat, const char* data) {
+    const uint32_t slen=(uint32_t)strlen(data);
+    TinyMAT_writeDatElement_string(mat, data, slen, TinyMAT_utf16Length(mat, data, slen));
+}
+
+TINYMAT_inlineattrib static size_t TinyMAT_DatElement_realstringlen8bit(const char* data) {
+    if (!data) return 0;
+    size_t slen=strlen(data);
+    if (slen==0) return 0;
+    size_t pad=slen%8;
+    if (pad>0) {
+        slen=slen+(8-pad);
+    }
+    return slen;
+}
+
+
+#ifdef TINYMAT_USES_ZLIB
+/** \brief size of the chunks, in which compressed data is passed to the file, if it is not cached in memory */
+#define TINYMAT_ZLIB_CHUNKSIZE (256*1024)
+
+/*! \brief compresses \a size bytes from \a data (a complete miMATRIX element) and writes the result as a miCOMPRESSED element
+    \ingroup tinymatwriter
+    \internal
+
+    The result is a zlib-stream (i.e. deflate with zlib header), as written by MATLAB, which is not padded to a multiple of 8 bytes.
+ */
+TINYMAT_inlineattrib static void TinyMAT_writeCompressedElement(TinyMATWriterFile* mat, const uint8_t* data, size_t size, int level) {
+    if (!TinyMAT_canPatch(mat)) {
+        // the size cannot be patched later, so compress into a temporary buffer first
+        std::vector<uint8_t> out;
+        TinyMAT_deflateBlock(data, size, level, out);
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miCOMPRESSED);
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(out.size()));
+        TinyMAT_fwrite(out.data(), 1, static_cast<uint32_t>(out.size()), mat);
+        return;
+    }
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit(&strm, level)!=Z_OK) {
+        throw std::runtime_error("could not initialize zlib for writing a compressed variable");
+    }
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miCOMPRESSED);
+    long sizepos=TinyMAT_ftell(mat);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+
+    strm.next_in=const_cast<Bytef*>(data);
+    strm.avail_in=static_cast<uInt>(size);
+    int zres=Z_OK;
+    TinyMATWriterBuffer* mem=TinyMAT_activeMem(mat);
+    if (mem) {
+        // deflate directly into the file-cache
+        const size_t bound=deflateBound(&strm, static_cast<uLong>(size));
+        TinyMAT_growMem(bound, mem);
+        strm.next_out=&(mem->data[mem->current]);
+        strm.avail_out=static_cast<uInt>(bound);
+        zres=deflate(&strm, Z_FINISH);
+        mem->current=mem->current+(bound-strm.avail_out);
+        mem->count=std::max(mem->count, mem->current);
+    } else {
+        std::vector<uint8_t> out(TINYMAT_ZLIB_CHUNKSIZE);
+        do {
+            strm.next_out=out.data();
+            strm.avail_out=static_cast<uInt>(out.size());
+            zres=deflate(&strm, Z_FINISH);
+            TinyMAT_fwrite(out.data(), 1, static_cast<uint32_t>(out.size()-strm.avail_out), mat);
+        } while (zres==Z_OK);
+    }
+    deflateEnd(&strm);
+    if (zres!=Z_STREAM_END) {
+        throw std::runtime_error("error while compressing a variable with zlib");
+    }
+
+    long endpos=TinyMAT_ftell(mat);
+    TinyMAT_fseek(mat, sizepos);
+    uint32_t size_bytes=endpos-sizepos-4;
+    TinyMAT_writeU32(mat, size_bytes);
+    TinyMAT_fseek(mat, endpos);
+}
+#endif
+
+#ifdef TINYMAT_USES_ZLIB
+/*! \brief passes a decision of the compression policy to the report function of \a mat (see TinyMATWriter_setCompressionReport() )
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_reportCompression(TinyMATWriterFile* mat, const std::string& name, uint64_t raw_size, uint64_t stored_size, int level, int reason, double sample_ratio) {
+    if (!mat->compression_report) return;
+    TinyMATWriterCompressionDecision decision;
+    decision.name=name.c_str();
+    decision.raw_size=raw_size;
+    decision.stored_size=stored_size;
+    decision.level=level;
+    decision.reason=reason;
+    decision.sample_ratio=sample_ratio;
+    mat->compression_report(&decision, mat->compression_report_userdata);
+}
+#endif
+
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+/*! \brief writes the miCOMPRESSED elements of all finished jobs at the head of TinyMATWriterCompressionPool::pending to the file
+    \ingroup tinymatwriter
+    \internal
+
+    Jobs are committed strictly in the order in which they were submitted, so the order of the variables in the file
+    is the order of the API calls. If \a wait_all is \c true, this blocks until all pending jobs are committed, otherwise
+    it blocks only while more than TinyMATWriterCompressionPool::max_pending jobs are pending.
+ */
+static void TinyMAT_commitCompressionJobs(TinyMATWriterFile* mat, bool wait_all) {
+    TinyMATWriterCompressionPool* pool=mat->compression_pool;
+    if (!pool) return;
+    while (!pool->pending.empty()) {
+        std::shared_ptr<TinyMATWriterCompressionJob> job=pool->pending.front();
+        const bool block=wait_all || (pool->pending.size()>pool->max_pending);
+        if (!pool->isDone(job, block)) break;
+        pool->pending.pop_front();
+        if (!job->error.empty()) {
+            throw std::runtime_error(job->error);
+        }
+        const long startpos=TinyMAT_ftell(mat);
+        if (job->level>TINYMAT_COMPRESSION_NONE) {
+            TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miCOMPRESSED);
+            TinyMAT_writeU32(mat, static_cast<uint32_t>(job->compressed.size()));
+            TinyMAT_fwrite(job->compressed.data(), 1, static_cast<uint32_t>(job->compressed.size()), mat);
+        } else {
+            TinyMAT_fwrite(job->raw.data, 1, static_cast<uint32_t>(job->raw.count), mat);
+        }
+        TinyMAT_reportCompression(mat, job->name, job->raw.count, TinyMAT_ftell(mat)-startpos, job->level, job->reason, job->sample_ratio);
+        // keep the staging buffer for one of the next variables
+        if (pool->spare.size()<pool->max_pending) {
+            pool->spare.push_back(job->raw);
+            job->raw=TinyMATWriterBuffer();
+        }
+    }
+}
+#endif
+
+/*! \brief writes all variables, that are still compressed in the background, to the file
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_flushCompression(TinyMATWriterFile* mat) {
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+    TinyMAT_commitCompressionJobs(mat, true);
+#else
+    (void)mat;
+#endif
+}
+
+#ifdef TINYMAT_USES_ZLIB
+/*! \brief starts a top-level variable, that is compressed while it is written (instead of being staged as a whole)
+    \ingroup tinymatwriter
+    \internal
+
+    \param mat the MAT-file
+    \param name name of the variable
+    \param payload the data of the variable, used by the compression policy to choose the level
+    \param payload_bytes size of \a payload in bytes
+
+    All output of the variable passes through TinyMAT_deflateWrite(), so only one output chunk of \c TINYMAT_ZLIB_CHUNKSIZE
+    bytes is needed in addition to the output itself. The size of the miCOMPRESSED element is back-patched in TinyMAT_finishStreaming().
+ */
+static void TinyMAT_startStreaming(TinyMATWriterFile* mat, const char* name, const void* payload, uint64_t payload_bytes) {
+    TinyMAT_flushCompression(mat);
+    std::unique_ptr<TinyMATWriterDeflateStream> zs(new TinyMATWriterDeflateStream());
+    zs->name=name;
+    zs->level=TinyMAT_decideCompression(mat->compression_policy.get(), zs->name, static_cast<const uint8_t*>(payload), static_cast<size_t>(payload_bytes), mat->current_compression_level, &(zs->reason), &(zs->sample_ratio));
+    zs->startpos=TinyMAT_ftell(mat);
+    if (zs->level>TINYMAT_COMPRESSION_NONE) {
+        if (deflateInit(&(zs->strm), zs->level)!=Z_OK) {
+            throw std::runtime_error("could not initialize zlib for writing a compressed variable");
+        }
+        zs->out.resize(TINYMAT_ZLIB_CHUNKSIZE);
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miCOMPRESSED);
+        zs->sizepos=TinyMAT_ftell(mat);
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+        zs->startpos=TinyMAT_ftell(mat);
+    }
+    zs->raw_size=0;
+    mat->streamed=zs.release();
+}
+
+/*! \brief finishes the variable started with TinyMAT_startStreaming()
+    \ingroup tinymatwriter
+    \internal
+ */
+static void TinyMAT_finishStreaming(TinyMATWriterFile* mat) {
+    std::unique_ptr<TinyMATWriterDeflateStream> zs(mat->streamed);
+    mat->streamed=NULL;
+    uint64_t raw_size=zs->raw_size;
+    long startpos=zs->startpos;
+    if (zs->level>TINYMAT_COMPRESSION_NONE) {
+        int zres=Z_OK;
+        zs->strm.next_in=NULL;
+        zs->strm.avail_in=0;
+        do {
+            zs->strm.next_out=zs->out.data();
+            zs->strm.avail_out=static_cast<uInt>(zs->out.size());
+            zres=deflate(&(zs->strm), Z_FINISH);
+            TinyMAT_fwriteDirect(zs->out.data(), 1, static_cast<uint32_t>(zs->out.size()-zs->strm.avail_out), mat);
+        } while (zres==Z_OK);
+        deflateEnd(&(zs->strm));
+        if (zres!=Z_STREAM_END) {
+            throw std::runtime_error("error while compressing a variable with zlib");
+        }
+        long endpos=TinyMAT_ftell(mat);
+        TinyMAT_fseek(mat, zs->sizepos);
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(endpos-zs->sizepos-4));
+        TinyMAT_fseek(mat, endpos);
+        startpos=zs->sizepos-4;
+    } else {
+        raw_size=TinyMAT_ftell(mat)-startpos;
+    }
+    TinyMAT_reportCompression(mat, zs->name, raw_size, TinyMAT_ftell(mat)-startpos, zs->level, zs->reason, zs->sample_ratio);
+}
+#endif
+
+/*! \brief has to be called before anything of a variable is written
+    \ingroup tinymatwriter
+    \internal
+
+    Calls may be nested (e.g. for the fields of a struct), only the outermost call starts a new top-level variable.
+    If compression is active for this variable, all output is redirected into TinyMATWriterFile::staging, until
+    the matching TinyMAT_endVariable() is reached.
+
+    Set \a inserts for variables, that insert data in front of output, which has already been written (the field names
+    of a struct, see TinyMAT_insertMem() ), or that may contain such variables (cell arrays). Only memory buffers support this,
+    so on other backends these variables are staged too.
+ */
+TINYMAT_inlineattrib static void TinyMAT_beginVariable(TinyMATWriterFile* mat, bool inserts=false) {
+    if (mat->variable_depth==0) {
+        int level=mat->compression_level;
+        if (mat->next_compression_level>=0) {
+            level=mat->next_compression_level;
+            mat->next_compression_level=-1;
+        }
+        mat->current_compression_level=level;
+        if (mat->memory_limit>0) {
+            TinyMAT_flushMem(mat, mat->memory_limit);
+        }
+        // sinks, which cannot be read back, receive each variable in one piece, after all sizes have been patched in staging
+        bool stage=!TinyMAT_isSeekable(mat) || (inserts && mat->backend!=TINYMAT_BACKEND_MEMORY);
+#ifdef TINYMAT_USES_ZLIB
+        // name rules may compress a variable, even if the configured level is TINYMAT_COMPRESSION_NONE
+        const bool has_rules=(mat->compression_policy && !mat->compression_policy->rules.empty());
+        stage=stage || level>TINYMAT_COMPRESSION_NONE || has_rules;
+#endif
+        if (stage) {
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+            TinyMATWriterCompressionPool* pool=mat->compression_pool;
+            if (pool && !mat->staging.data && !pool->spare.empty()) {
+                mat->staging=pool->spare.back();
+                pool->spare.pop_back();
+            }
+#endif
+            mat->staging.current=0;
+            mat->staging.count=0;
+            mat->staging.references.clear();
+            mat->staging_active=true;
+        } else {
+            // uncompressed variables are written directly, so all variables before have to be in the file already
+            TinyMAT_flushCompression(mat);
+        }
+    }
+    mat->variable_depth++;
+}
+
+/*! \brief has to be called before anything of a variable is written, if the size of its miMATRIX element is known in advance
+    \ingroup tinymatwriter
+    \internal
+
+    Works like TinyMAT_beginVariable(mat), but large compressed top-level variables (see TinyMATWriter_setCompressionStreaming() )
+    are compressed while they are written (see TinyMAT_startStreaming() ), instead of staging them completely in memory.
+    The writer must not seek back into the variable, so the size of the miMATRIX element has to be written directly.
+ */
+TINYMAT_inlineattrib static void TinyMAT_beginVariable(TinyMATWriterFile* mat, const char* name, uint64_t element_size, const void* payload, uint64_t payload_bytes) {
+    TinyMAT_beginVariable(mat);
+    if (mat->variable_depth!=1 || !mat->staging_active) return;
+    bool compress=false;
+#ifdef TINYMAT_USES_ZLIB
+    compress=(mat->current_compression_level>TINYMAT_COMPRESSION_NONE) || (mat->compression_policy && !mat->compression_policy->rules.empty());
+    if (compress && mat->streaming_threshold>0 && element_size>=mat->streaming_threshold && TinyMAT_canPatch(mat)) {
+        mat->staging_active=false;
+        TinyMAT_startStreaming(mat, name, payload, payload_bytes);
+        return;
+    }
+#else
+    (void)name; (void)element_size; (void)payload; (void)payload_bytes;
+#endif
+    if (!compress) {
+        // the variable was only staged, because the backend cannot seek, which is not necessary here
+        mat->staging_active=false;
+        TinyMAT_flushCompression(mat);
+    }
+}
+
+/** \brief writes the complete output of \a buf (including the referenced blocks) to the current position of \a mat */
+TINYMAT_inlineattrib static void TinyMAT_fwriteMem(const TinyMATWriterBuffer& buf, TinyMATWriterFile* mat) {
+    if (buf.references.empty()) {
+        TinyMAT_fwrite(buf.data, 1, static_cast<uint32_t>(buf.count), mat);
+        return;
+    }
+    const std::vector<std::pair<const void*, size_t> > segments=TinyMAT_memSegments(buf);
+    for (size_t i=0; i<segments.size(); i++) {
+        TinyMAT_fwrite(segments[i].first, 1, static_cast<uint32_t>(segments[i].second), mat);
+    }
+}
+
+/*! \brief has to be called after a variable has been written completely (see TinyMAT_beginVariable() )
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_endVariable(TinyMATWriterFile* mat) {
+    if (mat->variable_depth>0) mat->variable_depth--;
+#ifdef TINYMAT_USES_ZLIB
+    if (mat->variable_depth==0 && mat->streamed) {
+        TinyMAT_finishStreaming(mat);
+        return;
+    }
+#endif
+    if (mat->variable_depth==0 && mat->staging_active) {
+        mat->staging_active=false;
+#ifdef TINYMAT_USES_ZLIB
+        const bool policy_active=(mat->compression_policy && mat->compression_policy->isActive());
+        if (mat->current_compression_level<=TINYMAT_COMPRESSION_NONE && !policy_active) {
+            // the variable was only staged, because the backend cannot seek or insert
+            TinyMAT_flushCompression(mat);
+            TinyMAT_fwriteMem(mat->staging, mat);
+            return;
+        }
+        // the compressor needs the variable in one piece
+        TinyMAT_resolveReferences(mat->staging);
+#  ifndef TINYMAT_NO_THREADS
+        if (mat->compression_pool) {
+            // hand the staging buffer over to the worker threads and start a new one for the next variable
+            std::shared_ptr<TinyMATWriterCompressionJob> job=std::make_shared<TinyMATWriterCompressionJob>();
+            job->raw=mat->staging;
+            job->level=mat->current_compression_level;
+            job->policy=mat->compression_policy;
+            mat->staging=TinyMATWriterBuffer();
+            mat->compression_pool->submit(job);
+            TinyMAT_commitCompressionJobs(mat, false);
+            return;
+        }
+#  endif
+        if (!policy_active && !mat->compression_report) {
+            TinyMAT_writeCompressedElement(mat, mat->staging.data, mat->staging.count, mat->current_compression_level);
+            return;
+        }
+        const std::string name=TinyMAT_elementName(mat->staging.data, mat->staging.count);
+        int reason=TINYMAT_DECISION_LEVEL;
+        double sample_ratio=-1;
+        const int level=TinyMAT_decideCompression(mat->compression_policy.get(), name, mat->staging.data, mat->staging.count, mat->current_compression_level, &reason, &sample_ratio);
+        const long startpos=TinyMAT_ftell(mat);
+        if (level>TINYMAT_COMPRESSION_NONE) {
+            TinyMAT_writeCompressedElement(mat, mat->staging.data, mat->staging.count, level);
+        } else {
+            TinyMAT_fwrite(mat->staging.data, 1, static_cast<uint32_t>(mat->staging.count), mat);
+        }
+        TinyMAT_reportCompression(mat, name, mat->staging.count, TinyMAT_ftell(mat)-startpos, level, reason, sample_ratio);
+#else
+        // the variable was only staged, because the backend cannot seek or insert
+        TinyMAT_fwriteMem(mat->staging, mat);
+#endif
+    }
+}
+
+
+
+
+
+
+
+
+
+
+/*! \brief returns the size of the contents (without tag) of a miMATRIX element for a numeric array
+    \ingroup tinymatwriter
+    \internal
+
+    \param ndims number of dimensions
+    \param namelen length of the variable name
+    \param data_bytes number of bytes in the data of the array (without padding)
+ */
+TINYMAT_inlineattrib static uint64_t TinyMAT_matrixContentSize(uint32_t ndims, size_t namelen, uint64_t data_bytes) {
+    // array flags + dimensions + name + data, each with an 8 byte tag and padded to 8 bytes
+    return 16 + (8+((static_cast<uint64_t>(ndims)*4+7)/8)*8) + (8+((namelen+7)/8)*8) + (8+((data_bytes+7)/8)*8);
+}
+
+/*! \brief throws a \c std::runtime_error , if the contents of a miMATRIX element with \a size_bytes bytes do not fit into the 32-bit size of its tag
+    \ingroup tinymatwriter
+    \internal
+
+    Has to be called before TinyMAT_beginVariable(), so nothing of the variable is written.
+ */
+TINYMAT_inlineattrib static void TinyMAT_checkMatrixSize(uint64_t size_bytes) {
+    if (size_bytes>UINT32_MAX) throw std::runtime_error("a variable is too large for a MAT-file (more than 4 GB)");
+}
+
+/** \brief size of the blocks, in which TinyMATWriterBulk collects small elements, if the output does not go into a memory buffer */
+#define TINYMAT_BULK_BLOCK_SIZE (64*1024)
+
+/** \brief arrays with less bytes are transposed in the calling thread by TinyMATWriter_transposeMatrices() */
+#define TINYMAT_TRANSPOSE_PARALLEL_MIN_SIZE (4*1024*1024)
+
+/*! \brief an element of 16 bytes, which is only moved by TinyMAT_transposeBands() */
+struct TinyMATWriterElement16 {
+    uint64_t v[2];
+};
+
+/*! \brief edge length of the tiles for elements of type \a T : tiles of about 8kB, e.g. 64x64 elements of 2 bytes or 32x32 elements of 8 bytes */
+template <typename T>
+struct TinyMATWriterTransposeTile {
+    enum { size=(sizeof(T)<=2)?64:((sizeof(T)<=8)?32:16) };
+};
+
+/*! \brief transposes a region of \a nrows x \a ncols elements: \c src[r*src_stride+c] is moved to \c dst[c*dst_stride+r] (strides in elements)
+    \ingroup tinymatwriter
+    \internal
+ */
+typedef void (*TinyMATWriterTransposeTileFunction)(const void* src, size_t src_stride, void* dst, size_t dst_stride, uint32_t nrows, uint32_t ncols);
+
+/*! \brief scalar transpose of rows \a r0 ... \a r1-1 and columns \a c0 ... \a c1-1 (see TinyMATWriterTransposeTileFunction )
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_transposeScalar(const T* src, size_t src_stride, T* dst, size_t dst_stride, uint32_t r0, uint32_t r1, uint32_t c0, uint32_t c1) {
+    for (uint32_t c=c0; c<c1; c++) {
+        T* d=dst+c*dst_stride;
+        const T* sp=src+c;
+        for (uint32_t r=r0; r<r1; r++) {
+            d[r]=sp[r*src_stride];
+        }
+    }
+}
+
+/*! \brief scalar tile kernel, used for all element sizes without a SIMD kernel
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_transposeTileScalar(const void* src, size_t src_stride, void* dst, size_t dst_stride, uint32_t nrows, uint32_t ncols) {
+    TinyMAT_transposeScalar(static_cast<const T*>(src), src_stride, static_cast<T*>(dst), dst_stride, 0, nrows, 0, ncols);
+}
+
+#ifdef TINYMAT_HAS_SSE2
+/*! \brief one round of the 16x16 byte transpose: row i is interleaved with row i+8 (after 4 rounds the block is transposed)
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_interleaveRowsSSE2(__m128i* r) {
+    const __m128i t0=_mm_unpacklo_epi8(r[0], r[8]);
+    const __m128i t1=_mm_unpackhi_epi8(r[0], r[8]);
+    const __m128i t2=_mm_unpacklo_epi8(r[1], r[9]);
+    const __m128i t3=_mm_unpackhi_epi8(r[1], r[9]);
+    const __m128i t4=_mm_unpacklo_epi8(r[2], r[10]);
+    const __m128i t5=_mm_unpackhi_epi8(r[2], r[10]);
+    const __m128i t6=_mm_unpacklo_epi8(r[3], r[11]);
+    const __m128i t7=_mm_unpackhi_epi8(r[3], r[11]);
+    const __m128i t8=_mm_unpacklo_epi8(r[4], r[12]);
+    const __m128i t9=_mm_unpackhi_epi8(r[4], r[12]);
+    const __m128i t10=_mm_unpacklo_epi8(r[5], r[13]);
+    const __m128i t11=_mm_unpackhi_epi8(r[5], r[13]);
+    const __m128i t12=_mm_unpacklo_epi8(r[6], r[14]);
+    const __m128i t13=_mm_unpackhi_epi8(r[6], r[14]);
+    const __m128i t14=_mm_unpacklo_epi8(r[7], r[15]);
+    const __m128i t15=_mm_unpackhi_epi8(r[7], r[15]);
+    r[0]=t0; r[1]=t1;
+    r[2]=t2; r[3]=t3;
+    r[4]=t4; r[5]=t5;
+    r[6]=t6; r[7]=t7;
+    r[8]=t8; r[9]=t9;
+    r[10]=t10; r[11]=t11;
+    r[12]=t12; r[13]=t13;
+    r[14]=t14; r[15]=t15;
+}
+
+/*! \brief SSE2 micro-kernels, which transpose a block of 16x16 bytes, 8x8 words, 4x4 dwords or 2x2 qwords in registers
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_transposeBlockSSE2(const uint8_t* s, size_t ss, uint8_t* d, size_t ds) {
+    __m128i r[16];
+    for (int i=0; i<16; i++) r[i]=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+i*ss));
+    TinyMAT_interleaveRowsSSE2(r);
+    TinyMAT_interleaveRowsSSE2(r);
+    TinyMAT_interleaveRowsSSE2(r);
+    TinyMAT_interleaveRowsSSE2(r);
+    for (int i=0; i<16; i++) _mm_storeu_si128(reinterpret_cast<__m128i*>(d+i*ds), r[i]);
+}
+TINYMAT_inlineattrib static void TinyMAT_transposeBlockSSE2(const uint16_t* s, size_t ss, uint16_t* d, size_t ds) {
+    const __m128i a0=_mm_unpacklo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+ss)));
+    const __m128i a1=_mm_unpackhi_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+ss)));
+    const __m128i a2=_mm_unpacklo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+2*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+3*ss)));
+    const __m128i a3=_mm_unpackhi_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+2*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+3*ss)));
+    const __m128i a4=_mm_unpacklo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+5*ss)));
+    const __m128i a5=_mm_unpackhi_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+5*ss)));
+    const __m128i a6=_mm_unpacklo_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+6*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+7*ss)));
+    const __m128i a7=_mm_unpackhi_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+6*ss)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+7*ss)));
+    const __m128i b0=_mm_unpacklo_epi32(a0, a2);
+    const __m128i b1=_mm_unpackhi_epi32(a0, a2);
+    const __m128i b2=_mm_unpacklo_epi32(a1, a3);
+    const __m128i b3=_mm_unpackhi_epi32(a1, a3);
+    const __m128i b4=_mm_unpacklo_epi32(a4, a6);
+    const __m128i b5=_mm_unpackhi_epi32(a4, a6);
+    const __m128i b6=_mm_unpacklo_epi32(a5, a7);
+    const __m128i b7=_mm_unpackhi_epi32(a5, a7);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+ds), _mm_unpackhi_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+2*ds), _mm_unpacklo_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+3*ds), _mm_unpackhi_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+4*ds), _mm_unpacklo_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+5*ds), _mm_unpackhi_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+6*ds), _mm_unpacklo_epi64(b3, b7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+7*ds), _mm_unpackhi_epi64(b3, b7));
+}
+TINYMAT_inlineattrib static void TinyMAT_transposeBlockSSE2(const uint32_t* s, size_t ss, uint32_t* d, size_t ds) {
+    const __m128i r0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i r1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+ss));
+    const __m128i r2=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+2*ss));
+    const __m128i r3=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+3*ss));
+    const __m128i t0=_mm_unpacklo_epi32(r0, r1);
+    const __m128i t1=_mm_unpacklo_epi32(r2, r3);
+    const __m128i t2=_mm_unpackhi_epi32(r0, r1);
+    const __m128i t3=_mm_unpackhi_epi32(r2, r3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+ds), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+2*ds), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+3*ds), _mm_unpackhi_epi64(t2, t3));
+}
+TINYMAT_inlineattrib static void TinyMAT_transposeBlockSSE2(const uint64_t* s, size_t ss, uint64_t* d, size_t ds) {
+    const __m128i r0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i r1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+ss));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi64(r0, r1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d+ds), _mm_unpackhi_epi64(r0, r1));
+}
+
+/*! \brief SSE2 tile kernel: all complete blocks are transposed in registers, only the edges use scalar code
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_transposeTileSSE2(const void* src, size_t src_stride, void* dst, size_t dst_stride, uint32_t nrows, uint32_t ncols) {
+    const uint32_t b=16/sizeof(T);
+    const T* s=static_cast<const T*>(src);
+    T* d=static_cast<T*>(dst);
+    uint32_t c=0;
+    // walk down the columns, so the output is written sequentially
+    for (; c+b<=ncols; c+=b) {
+        uint32_t r=0;
+        for (; r+b<=nrows; r+=b) {
+            TinyMAT_transposeBlockSSE2(s+r*src_stride+c, src_stride, d+c*dst_stride+r, dst_stride);
+        }
+        TinyMAT_transposeScalar(s, src_stride, d, dst_stride, r, nrows, c, c+b);
+    }
+    TinyMAT_transposeScalar(s, src_stride, d, dst_stride, 0, nrows, c, ncols);
+}
+
+#endif
+
+/*! \brief selects the tile kernel for elements of type \a T
+    \ingroup tinymatwriter
+    \internal
+
+    The transpose of large arrays is bound by memory bandwidth, wider registers (AVX) are not faster than the SSE2 kernels,
+    as they write more output streams at a time.
+ */
+template <typename T>
+static TinyMATWriterTransposeTileFunction TinyMAT_transposeTileKernel() {
+#ifdef TINYMAT_HAS_SSE2
+    switch (sizeof(T)) {
+        case 1: return TinyMAT_transposeTileSSE2<uint8_t>;
+        case 2: return TinyMAT_transposeTileSSE2<uint16_t>;
+        case 4: return TinyMAT_transposeTileSSE2<uint32_t>;
+        case 8: return TinyMAT_transposeTileSSE2<uint64_t>;
+        default: break;
+    }
+#endif
+    return TinyMAT_transposeTileScalar<T>;
+}
+
+/*! \brief scalar deinterleave of the pixels \a i0 ... \a n-1 with \a channels channels each: \c src[i*channels+ci] is moved to \c dst[ci*dst_stride+i]
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_deinterleaveScalar(const T* src, T* dst, size_t dst_stride, uint32_t i0, uint32_t n, uint32_t channels) {
+    for (uint32_t i=i0; i<n; i++) {
+        for (uint32_t ci=0; ci<channels; ci++) {
+            dst[ci*dst_stride+i]=src[i*channels+ci];
+        }
+    }
+}
+
+#ifdef TINYMAT_HAS_SSE2
+/*! \brief splits 4 pixels with 3 channels of 32 bits \c a=[r0 g0 b0 r1], \c b=[g1 b1 r2 g2], \c c=[b2 r3 g3 b3] into the channels \a ch0, \a ch1, \a ch2
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_deinterleave3x32SSE2(__m128 a, __m128 b, __m128 c, __m128& ch0, __m128& ch1, __m128& ch2) {
+    ch0=_mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2,2,3,0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1,1,2,2)), _MM_SHUFFLE(2,0,1,0));
+    ch1=_mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0,0,1,1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,2,3,3)), _MM_SHUFFLE(2,0,2,0));
+    ch2=_mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1,1,2,2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,3,0,0)), _MM_SHUFFLE(2,0,2,0));
+}
+
+/*! \brief splits 8 pixels with 3 channels of 16 bits (in \a v[0..2] ) into the channels \a ch[0..2] , the words are widened to dwords for TinyMAT_deinterleave3x32SSE2()
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_deinterleave3x16SSE2(const __m128i* v, __m128i* ch) {
+    const __m128i zero=_mm_setzero_si128();
+    __m128 lo[3], hi[3];
+    TinyMAT_deinterleave3x32SSE2(_mm_castsi128_ps(_mm_unpacklo_epi16(v[0], zero)), _mm_castsi128_ps(_mm_unpackhi_epi16(v[0], zero)), _mm_castsi128_ps(_mm_unpacklo_epi16(v[1], zero)), lo[0], lo[1], lo[2]);
+    TinyMAT_deinterleave3x32SSE2(_mm_castsi128_ps(_mm_unpackhi_epi16(v[1], zero)), _mm_castsi128_ps(_mm_unpacklo_epi16(v[2], zero)), _mm_castsi128_ps(_mm_unpackhi_epi16(v[2], zero)), hi[0], hi[1], hi[2]);
+    for (int i=0; i<3; i++) {
+        // sign-extend the low words, so the saturating pack keeps all 16 bits
+        ch[i]=_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(lo[i]), 16), 16), _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(hi[i]), 16), 16));
+    }
+}
+
+/*! \brief SSE2 deinterleave of a row of \a n pixels with 3 or 4 channels (see TinyMAT_deinterleaveScalar() )
+    \ingroup tinymatwriter
+    \internal
+
+    4 channels are split by two to four rounds of unpack instructions (a perfect shuffle of the four registers), 3 channels by shuffles of dwords.
+    2 channels of 32 or 64 bits (the real and imaginary parts of complex numbers) are split by a single shuffle or unpack per register.
+    \return the number of pixels, that were deinterleaved
+ */
+TINYMAT_inlineattrib static uint32_t TinyMAT_deinterleaveSSE2(const uint8_t* s, uint8_t* d, size_t ds, uint32_t n, uint32_t channels) {
+    uint32_t i=0;
+    if (channels==4) {
+        for (; i+16<=n; i+=16) {
+            __m128i v[4];
+            for (int j=0; j<4; j++) v[j]=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i+16*j));
+            for (int round=0; round<4; round++) {
+                const __m128i t0=_mm_unpacklo_epi8(v[0], v[2]);
+                const __m128i t1=_mm_unpackhi_epi8(v[0], v[2]);
+                const __m128i t2=_mm_unpacklo_epi8(v[1], v[3]);
+                const __m128i t3=_mm_unpackhi_epi8(v[1], v[3]);
+                v[0]=t0; v[1]=t1; v[2]=t2; v[3]=t3;
+            }
+            for (int j=0; j<4; j++) _mm_storeu_si128(reinterpret_cast<__m128i*>(d+j*ds+i), v[j]);
+        }
+    } else if (channels==3) {
+        const __m128i zero=_mm_setzero_si128();
+        for (; i+16<=n; i+=16) {
+            __m128i v[6], lo[3], hi[3];
+            for (int j=0; j<3; j++) {
+                const __m128i b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+3*i+16*j));
+                v[2*j]=_mm_unpacklo_epi8(b, zero);
+                v[2*j+1]=_mm_unpackhi_epi8(b, zero);
+            }
+            TinyMAT_deinterleave3x16SSE2(v, lo);
+            TinyMAT_deinterleave3x16SSE2(v+3, hi);
+            for (int j=0; j<3; j++) _mm_storeu_si128(reinterpret_cast<__m128i*>(d+j*ds+i), _mm_packus_epi16(lo[j], hi[j]));
+        }
+    }
+    return i;
+}
+TINYMAT_inlineattrib static uint32_t TinyMAT_deinterleaveSSE2(const uint16_t* s, uint16_t* d, size_t ds, uint32_t n, uint32_t channels) {
+    uint32_t i=0;
+    if (channels==4) {
+        for (; i+8<=n; i+=8) {
+            __m128i v[4];
+            for (int j=0; j<4; j++) v[j]=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i+8*j));
+            for (int round=0; round<3; round++) {
+                const __m128i t0=_mm_unpacklo_epi16(v[0], v[2]);
+                const __m128i t1=_mm_unpackhi_epi16(v[0], v[2]);
+                const __m128i t2=_mm_unpacklo_epi16(v[1], v[3]);
+                const __m128i t3=_mm_unpackhi_epi16(v[1], v[3]);
+                v[0]=t0; v[1]=t1; v[2]=t2; v[3]=t3;
+            }
+            for (int j=0; j<4; j++) _mm_storeu_si128(reinterpret_cast<__m128i*>(d+j*ds+i), v[j]);
+        }
+    } else if (channels==3) {
+        for (; i+8<=n; i+=8) {
+            __m128i v[3], ch[3];
+            for (int j=0; j<3; j++) v[j]=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+3*i+8*j));
+            TinyMAT_deinterleave3x16SSE2(v, ch);
+            for (int j=0; j<3; j++) _mm_storeu_si128(reinterpret_cast<__m128i*>(d+j*ds+i), ch[j]);
+        }
+    }
+    return i;
+}
+TINYMAT_inlineattrib static uint32_t TinyMAT_deinterleaveSSE2(const uint32_t* s, uint32_t* d, size_t ds, uint32_t n, uint32_t channels) {
+    uint32_t i=0;
+    if (channels==4) {
+        for (; i+4<=n; i+=4) {
+            const __m128i v0=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i));
+            const __m128i v1=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i+4));
+            const __m128i v2=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i+8));
+            const __m128i v3=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+4*i+12));
+            const __m128i t0=_mm_unpacklo_epi32(v0, v2);
+            const __m128i t1=_mm_unpackhi_epi32(v0, v2);
+            const __m128i t2=_mm_unpacklo_epi32(v1, v3);
+            const __m128i t3=_mm_unpackhi_epi32(v1, v3);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+i), _mm_unpacklo_epi32(t0, t2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+ds+i), _mm_unpackhi_epi32(t0, t2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+2*ds+i), _mm_unpacklo_epi32(t1, t3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+3*ds+i), _mm_unpackhi_epi32(t1, t3));
+        }
+    } else if (channels==3) {
+        const float* f=reinterpret_cast<const float*>(s);
+        for (; i+4<=n; i+=4) {
+            __m128 ch0, ch1, ch2;
+            TinyMAT_deinterleave3x32SSE2(_mm_loadu_ps(f+3*i), _mm_loadu_ps(f+3*i+4), _mm_loadu_ps(f+3*i+8), ch0, ch1, ch2);
+            _mm_storeu_ps(reinterpret_cast<float*>(d+i), ch0);
+            _mm_storeu_ps(reinterpret_cast<float*>(d+ds+i), ch1);
+            _mm_storeu_ps(reinterpret_cast<float*>(d+2*ds+i), ch2);
+        }
+    } else if (channels==2) {
+        const float* f=reinterpret_cast<const float*>(s);
+        for (; i+4<=n; i+=4) {
+            const __m128 a=_mm_loadu_ps(f+2*i);
+            const __m128 b=_mm_loadu_ps(f+2*i+4);
+            _mm_storeu_ps(reinterpret_cast<float*>(d+i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+            _mm_storeu_ps(reinterpret_cast<float*>(d+ds+i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1)));
+        }
+    }
+    return i;
+}
+TINYMAT_inlineattrib static uint32_t TinyMAT_deinterleaveSSE2(const uint64_t* s, uint64_t* d, size_t ds, uint32_t n, uint32_t channels) {
+    uint32_t i=0;
+    if (channels==2) {
+        for (; i+2<=n; i+=2) {
+            const __m128i a=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+2*i));
+            const __m128i b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s+2*i+2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+i), _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d+ds+i), _mm_unpackhi_epi64(a, b));
+        }
+    }
+    return i;
+}
+#endif
+
+/*! \brief deinterleaves a row of \a n pixels with \a channels channels (see TinyMAT_deinterleaveScalar() ), 3 or 4 channels of 1, 2 or 4 bytes
+           and 2 channels of 4 or 8 bytes use the SSE2 kernels
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_deinterleaveRow(const T* src, T* dst, size_t dst_stride, uint32_t n, uint32_t channels) {
+    uint32_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    switch (sizeof(T)) {
+        case 1: i=TinyMAT_deinterleaveSSE2(reinterpret_cast<const uint8_t*>(src), reinterpret_cast<uint8_t*>(dst), dst_stride, n, channels); break;
+        case 2: i=TinyMAT_deinterleaveSSE2(reinterpret_cast<const uint16_t*>(src), reinterpret_cast<uint16_t*>(dst), dst_stride, n, channels); break;
+        case 4: i=TinyMAT_deinterleaveSSE2(reinterpret_cast<const uint32_t*>(src), reinterpret_cast<uint32_t*>(dst), dst_stride, n, channels); break;
+        case 8: i=TinyMAT_deinterleaveSSE2(reinterpret_cast<const uint64_t*>(src), reinterpret_cast<uint64_t*>(dst), dst_stride, n, channels); break;
+        default: break;
+    }
+#endif
+    TinyMAT_deinterleaveScalar(src, dst, dst_stride, i, n, channels);
+}
+
+/*! \brief fused kernel for multi-channel arrays: splits a tile of \a nrows x \a ncols pixels into channel planes and transposes them
+    \ingroup tinymatwriter
+    \internal
+
+    \c src[r*src_stride+c*channels+ci] is moved to \c dst[ci*plane_stride+c*dst_stride+r] for all channels (\a channel <0)
+    or only for \c ci=channel (which is then written to plane 0). The rows are split into planes on the stack, which stay in the L1 cache
+    and are transposed by \a kernel, so the array itself is read and written only once. Up to 4 channels are always split completely
+    with the SIMD kernels, even if only one of them is written.
+ */
+template <typename T>
+static void TinyMAT_deinterleaveTile(const T* src, size_t src_stride, T* dst, size_t dst_stride, size_t plane_stride, uint32_t nrows, uint32_t ncols, uint32_t channels, int channel, TinyMATWriterTransposeTileFunction kernel) {
+    const uint32_t tile=TinyMATWriterTransposeTile<T>::size;
+    const size_t tile_size=tile*tile;
+    T planes[4*tile_size];
+    const uint32_t first=(channel<0)?0:static_cast<uint32_t>(channel);
+    const uint32_t last=(channel<0)?channels:(first+1);
+    if (channels<=4) {
+        for (uint32_t r=0; r<nrows; r++) {
+            TinyMAT_deinterleaveRow(src+r*src_stride, planes+r*tile, tile_size, ncols, channels);
+        }
+        for (uint32_t ci=first; ci<last; ci++) {
+            kernel(planes+ci*tile_size, tile, dst+(ci-first)*plane_stride, dst_stride, nrows, ncols);
+        }
+    } else {
+        for (uint32_t ci=first; ci<last; ci++) {
+            for (uint32_t r=0; r<nrows; r++) {
+                const T* s=src+r*src_stride+ci;
+                T* d=planes+r*tile;
+                for (uint32_t c=0; c<ncols; c++) {
+                    d[c]=s[c*channels];
+                }
+            }
+            kernel(planes, tile, dst+(ci-first)*plane_stride, dst_stride, nrows, ncols);
+        }
+    }
+}
+
+/*! \brief transposes the bands of \a tile rows \a band_start ... \a band_end-1 (counted over all matrices) from row-major \a src (\a src_stride elements per row) to column-major \a dst
+    \ingroup tinymatwriter
+    \internal
+
+    Each \a tile x \a tile block is transposed by \a kernel , so both blocks stay in the L1 cache. If the elements have \a channels interleaved
+    channels, each block is split into planes of \a plane_stride elements by TinyMAT_deinterleaveTile().
+ */
+template <typename T>
+static void TinyMAT_transposeBands(T* dst, const T* src, uint32_t cols, uint32_t rows, size_t src_stride, uint32_t channels, int channel, size_t plane_stride, uint32_t tile, TinyMATWriterTransposeTileFunction kernel, size_t band_start, size_t band_end) {
+    const size_t bands_per_matrix=(rows+tile-1)/tile;
+    for (size_t band=band_start; band<band_end; band++) {
+        const size_t m=band/bands_per_matrix;
+        const uint32_t r0=static_cast<uint32_t>((band%bands_per_matrix)*tile);
+        const uint32_t r1=std::min<uint32_t>(r0+tile, rows);
+        const T* msrc=src+m*rows*src_stride;
+        T* mdst=dst+m*static_cast<size_t>(cols)*rows;
+        for (uint32_t c0=0; c0<cols; c0+=tile) {
+            const uint32_t c1=std::min<uint32_t>(c0+tile, cols);
+            if (channels==1) {
+                kernel(msrc+r0*src_stride+c0, src_stride, mdst+static_cast<size_t>(c0)*rows+r0, rows, r1-r0, c1-c0);
+            } else {
+                TinyMAT_deinterleaveTile(msrc+r0*src_stride+static_cast<size_t>(c0)*channels, src_stride, mdst+static_cast<size_t>(c0)*rows+r0, rows, plane_stride, r1-r0, c1-c0, channels, channel, kernel);
+            }
+        }
+    }
+}
+
+/*! \brief transposes all matrices with TinyMAT_transposeBands(), distributing the bands over \a threads threads
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_transposeMatrices(void* dst, const void* src, uint32_t cols, uint32_t rows, uint32_t nmatrices, size_t src_stride, uint32_t channels, int channel, size_t plane_stride, int threads) {
+    const uint32_t tile=TinyMATWriterTransposeTile<T>::size;
+    const size_t bands=static_cast<size_t>(nmatrices)*((rows+tile-1)/tile);
+    T* tdst=static_cast<T*>(dst);
+    const T* tsrc=static_cast<const T*>(src);
+    const TinyMATWriterTransposeTileFunction kernel=TinyMAT_transposeTileKernel<T>();
+#ifndef TINYMAT_NO_THREADS
+    if (threads>1 && bands>1) {
+        const size_t nthreads=std::min<size_t>(static_cast<size_t>(threads), bands);
+        std::vector<std::thread> workers;
+        workers.reserve(nthreads-1);
+        for (size_t t=1; t<nthreads; t++) {
+            workers.push_back(std::thread(TinyMAT_transposeBands<T>, tdst, tsrc, cols, rows, src_stride, channels, channel, plane_stride, tile, kernel, bands*t/nthreads, bands*(t+1)/nthreads));
+        }
+        TinyMAT_transposeBands<T>(tdst, tsrc, cols, rows, src_stride, channels, channel, plane_stride, tile, kernel, 0, bands/nthreads);
+        for (size_t t=0; t<workers.size(); t++) {
+            workers[t].join();
+        }
+        return;
+    }
+#else
+    (void)threads;
+#endif
+    TinyMAT_transposeBands<T>(tdst, tsrc, cols, rows, src_stride, channels, channel, plane_stride, tile, kernel, 0, bands);
+}
+
+/*! \brief number of threads, that move an array of \a bytes bytes (see TinyMATWriter_setTransposeThreads() )
+    \ingroup tinymatwriter
+    \internal
+ */
+static int TinyMAT_transposeThreads(const TinyMATWriterFile* mat, uint64_t bytes) {
+    int threads=1;
+#ifndef TINYMAT_NO_THREADS
+    if (bytes>=TINYMAT_TRANSPOSE_PARALLEL_MIN_SIZE) {
+        threads=mat?mat->transpose_threads:TINYMAT_TRANSPOSE_THREADS_AUTO;
+        if (threads==TINYMAT_TRANSPOSE_THREADS_AUTO) {
+            threads=std::max<int>(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        // each thread should move at least 1MB
+        threads=static_cast<int>(std::min<uint64_t>(static_cast<uint64_t>(threads), bytes/(TINYMAT_TRANSPOSE_PARALLEL_MIN_SIZE/4)));
+    }
+#else
+    (void)mat; (void)bytes;
+#endif
+    return threads;
+}
+
+/*! \brief calls \a fn(t) for \c t=0...threads-1 , each in its own thread (\c fn(0) in the calling thread), \a fn must not throw
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename TFunction>
+static void TinyMAT_parallelRun(int threads, const TFunction& fn) {
+#ifndef TINYMAT_NO_THREADS
+    if (threads>1) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads-1);
+        for (int t=1; t<threads; t++) {
+            workers.push_back(std::thread(fn, t));
+        }
+        fn(0);
+        for (size_t t=0; t<workers.size(); t++) {
+            workers[t].join();
+        }
+        return;
+    }
+#endif
+    for (int t=0; t<threads; t++) fn(t);
+}
+
+/*! \brief implements TinyMATWriter_transposeMatrices(), where each row of \a src has \a src_stride elements (of which the first \a cols pixels are transposed)
+    \ingroup tinymatwriter
+    \internal
+
+    If each pixel consists of \a channels interleaved elements, the channels are split into planes of \a nmatrices matrices each
+    (\a channel <0), or only channel \a channel is written. The planes start \a plane_stride elements apart (\c 0: consecutive planes).
+ */
+static void TinyMAT_transpose(TinyMATWriterFile* mat, void* dst, const void* src, uint32_t element_size, uint32_t cols, uint32_t rows, uint32_t nmatrices, size_t src_stride, uint32_t channels, int channel, size_t plane_stride=0) {
+    if (!dst || !src || element_size==0 || channels==0) return;
+    const int threads=TinyMAT_transposeThreads(mat, static_cast<uint64_t>(element_size)*cols*rows*nmatrices*((channel<0)?channels:1));
+    if (plane_stride==0) plane_stride=static_cast<size_t>(cols)*rows*nmatrices;
+    switch (element_size) {
+        case 1: TinyMAT_transposeMatrices<uint8_t>(dst, src, cols, rows, nmatrices, src_stride, channels, channel, plane_stride, threads); break;
+        case 2: TinyMAT_transposeMatrices<uint16_t>(dst, src, cols, rows, nmatrices, src_stride, channels, channel, plane_stride, threads); break;
+        case 4: TinyMAT_transposeMatrices<uint32_t>(dst, src, cols, rows, nmatrices, src_stride, channels, channel, plane_stride, threads); break;
+        case 8: TinyMAT_transposeMatrices<uint64_t>(dst, src, cols, rows, nmatrices, src_stride, channels, channel, plane_stride, threads); break;
+        case 16: TinyMAT_transposeMatrices<TinyMATWriterElement16>(dst, src, cols, rows, nmatrices, src_stride, channels, channel, plane_stride, threads); break;
+        default: {
+            uint8_t* bdst=static_cast<uint8_t*>(dst);
+            const uint8_t* bsrc=static_cast<const uint8_t*>(src);
+            const uint32_t first=(channel<0)?0:static_cast<uint32_t>(channel);
+            const uint32_t last=(channel<0)?channels:(first+1);
+            for (uint32_t ci=first; ci<last; ci++) {
+                for (uint32_t m=0; m<nmatrices; m++) {
+                    for(uint32_t r=0; r<rows; r++) {
+                        for (uint32_t c=0; c<cols; c++) {
+                            memcpy(bdst+(static_cast<size_t>(ci-first)*plane_stride+static_cast<size_t>(m)*cols*rows+static_cast<size_t>(c)*rows+r)*element_size,
+                                   bsrc+((static_cast<size_t>(m)*rows+r)*src_stride+static_cast<size_t>(c)*channels+ci)*element_size, element_size);
+                        }
+                    }
+                }
+            }
+        } break;
+    }
+}
+
+void TinyMATWriter_transposeMatrices(TinyMATWriterFile* mat, void* dst, const void* src, uint32_t element_size, uint32_t cols, uint32_t rows, uint32_t nmatrices) {
+    TinyMAT_transpose(mat, dst, src, element_size, cols, rows, nmatrices, cols, 1, -1);
+}
+
+int TinyMATWriter_setStringEncoding(TinyMATWriterFile* mat, int encoding) {
+    if (!mat || (encoding!=TINYMAT_STRING_ENCODING_UTF8 && encoding!=TINYMAT_STRING_ENCODING_LATIN1)) return FALSE;
+    mat->string_encoding=encoding;
+    return TRUE;
+}
+
+int TinyMATWriter_setStorageNarrowing(TinyMATWriterFile* mat, int enabled) {
+    if (!mat) return FALSE;
+    mat->narrow_storage=(enabled!=0);
+    return TRUE;
+}
+
+int TinyMATWriter_setTransposeThreads(TinyMATWriterFile* mat, int threads) {
+    if (!mat) return FALSE;
+#ifdef TINYMAT_NO_THREADS
+    if (threads!=1 && threads!=0) return FALSE;
+    threads=1;
+#endif
+    mat->transpose_threads=(threads==0)?1:threads;
+    return TRUE;
+}
+
+/*! \brief describes how a dense column-major array is gathered from a strided source array (see TinyMAT_gather() )
+    \ingroup tinymatwriter
+    \internal
+
+    Element \c (i0,i1,...) of the result is read from \c src[i0*strides[0]+i1*strides[1]+...] . The work is split into units, which are
+    distributed over the threads: one unit is a band of tiles (if a source axis is contiguous), or one run along the first axis.
+ */
+struct TinyMATWriterGatherPlan {
+    /** \brief sizes of the (simplified) axes of the result */
+    std::vector<size_t> sizes;
+    /** \brief strides (in elements) of the axes in the source */
+    std::vector<size_t> strides;
+    /** \brief strides (in elements) of the axes in the (dense) result */
+    std::vector<size_t> dst_strides;
+    /** \brief axis >0, that is contiguous in the source and transposed against axis 0 in tiles, or 0 */
+    uint32_t tiled_axis;
+    /** \brief all axes, except 0 and tiled_axis */
+    std::vector<uint32_t> outer_axes;
+    /** \brief edge length of the tiles */
+    uint32_t tile;
+    /** \brief number of bands of tiles along axis 0 (1 if tiled_axis==0) */
+    size_t bands;
+    /** \brief total number of work units */
+    size_t units;
+};
+
+/*! \brief sets up a TinyMATWriterGatherPlan: axes of size 1 are dropped and axes, that are consecutive in the source, are merged
+    \ingroup tinymatwriter
+    \internal
+ */
+static void TinyMAT_planGather(TinyMATWriterGatherPlan& plan, const size_t* sizes, const size_t* strides, uint32_t ndims, uint32_t tile) {
+    plan.sizes.clear();
+    plan.strides.clear();
+    for (uint32_t i=0; i<ndims; i++) {
+        if (sizes[i]==1) continue;
+        if (!plan.sizes.empty() && strides[i]==plan.strides.back()*plan.sizes.back()) {
+            plan.sizes.back()*=sizes[i];
+        } else {
+            plan.sizes.push_back(sizes[i]);
+            plan.strides.push_back(strides[i]);
+        }
+    }
+    if (plan.sizes.empty()) {
+        plan.sizes.push_back(1);
+        plan.strides.push_back(1);
+    }
+    const uint32_t n=static_cast<uint32_t>(plan.sizes.size());
+    plan.dst_strides.resize(n);
+    size_t dst_stride=1;
+    for (uint32_t i=0; i<n; i++) {
+        plan.dst_strides[i]=dst_stride;
+        dst_stride*=plan.sizes[i];
+    }
+    plan.tiled_axis=0;
+    if (plan.strides[0]!=1) {
+        for (uint32_t i=1; i<n && plan.tiled_axis==0; i++) {
+            if (plan.strides[i]==1) plan.tiled_axis=i;
+        }
+    }
+    plan.outer_axes.clear();
+    size_t outer=1;
+    for (uint32_t i=1; i<n; i++) {
+        if (i!=plan.tiled_axis) {
+            plan.outer_axes.push_back(i);
+            outer*=plan.sizes[i];
+        }
+    }
+    plan.tile=tile;
+    plan.bands=(plan.tiled_axis>0)?((plan.sizes[0]+tile-1)/tile):1;
+    plan.units=outer*plan.bands;
+}
+
+/*! \brief gathers the work units \a unit_start ... \a unit_end-1 of \a plan from \a src into \a dst
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_gatherUnits(T* dst, const T* src, const TinyMATWriterGatherPlan* plan, TinyMATWriterTransposeTileFunction kernel, size_t unit_start, size_t unit_end) {
+    const size_t n0=plan->sizes[0];
+    const size_t s0=plan->strides[0];
+    for (size_t unit=unit_start; unit<unit_end; unit++) {
+        // decode the index along the outer axes
+        size_t rest=unit/plan->bands;
+        size_t src_offset=0;
+        size_t dst_offset=0;
+        for (size_t a=0; a<plan->outer_axes.size(); a++) {
+            const uint32_t axis=plan->outer_axes[a];
+            const size_t idx=rest%plan->sizes[axis];
+            rest=rest/plan->sizes[axis];
+            src_offset+=idx*plan->strides[axis];
+            dst_offset+=idx*plan->dst_strides[axis];
+        }
+        const T* s=src+src_offset;
+        T* d=dst+dst_offset;
+        if (plan->tiled_axis>0) {
+            const size_t r0=(unit%plan->bands)*plan->tile;
+            const uint32_t nrows=static_cast<uint32_t>(std::min<size_t>(plan->tile, n0-r0));
+            const size_t ncols=plan->sizes[plan->tiled_axis];
+            const size_t ds=plan->dst_strides[plan->tiled_axis];
+            for (size_t c0=0; c0<ncols; c0+=plan->tile) {
+                kernel(s+r0*s0+c0, s0, d+c0*ds+r0, ds, nrows, static_cast<uint32_t>(std::min<size_t>(plan->tile, ncols-c0)));
+            }
+        } else if (s0==1) {
+            memcpy(d, s, n0*sizeof(T));
+        } else {
+            for (size_t i=0; i<n0; i++) {
+                d[i]=s[i*s0];
+            }
+        }
+    }
+}
+
+/*! \brief copies the strided array \a src into the dense column-major array \a dst (see TinyMATWriterGatherPlan )
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_gatherArray(void* dst, const void* src, const size_t* sizes, const size_t* strides, uint32_t ndims, int threads) {
+    TinyMATWriterGatherPlan plan;
+    TinyMAT_planGather(plan, sizes, strides, ndims, TinyMATWriterTransposeTile<T>::size);
+    T* tdst=static_cast<T*>(dst);
+    const T* tsrc=static_cast<const T*>(src);
+    const TinyMATWriterTransposeTileFunction kernel=TinyMAT_transposeTileKernel<T>();
+#ifndef TINYMAT_NO_THREADS
+    if (threads>1 && plan.units>1) {
+        const size_t nthreads=std::min<size_t>(static_cast<size_t>(threads), plan.units);
+        std::vector<std::thread> workers;
+        workers.reserve(nthreads-1);
+        for (size_t t=1; t<nthreads; t++) {
+            workers.push_back(std::thread(TinyMAT_gatherUnits<T>, tdst, tsrc, &plan, kernel, plan.units*t/nthreads, plan.units*(t+1)/nthreads));
+        }
+        TinyMAT_gatherUnits<T>(tdst, tsrc, &plan, kernel, 0, plan.units/nthreads);
+        for (size_t t=0; t<workers.size(); t++) {
+            workers[t].join();
+        }
+        return;
+    }
+#else
+    (void)threads;
+#endif
+    TinyMAT_gatherUnits<T>(tdst, tsrc, &plan, kernel, 0, plan.units);
+}
+
+/*! \brief copies the strided array \a src (elements of \a element_size bytes) into the dense column-major array \a dst
+    \ingroup tinymatwriter
+    \internal
+
+    Element \c (i0,i1,...) of \a dst is read from \c src[i0*strides[0]+i1*strides[1]+...] (strides in elements). If one of the axes is contiguous
+    in \a src, it is transposed against the first axis with the tile kernels of TinyMATWriter_transposeMatrices(), large arrays are copied in parallel.
+ */
+static void TinyMAT_gather(TinyMATWriterFile* mat, void* dst, const void* src, uint32_t element_size, const size_t* sizes, const size_t* strides, uint32_t ndims) {
+    if (!dst || !src || element_size==0) return;
+    uint64_t bytes=element_size;
+    for (uint32_t i=0; i<ndims; i++) bytes*=sizes[i];
+    if (bytes==0) return;
+    const int threads=TinyMAT_transposeThreads(mat, bytes);
+    switch (element_size) {
+        case 1: TinyMAT_gatherArray<uint8_t>(dst, src, sizes, strides, ndims, threads); break;
+        case 2: TinyMAT_gatherArray<uint16_t>(dst, src, sizes, strides, ndims, threads); break;
+        case 4: TinyMAT_gatherArray<uint32_t>(dst, src, sizes, strides, ndims, threads); break;
+        case 8: TinyMAT_gatherArray<uint64_t>(dst, src, sizes, strides, ndims, threads); break;
+        case 16: TinyMAT_gatherArray<TinyMATWriterElement16>(dst, src, sizes, strides, ndims, threads); break;
+        default: {
+            // the bytes of each element are an additional, contiguous axis
+            std::vector<size_t> bsizes(ndims+1), bstrides(ndims+1);
+            bsizes[0]=element_size;
+            bstrides[0]=1;
+            for (uint32_t i=0; i<ndims; i++) {
+                bsizes[i+1]=sizes[i];
+                bstrides[i+1]=strides[i]*element_size;
+            }
+            TinyMAT_gatherArray<uint8_t>(dst, src, bsizes.data(), bstrides.data(), ndims+1, threads);
+        } break;
+    }
+}
+
+/** \brief size (in bytes) of the blocks of columns, that are transposed and written at once, if the output does not go into a memory buffer */
+#define TINYMAT_TRANSPOSE_CHUNK_SIZE (1024*1024)
+
+/*! \brief writes the data element (of type \a datatype ) for \a nmatrices row-major matrices \a data, transposed to column-major order
+    \ingroup tinymatwriter
+    \internal
+
+    The matrices are transposed directly into the memory cache. If the output goes into a file (or is compressed while it is written),
+    blocks of about TINYMAT_TRANSPOSE_CHUNK_SIZE bytes of columns are transposed into a small buffer and written one after the other.
+    If the elements of \a data consist of \a channels interleaved channels, these are split into planes (the last dimension) at the same time.
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementTransposed(TinyMATWriterFile* mat, uint32_t datatype, const T* data, uint32_t cols, uint32_t rows, uint32_t nmatrices, uint32_t channels)
+{
+    const size_t items=static_cast<size_t>(cols)*rows*nmatrices*channels;
+    TinyMAT_writeU32(mat, datatype);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(T)));
+    uint8_t* reserved=TinyMAT_reserveMem(mat, items*sizeof(T));
+    if (reserved) {
+        TinyMAT_transpose(mat, reserved, data, sizeof(T), cols, rows, nmatrices, static_cast<size_t>(cols)*channels, channels, -1);
+    } else {
+        const uint32_t block_cols=static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(cols, TINYMAT_TRANSPOSE_CHUNK_SIZE/(static_cast<size_t>(rows)*sizeof(T)))));
+        std::unique_ptr<T[]> chunk(new T[static_cast<size_t>(block_cols)*rows]);
+        // the planes are written one after the other, so each one is extracted separately
+        for (uint32_t ci=0; ci<channels; ci++) {
+            for (uint32_t m=0; m<nmatrices; m++) {
+                const T* msrc=data+static_cast<size_t>(m)*cols*rows*channels;
+                for (uint32_t c0=0; c0<cols; c0+=block_cols) {
+                    const uint32_t c1=std::min<uint32_t>(c0+block_cols, cols);
+                    TinyMAT_transpose(mat, chunk.get(), msrc+static_cast<size_t>(c0)*channels, sizeof(T), c1-c0, rows, 1, static_cast<size_t>(cols)*channels, channels, static_cast<int>(ci));
+                    TinyMAT_fwrite(chunk.get(), sizeof(T), (c1-c0)*rows, mat);
+                }
+            }
+        }
+    }
+    // write padding
+    const uint64_t zero=0;
+    if ((items*sizeof(T))%8!=0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(8-(items*sizeof(T))%8), mat);
+}
+
+/*! \brief gathers the strided array \a data (see TinyMAT_gather() ) block-wise into a small buffer and writes the blocks to the output
+    \ingroup tinymatwriter
+    \internal
+
+    Each block has about TINYMAT_TRANSPOSE_CHUNK_SIZE bytes and spans the first axes completely and a part of the next axis.
+ */
+template <typename T>
+static void TinyMAT_fwriteGathered(TinyMATWriterFile* mat, const T* data, const size_t* sizes, const size_t* strides, uint32_t ndims)
+{
+    // the block consists of the axes 0 ... split-1 and a part of axis split
+    uint32_t split=0;
+    size_t block=1;
+    while (split<ndims && block*sizes[split]*sizeof(T)<=TINYMAT_TRANSPOSE_CHUNK_SIZE) {
+        block*=sizes[split];
+        split++;
+    }
+    if (split==ndims) {
+        // the last axis is split into parts, which fit into the chunk
+        split--;
+        block/=sizes[split];
+    }
+    const size_t part=std::max<size_t>(1, std::min<size_t>(sizes[split], TINYMAT_TRANSPOSE_CHUNK_SIZE/(block*sizeof(T))));
+    std::unique_ptr<T[]> chunk(new T[block*part]);
+    std::vector<size_t> bsizes(sizes, sizes+split+1);
+    std::vector<size_t> idx(ndims, 0);
+    bool done=false;
+    while (!done) {
+        size_t offset=0;
+        for (uint32_t i=split; i<ndims; i++) offset+=idx[i]*strides[i];
+        bsizes[split]=std::min<size_t>(part, sizes[split]-idx[split]);
+        TinyMAT_gather(mat, chunk.get(), data+offset, sizeof(T), bsizes.data(), strides, split+1);
+        TinyMAT_fwrite(chunk.get(), sizeof(T), static_cast<uint32_t>(block*bsizes[split]), mat);
+        // advance to the next block
+        idx[split]+=bsizes[split];
+        uint32_t i=split;
+        while (i<ndims && idx[i]>=sizes[i]) {
+            idx[i]=0;
+            i++;
+            if (i<ndims) idx[i]++;
+        }
+        done=(i>=ndims);
+    }
+}
+
+/*! \brief writes the data element (of type \a datatype ) for the strided array \a data, which is gathered into column-major order (see TinyMAT_gather() )
+    \ingroup tinymatwriter
+    \internal
+
+    The array is gathered directly into the memory cache. If the output goes into a file (or is compressed while it is written),
+    it is written block-wise by TinyMAT_fwriteGathered().
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementGathered(TinyMATWriterFile* mat, uint32_t datatype, const T* data, const size_t* sizes, const size_t* strides, uint32_t ndims)
+{
+    size_t items=1;
+    for (uint32_t i=0; i<ndims; i++) items*=sizes[i];
+    TinyMAT_writeU32(mat, datatype);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(items*sizeof(T)));
+    uint8_t* reserved=TinyMAT_reserveMem(mat, items*sizeof(T));
+    if (reserved) {
+        TinyMAT_gather(mat, reserved, data, sizeof(T), sizes, strides, ndims);
+    } else if (items>0) {
+        TinyMAT_fwriteGathered(mat, data, sizes, strides, ndims);
+    }
+    // write padding
+    const uint64_t zero=0;
+    if ((items*sizeof(T))%8!=0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(8-(items*sizeof(T))%8), mat);
+}
+
+/** \brief size (in bytes) of the elements of the integer data types \c TINYMAT_miINT8 ... \c TINYMAT_miUINT32 */
+TINYMAT_inlineattrib static size_t TinyMAT_integerTypeSize(uint32_t mitype) {
+    switch (mitype) {
+        case TINYMAT_miINT8: case TINYMAT_miUINT8: return 1;
+        case TINYMAT_miINT16: case TINYMAT_miUINT16: return 2;
+        case TINYMAT_miINT32: case TINYMAT_miUINT32: return 4;
+        default: return 0;
+    }
+}
+
+/*! \brief determines the range of the \a n values in \a data
+    \ingroup tinymatwriter
+    \internal
+
+    \return \c false, if a value is not an integer (or -0.0, NaN, or outside the range of int32 and uint32), then \a vmin and \a vmax are undefined
+ */
+template <typename T>
+TINYMAT_inlineattrib static bool TinyMAT_integerRange(const T* data, size_t n, double& vmin, double& vmax) {
+    T mn=data[0];
+    T mx=data[0];
+    for (size_t i=1; i<n; i++) {
+        mn=std::min(mn, data[i]);
+        mx=std::max(mx, data[i]);
+    }
+    vmin=static_cast<double>(mn);
+    vmax=static_cast<double>(mx);
+    return true;
+}
+
+#ifdef TINYMAT_HAS_SSE2
+/*! \brief SSE2 scan of double values (see TinyMAT_integerRange() ): a value is an integer, if it survives the round trip through int32 unchanged,
+           values in [2^31,2^32) are moved into the range of int32 by subtracting 2^32 first (which is exact) */
+TINYMAT_inlineattrib static bool TinyMAT_integerRange(const double* data, size_t n, double& vmin, double& vmax) {
+    __m128d mn=_mm_set1_pd(data[0]);
+    __m128d mx=mn;
+    __m128d bad=_mm_setzero_pd();
+    const __m128d zero=_mm_setzero_pd();
+    const __m128d two31=_mm_set1_pd(2147483648.0);
+    const __m128d two32=_mm_set1_pd(4294967296.0);
+    size_t i=0;
+    while (i+2<=n) {
+        // check for non-integers every few thousand elements, so the scan of real-valued data stops early
+        const size_t end=std::min<size_t>(n&~static_cast<size_t>(1), i+4096);
+        for (; i<end; i+=2) {
+            const __m128d v=_mm_loadu_pd(data+i);
+            mn=_mm_min_pd(mn, v);
+            mx=_mm_max_pd(mx, v);
+            // NaN and values outside of int32 and uint32 fail the round trip, -0.0 keeps its sign bit in bad
+            const __m128d w=_mm_sub_pd(v, _mm_and_pd(_mm_cmpge_pd(v, two31), two32));
+            bad=_mm_or_pd(bad, _mm_cmpneq_pd(w, _mm_cvtepi32_pd(_mm_cvttpd_epi32(w))));
+            bad=_mm_or_pd(bad, _mm_and_pd(_mm_cmpeq_pd(v, zero), v));
+        }
+        if (_mm_movemask_pd(bad)!=0) return false;
+    }
+    double m[2], x[2];
+    _mm_storeu_pd(m, mn);
+    _mm_storeu_pd(x, mx);
+    vmin=std::min(m[0], m[1]);
+    vmax=std::max(x[0], x[1]);
+    for (; i<n; i++) {
+        const double v=data[i];
+        if (!(v>=-2147483648.0 && v<=4294967295.0) || v!=floor(v) || (v==0 && signbit(v))) return false;
+        vmin=std::min(vmin, v);
+        vmax=std::max(vmax, v);
+    }
+    return true;
+}
+
+/*! \brief SSE2 scan of float values (see TinyMAT_integerRange() ) */
+TINYMAT_inlineattrib static bool TinyMAT_integerRange(const float* data, size_t n, double& vmin, double& vmax) {
+    __m128 mn=_mm_set1_ps(data[0]);
+    __m128 mx=mn;
+    __m128 bad=_mm_setzero_ps();
+    const __m128 zero=_mm_setzero_ps();
+    const __m128 two31=_mm_set1_ps(2147483648.0f);
+    const __m128 two32=_mm_set1_ps(4294967296.0f);
+    size_t i=0;
+    while (i+4<=n) {
+        const size_t end=std::min<size_t>(n&~static_cast<size_t>(3), i+4096);
+        for (; i<end; i+=4) {
+            const __m128 v=_mm_loadu_ps(data+i);
+            mn=_mm_min_ps(mn, v);
+            mx=_mm_max_ps(mx, v);
+            const __m128 w=_mm_sub_ps(v, _mm_and_ps(_mm_cmpge_ps(v, two31), two32));
+            bad=_mm_or_ps(bad, _mm_cmpneq_ps(w, _mm_cvtepi32_ps(_mm_cvttps_epi32(w))));
+            bad=_mm_or_ps(bad, _mm_and_ps(_mm_cmpeq_ps(v, zero), v));
+        }
+        if (_mm_movemask_ps(bad)!=0) return false;
+    }
+    float m[4], x[4];
+    _mm_storeu_ps(m, mn);
+    _mm_storeu_ps(x, mx);
+    vmin=std::min(std::min(m[0], m[1]), std::min(m[2], m[3]));
+    vmax=std::max(std::max(x[0], x[1]), std::max(x[2], x[3]));
+    for (; i<n; i++) {
+        const float v=data[i];
+        if (!(v>=-2147483648.0f && v<4294967296.0f) || v!=floorf(v) || (v==0 && signbit(v))) return false;
+        vmin=std::min<double>(vmin, v);
+        vmax=std::max<double>(vmax, v);
+    }
+    return true;
+}
+#else
+/*! \brief scan of floating point values (see TinyMAT_integerRange() ) */
+template <typename T>
+TINYMAT_inlineattrib static bool TinyMAT_integerRangeFloat(const T* data, size_t n, double& vmin, double& vmax) {
+    vmin=vmax=static_cast<double>(data[0]);
+    for (size_t i=0; i<n; i++) {
+        const double v=static_cast<double>(data[i]);
+        if (!(v>=-2147483648.0 && v<=4294967295.0) || v!=floor(v) || (v==0 && signbit(v))) return false;
+        vmin=std::min(vmin, v);
+        vmax=std::max(vmax, v);
+    }
+    return true;
+}
+TINYMAT_inlineattrib static bool TinyMAT_integerRange(const double* data, size_t n, double& vmin, double& vmax) {
+    return TinyMAT_integerRangeFloat(data, n, vmin, vmax);
+}
+TINYMAT_inlineattrib static bool TinyMAT_integerRange(const float* data, size_t n, double& vmin, double& vmax) {
+    return TinyMAT_integerRangeFloat(data, n, vmin, vmax);
+}
+#endif
+
+/*! \brief returns the narrowest integer data type (\c TINYMAT_miINT8 ... \c TINYMAT_miUINT32 ), that stores the \a n values in \a data without loss, or 0
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static uint32_t TinyMAT_narrowestType(const T* data, size_t n) {
+    double vmin=0, vmax=0;
+    if (n==0 || !TinyMAT_integerRange(data, n, vmin, vmax)) return 0;
+    if (vmin>=0) {
+        if (vmax<=255.0) return TINYMAT_miUINT8;
+        if (vmax<=65535.0) return TINYMAT_miUINT16;
+        if (vmax<=4294967295.0) return TINYMAT_miUINT32;
+    } else {
+        if (vmin>=-128.0 && vmax<=127.0) return TINYMAT_miINT8;
+        if (vmin>=-32768.0 && vmax<=32767.0) return TINYMAT_miINT16;
+        if (vmin>=-2147483648.0 && vmax<=2147483647.0) return TINYMAT_miINT32;
+    }
+    return 0;
+}
+
+/*! \brief writes the data element for the \a n values in \a data, converted to the narrower type \a TN (data type \a mitype )
+    \ingroup tinymatwriter
+    \internal
+
+    The values are converted block-wise on the stack. Row-major arrays (\a transposed ) with \a channels interleaved channels are transposed
+    in blocks of columns (see TinyMAT_writeDatElementConverted() ), which are converted directly into the memory cache, or into a buffer
+    of one block, if the output goes into a file.
+ */
+template <typename TN, typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementNarrowed(TinyMATWriterFile* mat, uint32_t mitype, const T* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels) {
+    TinyMAT_writeU32(mat, mitype);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(n*sizeof(TN)));
+    if (!transposed) {
+        TN block[16384/sizeof(TN)];
+        const size_t block_size=sizeof(block)/sizeof(TN);
+        for (size_t i0=0; i0<n; i0+=block_size) {
+            const size_t cnt=std::min(block_size, n-i0);
+            for (size_t i=0; i<cnt; i++) block[i]=static_cast<TN>(data[i0+i]);
+            TinyMAT_fwrite(block, sizeof(TN), static_cast<uint32_t>(cnt), mat);
+        }
+    } else {
+        TN* reserved=reinterpret_cast<TN*>(TinyMAT_reserveMem(mat, n*sizeof(TN)));
+        const uint32_t cols=sizes[1];
+        const uint32_t rows=sizes[0];
+        const uint32_t nmatrices=static_cast<uint32_t>(n/(static_cast<size_t>(cols)*rows*channels));
+        const uint32_t block_cols=static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(cols, TINYMAT_TRANSPOSE_CHUNK_SIZE/(static_cast<size_t>(rows)*sizeof(T)))));
+        const size_t chunk_size=static_cast<size_t>(block_cols)*rows;
+        std::unique_ptr<T[]> chunk(new T[chunk_size]);
+        std::vector<TN> narrowed(reserved?0:chunk_size);
+        size_t pos=0;
+        for (uint32_t ci=0; ci<channels; ci++) {
+            for (uint32_t m=0; m<nmatrices; m++) {
+                const T* msrc=data+static_cast<size_t>(m)*cols*rows*channels;
+                for (uint32_t c0=0; c0<cols; c0+=block_cols) {
+                    const uint32_t c1=std::min<uint32_t>(c0+block_cols, cols);
+                    const size_t cnt=static_cast<size_t>(c1-c0)*rows;
+                    TinyMAT_transpose(mat, chunk.get(), msrc+static_cast<size_t>(c0)*channels, sizeof(T), c1-c0, rows, 1, static_cast<size_t>(cols)*channels, channels, static_cast<int>(ci));
+                    TN* dst=reserved?(reserved+pos):narrowed.data();
+                    for (size_t i=0; i<cnt; i++) dst[i]=static_cast<TN>(chunk[i]);
+                    if (!reserved) TinyMAT_fwrite(dst, sizeof(TN), static_cast<uint32_t>(cnt), mat);
+                    pos+=cnt;
+                }
+            }
+        }
+    }
+    // write padding
+    const uint64_t zero=0;
+    if ((n*sizeof(TN))%8!=0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(8-(n*sizeof(TN))%8), mat);
+}
+
+/*! \brief writes the data element for \a data with the integer type \a mitype (see TinyMAT_narrowestType() )
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementAs(TinyMATWriterFile* mat, uint32_t mitype, const T* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels) {
+    switch (mitype) {
+        case TINYMAT_miINT8: TinyMAT_writeDatElementNarrowed<int8_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        case TINYMAT_miUINT8: TinyMAT_writeDatElementNarrowed<uint8_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        case TINYMAT_miINT16: TinyMAT_writeDatElementNarrowed<int16_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        case TINYMAT_miUINT16: TinyMAT_writeDatElementNarrowed<uint16_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        case TINYMAT_miINT32: TinyMAT_writeDatElementNarrowed<int32_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        case TINYMAT_miUINT32: TinyMAT_writeDatElementNarrowed<uint32_t>(mat, mitype, data, n, sizes, transposed, channels); break;
+        default: throw std::runtime_error("unsupported storage type");
+    }
+}
+
+/*! \brief parameters of the quantization of TinyMATWriterConversion : \c q=round(x*inv_scale+bias) (ties away from zero), clamped to \c [lo,hi]
+    \ingroup tinymatwriter
+    \internal
+ */
+struct TinyMATWriterQuantizer {
+    double inv_scale;
+    double bias;
+    double lo;
+    double hi;
+};
+
+/*! \brief converts \a n \c double values to \c float */
+TINYMAT_inlineattrib static void TinyMAT_convertValues(float* dst, const double* src, size_t n, const TinyMATWriterQuantizer&) {
+    size_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    for (; i+4<=n; i+=4) {
+        const __m128 a=_mm_cvtpd_ps(_mm_loadu_pd(src+i));
+        const __m128 b=_mm_cvtpd_ps(_mm_loadu_pd(src+i+2));
+        _mm_storeu_ps(dst+i, _mm_movelh_ps(a, b));
+    }
+#endif
+    for (; i<n; i++) dst[i]=static_cast<float>(src[i]);
+}
+
+/*! \brief copies \a n \c float values (conversion of a \c float array to \c single ) */
+TINYMAT_inlineattrib static void TinyMAT_convertValues(float* dst, const float* src, size_t n, const TinyMATWriterQuantizer&) {
+    memcpy(dst, src, n*sizeof(float));
+}
+
+/*! \brief rounds the clamped value \a v to the nearest integer (ties away from zero, like MATLAB's \c round() ) */
+template <typename TQ, typename T>
+TINYMAT_inlineattrib static TQ TinyMAT_quantizeValue(T v, T lo, T hi) {
+    // NaN fails both comparisons and becomes lo
+    v=(v>=lo)?v:lo;
+    v=(v<=hi)?v:hi;
+    return static_cast<TQ>(lround(v));
+}
+
+#ifdef TINYMAT_HAS_SSE2
+/*! \brief rounds the 4 values in \a x (which are in the range of int32) to the nearest integer, ties away from zero.
+           The SSE2 conversion rounds ties to even, so \a x is truncated and the fraction, which is exact, decides whether to round up or down. */
+TINYMAT_inlineattrib static __m128i TinyMAT_roundHalfAwaySSE2(__m128 x) {
+    const __m128i t=_mm_cvttps_epi32(x);
+    const __m128 frac=_mm_sub_ps(x, _mm_cvtepi32_ps(t));
+    // the comparison masks are -1, where the value is rounded away from zero
+    const __m128i up=_mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f)));
+    const __m128i down=_mm_castps_si128(_mm_cmple_ps(frac, _mm_set1_ps(-0.5f)));
+    return _mm_add_epi32(_mm_sub_epi32(t, up), down);
+}
+
+/*! \brief rounds the 2 values in \a x (which are in the range of int32) to the nearest integer, ties away from zero, the result is in the lower 64 bits */
+TINYMAT_inlineattrib static __m128i TinyMAT_roundHalfAwaySSE2(__m128d x) {
+    const __m128i t=_mm_cvttpd_epi32(x);
+    const __m128d frac=_mm_sub_pd(x, _mm_cvtepi32_pd(t));
+    // the 64 bit comparison masks are moved into the lower two 32 bit lanes
+    const __m128i up=_mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpge_pd(frac, _mm_set1_pd(0.5))), _MM_SHUFFLE(3, 3, 2, 0));
+    const __m128i down=_mm_shuffle_epi32(_mm_castpd_si128(_mm_cmple_pd(frac, _mm_set1_pd(-0.5))), _MM_SHUFFLE(3, 3, 2, 0));
+    return _mm_add_epi32(_mm_sub_epi32(t, up), down);
+}
+
+/*! \brief packs the 8 int32 values in \a a and \a b (which are in the range of int16) to int16 */
+TINYMAT_inlineattrib static void TinyMAT_storePackedSSE2(int16_t* dst, __m128i a, __m128i b) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(a, b));
+}
+
+/*! \brief packs the 8 int32 values in \a a and \a b (which are in the range of uint16) to uint16, SSE2 has no unsigned pack, so the values are shifted into the signed range and back */
+TINYMAT_inlineattrib static void TinyMAT_storePackedSSE2(uint16_t* dst, __m128i a, __m128i b) {
+    const __m128i shift=_mm_set1_epi32(32768);
+    const __m128i packed=_mm_packs_epi32(_mm_sub_epi32(a, shift), _mm_sub_epi32(b, shift));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000))));
+}
+#endif
+
+/*! \brief quantizes \a n \c float values to the integer type \a TQ (the values are scaled in single precision) */
+template <typename TQ>
+TINYMAT_inlineattrib static void TinyMAT_convertValues(TQ* dst, const float* src, size_t n, const TinyMATWriterQuantizer& q) {
+    const float inv_scale=static_cast<float>(q.inv_scale);
+    const float bias=static_cast<float>(q.bias);
+    const float lo=static_cast<float>(q.lo);
+    const float hi=static_cast<float>(q.hi);
+    size_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    const __m128 vscale=_mm_set1_ps(inv_scale);
+    const __m128 vbias=_mm_set1_ps(bias);
+    const __m128 vlo=_mm_set1_ps(lo);
+    const __m128 vhi=_mm_set1_ps(hi);
+    for (; i+8<=n; i+=8) {
+        // max() returns its second operand for NaN, so NaN becomes lo
+        const __m128 a=_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src+i), vscale), vbias), vlo), vhi);
+        const __m128 b=_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src+i+4), vscale), vbias), vlo), vhi);
+        TinyMAT_storePackedSSE2(dst+i, TinyMAT_roundHalfAwaySSE2(a), TinyMAT_roundHalfAwaySSE2(b));
+    }
+#endif
+    for (; i<n; i++) dst[i]=TinyMAT_quantizeValue<TQ>(src[i]*inv_scale+bias, lo, hi);
+}
+
+/*! \brief quantizes \a n \c double values to the integer type \a TQ */
+template <typename TQ>
+TINYMAT_inlineattrib static void TinyMAT_convertValues(TQ* dst, const double* src, size_t n, const TinyMATWriterQuantizer& q) {
+    size_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    const __m128d vscale=_mm_set1_pd(q.inv_scale);
+    const __m128d vbias=_mm_set1_pd(q.bias);
+    const __m128d vlo=_mm_set1_pd(q.lo);
+    const __m128d vhi=_mm_set1_pd(q.hi);
+    __m128i v[4];
+    for (; i+8<=n; i+=8) {
+        for (int k=0; k<4; k++) {
+            const __m128d x=_mm_min_pd(_mm_max_pd(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(src+i+2*k), vscale), vbias), vlo), vhi);
+            v[k]=TinyMAT_roundHalfAwaySSE2(x);
+        }
+        TinyMAT_storePackedSSE2(dst+i, _mm_unpacklo_epi64(v[0], v[1]), _mm_unpacklo_epi64(v[2], v[3]));
+    }
+#endif
+    for (; i<n; i++) dst[i]=TinyMAT_quantizeValue<TQ>(src[i]*q.inv_scale+q.bias, q.lo, q.hi);
+}
+
+/*! \brief writes the data element (of type \a datatype ) for the \a n values in \a data, converted to \a TC (see TinyMATWriterArrayLayout::conversion )
+    \ingroup tinymatwriter
+    \internal
+
+    The values are converted directly into the memory cache, or block-wise on the stack, if the output goes into a file.
+    Row-major arrays (\a transposed ) with \a channels interleaved channels are transposed in blocks of columns (see TinyMAT_writeDatElementTransposed() ),
+    which are converted while they are copied into the output.
+ */
+template <typename TC, typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementConverted(TinyMATWriterFile* mat, uint32_t datatype, const T* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels, const TinyMATWriterQuantizer& q) {
+    TinyMAT_writeU32(mat, datatype);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(n*sizeof(TC)));
+    TC* reserved=reinterpret_cast<TC*>(TinyMAT_reserveMem(mat, n*sizeof(TC)));
+    if (!transposed) {
+        if (reserved) {
+            TinyMAT_convertValues(reserved, data, n, q);
+        } else {
+            TC block[16384/sizeof(TC)];
+            const size_t block_size=sizeof(block)/sizeof(TC);
+            for (size_t i0=0; i0<n; i0+=block_size) {
+                const size_t cnt=std::min(block_size, n-i0);
+                TinyMAT_convertValues(block, data+i0, cnt, q);
+                TinyMAT_fwrite(block, sizeof(TC), static_cast<uint32_t>(cnt), mat);
+            }
+        }
+    } else {
+        const uint32_t cols=sizes[1];
+        const uint32_t rows=sizes[0];
+        const uint32_t nmatrices=static_cast<uint32_t>(n/(static_cast<size_t>(cols)*rows*channels));
+        const uint32_t block_cols=static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(cols, TINYMAT_TRANSPOSE_CHUNK_SIZE/(static_cast<size_t>(rows)*sizeof(T)))));
+        std::vector<T> chunk(static_cast<size_t>(block_cols)*rows);
+        std::vector<TC> converted(reserved?0:chunk.size());
+        size_t pos=0;
+        for (uint32_t ci=0; ci<channels; ci++) {
+            for (uint32_t m=0; m<nmatrices; m++) {
+                const T* msrc=data+static_cast<size_t>(m)*cols*rows*channels;
+                for (uint32_t c0=0; c0<cols; c0+=block_cols) {
+                    const uint32_t c1=std::min<uint32_t>(c0+block_cols, cols);
+                    const size_t cnt=static_cast<size_t>(c1-c0)*rows;
+                    TinyMAT_transpose(mat, chunk.data(), msrc+static_cast<size_t>(c0)*channels, sizeof(T), c1-c0, rows, 1, static_cast<size_t>(cols)*channels, channels, static_cast<int>(ci));
+                    if (reserved) {
+                        TinyMAT_convertValues(reserved+pos, chunk.data(), cnt, q);
+                    } else {
+                        TinyMAT_convertValues(converted.data(), chunk.data(), cnt, q);
+                        TinyMAT_fwrite(converted.data(), sizeof(TC), static_cast<uint32_t>(cnt), mat);
+                    }
+                    pos+=cnt;
+                }
+            }
+        }
+    }
+    // write padding
+    const uint64_t zero=0;
+    if ((n*sizeof(TC))%8!=0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(8-(n*sizeof(TC))%8), mat);
+}
+
+/*! \brief returns whether arrays of type \a T can be converted by TinyMAT_writeDatElementConverted() (only \c double and \c float ) */
+template <typename T>
+TINYMAT_inlineattrib static bool TinyMAT_isConvertible(const T*) { return false; }
+TINYMAT_inlineattrib static bool TinyMAT_isConvertible(const double*) { return true; }
+TINYMAT_inlineattrib static bool TinyMAT_isConvertible(const float*) { return true; }
+
+/*! \brief writes the data element for \a data, converted as given by \a conversion (see TinyMATWriterArrayLayout::conversion )
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementConverted(TinyMATWriterFile*, const TinyMATWriterConversion&, const T*, size_t, const int32_t*, bool, uint32_t) {
+    throw std::runtime_error("only double and float arrays can be converted while they are written");
+}
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementConvertedFloat(TinyMATWriterFile* mat, const TinyMATWriterConversion& conversion, const T* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels) {
+    TinyMATWriterQuantizer q;
+    q.inv_scale=1.0/conversion.scale;
+    q.bias=-conversion.offset/conversion.scale;
+    switch (conversion.type) {
+        case TINYMAT_CONVERT_INT16:
+            q.lo=-32768.0; q.hi=32767.0;
+            TinyMAT_writeDatElementConverted<int16_t>(mat, TINYMAT_miINT16, data, n, sizes, transposed, channels, q);
+            break;
+        case TINYMAT_CONVERT_UINT16:
+            q.lo=0.0; q.hi=65535.0;
+            TinyMAT_writeDatElementConverted<uint16_t>(mat, TINYMAT_miUINT16, data, n, sizes, transposed, channels, q);
+            break;
+        default:
+            TinyMAT_writeDatElementConverted<float>(mat, TINYMAT_miSINGLE, data, n, sizes, transposed, channels, q);
+            break;
+    }
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementConverted(TinyMATWriterFile* mat, const TinyMATWriterConversion& conversion, const double* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels) {
+    TinyMAT_writeDatElementConvertedFloat(mat, conversion, data, n, sizes, transposed, channels);
+}
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementConverted(TinyMATWriterFile* mat, const TinyMATWriterConversion& conversion, const float* data, size_t n, const int32_t* sizes, bool transposed, uint32_t channels) {
+    TinyMAT_writeDatElementConvertedFloat(mat, conversion, data, n, sizes, transposed, channels);
+}
+
+/*! \brief throws a \c std::runtime_error , if \a conversion is invalid (see TinyMATWriterConversion )
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_checkConversion(const TinyMATWriterConversion& conversion) {
+    if (conversion.type!=TINYMAT_CONVERT_SINGLE && conversion.type!=TINYMAT_CONVERT_INT16 && conversion.type!=TINYMAT_CONVERT_UINT16) {
+        throw std::runtime_error("unknown conversion type");
+    }
+    if (conversion.type!=TINYMAT_CONVERT_SINGLE && !(conversion.scale!=0.0 && fabs(conversion.scale)<=DBL_MAX && fabs(conversion.offset)<=DBL_MAX)) {
+        throw std::runtime_error("the scale of a quantized array has to be finite and non-zero");
+    }
+}
+
+/*! \brief converts the byte strides of \a layout (see TinyMATWriterArrayLayout::strides ) into strides in elements of \a element_size bytes
+    \ingroup tinymatwriter
+    \internal
+
+    \return \c true , if the array is gathered, i.e. \a gather_sizes and \a gather_strides were filled for the \a ndims axes of the written array
+    \throws std::runtime_error if a size is negative or a stride is negative or not a multiple of \a element_size
+ */
+TINYMAT_inlineattrib static bool TinyMAT_gatherLayout(const TinyMATWriterArrayLayout& layout, size_t element_size, const int32_t* sizes, uint32_t ndims, std::vector<size_t>& gather_sizes, std::vector<size_t>& gather_strides) {
+    if (!layout.strides) return false;
+    gather_sizes.resize(ndims);
+    gather_strides.resize(ndims);
+    for (uint32_t i=0; i<ndims; i++) {
+        if (sizes[i]<0) throw std::runtime_error("negative size of an array");
+        if (layout.strides[i]<0 || layout.strides[i]%static_cast<int64_t>(element_size)!=0) {
+            throw std::runtime_error("the strides of an array view have to be non-negative multiples of the element size");
+        }
+        gather_sizes[i]=static_cast<size_t>(sizes[i]);
+        gather_strides[i]=static_cast<size_t>(layout.strides[i]/static_cast<int64_t>(element_size));
+    }
+    return true;
+}
+
+/*! \brief sets TinyMATWriterFile::zerocopy_candidate while an array is written, it is reset on every exit path
+    \ingroup tinymatwriter
+    \internal
+ */
+struct TinyMATWriterZeroCopyScope {
+    inline TinyMATWriterZeroCopyScope(TinyMATWriterFile* mat_, const void* data) :
+      mat(mat_)
+    {
+        mat->zerocopy_candidate=data;
+    }
+    inline ~TinyMATWriterZeroCopyScope() {
+        mat->zerocopy_candidate=NULL;
+    }
+
+    TinyMATWriterFile* mat;
+};
+
+/*! \brief writes a numeric array (colmajor), the overloads of TinyMATWriter_writeMatrixND_layout() only choose the class and data element for \a T
+    \ingroup tinymatwriter
+    \internal
+
+    As the size of the miMATRIX element is written directly, large arrays can be compressed while they are written (see TinyMAT_startStreaming() ).
+    Row-major arrays (TinyMATWriterArrayLayout::transposed ) are transposed while they are written (as data element of type \a datatype ),
+    views (TinyMATWriterArrayLayout::strides ) are gathered. With TinyMATWriter_setStorageNarrowing(), integer values may be stored with a narrower type.
+    \a layout is checked, before anything is written.
+ */
+template <typename T, typename TWriteData>
+TINYMAT_inlineattrib static void TinyMAT_writeMatrixND_colmajor_internal(TinyMATWriterFile *mat, const char *name, const T *data_real, const int32_t *sizes, uint32_t ndims, uint32_t classflags, uint32_t datatype, TWriteData writeData, const TinyMATWriterArrayLayout& layout)
+{
+    if (!data_real || !sizes || ndims<=0) {
+        TinyMATWriter_writeEmptyMatrix(mat, name);
+    } else {
+        std::vector<size_t> gather_sizes, gather_strides;
+        const bool gather=TinyMAT_gatherLayout(layout, sizeof(T), sizes, ndims, gather_sizes, gather_strides);
+        const bool transposed=layout.transposed && !gather && ndims>1;
+        const uint32_t channels=transposed?std::max<uint32_t>(1, layout.channels):1;
+        // converted arrays are stored with the class of the conversion
+        const bool convert=(layout.conversion!=NULL);
+        if (convert) {
+            if (!TinyMAT_isConvertible(data_real)) throw std::runtime_error("only double and float arrays can be converted while they are written");
+            if (gather) throw std::runtime_error("array views can not be converted while they are written");
+            TinyMAT_checkConversion(*layout.conversion);
+            switch (layout.conversion->type) {
+                case TINYMAT_CONVERT_INT16: classflags=TINYMAT_mxINT16_CLASS_arrayflags; datatype=TINYMAT_miINT16; break;
+                case TINYMAT_CONVERT_UINT16: classflags=TINYMAT_mxUINT16_CLASS_arrayflags; datatype=TINYMAT_miUINT16; break;
+                default: classflags=TINYMAT_mxSINGLE_CLASS_arrayflags; datatype=TINYMAT_miSINGLE; break;
+            }
+        }
+        TinyMATWriterZeroCopyScope zerocopy(mat, layout.reference?data_real:NULL);
+        mat->addStructItemName(name);
+        uint32_t nentries=0;
+        for (uint32_t i=0; i<ndims; i++) {
+            if (i==0) {
+                nentries=sizes[0];
+            } else {
+                nentries=nentries*sizes[i];
+            }
+        }
+        // arrays, that are gathered from a view or referenced in zero-copy mode, are always stored with their own type
+        uint32_t storage_type=datatype;
+        if (mat->narrow_storage && !convert && sizeof(T)>1 && nentries>0 && !gather && !layout.reference) {
+            const uint32_t narrowest=TinyMAT_narrowestType(data_real, nentries);
+            if (narrowest!=0 && TinyMAT_integerTypeSize(narrowest)<sizeof(T)) storage_type=narrowest;
+        }
+        uint64_t data_bytes=static_cast<uint64_t>(nentries)*((storage_type==datatype)?sizeof(T):TinyMAT_integerTypeSize(storage_type));
+        if (convert) data_bytes=static_cast<uint64_t>(nentries)*((datatype==TINYMAT_miSINGLE)?sizeof(float):sizeof(int16_t));
+        const uint32_t size_bytes=static_cast<uint32_t>(TinyMAT_matrixContentSize(ndims, strlen(name), data_bytes));
+        TinyMAT_beginVariable(mat, name, static_cast<uint64_t>(size_bytes)+8, data_real, data_bytes);
+
+        uint32_t arrayflags[2]={classflags, 0};
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write data type
+        if (convert) {
+            TinyMAT_writeDatElementConverted(mat, *layout.conversion, data_real, nentries, sizes, transposed, channels);
+        } else if (storage_type!=datatype) {
+            TinyMAT_writeDatElementAs(mat, storage_type, data_real, nentries, sizes, transposed, channels);
+        } else if (gather && nentries>0) {
+            TinyMAT_writeDatElementGathered(mat, datatype, data_real, gather_sizes.data(), gather_strides.data(), ndims);
+        } else if (transposed && nentries>0) {
+            TinyMAT_writeDatElementTransposed(mat, datatype, data_real, sizes[1], sizes[0], nentries/(sizes[0]*sizes[1]*channels), channels);
+        } else {
+            writeData(mat, data_real, nentries);
+        }
+        TinyMAT_endVariable(mat);
+    }
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const double *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxDOUBLE_CLASS_arrayflags, TINYMAT_miDOUBLE, TinyMAT_writeDatElement_dbla, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const double *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const float *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxSINGLE_CLASS_arrayflags, TINYMAT_miSINGLE, TinyMAT_writeDatElement_flta, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const float *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const uint64_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxUINT64_CLASS_arrayflags, TINYMAT_miUINT64, TinyMAT_writeDatElement_u64a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint64_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const int64_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxINT64_CLASS_arrayflags, TINYMAT_miINT64, TinyMAT_writeDatElement_i64a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int64_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+
+
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const uint32_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxUINT32_CLASS_arrayflags, TINYMAT_miUINT32, TinyMAT_writeDatElement_u32a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint32_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const int32_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxINT32_CLASS_arrayflags, TINYMAT_miINT32, TinyMAT_writeDatElement_i32a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int32_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const uint16_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxUINT16_CLASS_arrayflags, TINYMAT_miUINT16, TinyMAT_writeDatElement_u16a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint16_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const int16_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxINT16_CLASS_arrayflags, TINYMAT_miINT16, TinyMAT_writeDatElement_i16a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int16_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+
+
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const uint8_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxUINT8_CLASS_arrayflags, TINYMAT_miUINT8, TinyMAT_writeDatElement_u8a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const uint8_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const int8_t *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxINT8_CLASS_arrayflags, TINYMAT_miINT8, TinyMAT_writeDatElement_i8a, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const int8_t *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+/** \brief number of complex values, that are split at once on the stack, if the output does not go into a memory buffer */
+#define TINYMAT_COMPLEX_BLOCK_SIZE 2048
+
+/*! \brief writes the real and the imaginary part of a complex array, i.e. two data elements of type \a datatype with \a n values of type \a T each
+    \ingroup tinymatwriter
+    \internal
+
+    If the output goes into a memory buffer, both data elements are reserved at once and \a split(re, im_offset) writes the real part to \c re
+    and the imaginary part to \c re+im_offset in a single pass over the array. Otherwise \a extract(part) writes the values of one part
+    (\c 0: real, \c 1: imaginary) block-wise to the output, so the array is read twice.
+ */
+template <typename T, typename TSplit, typename TExtract>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementsComplex(TinyMATWriterFile* mat, uint32_t datatype, size_t n, TSplit split, TExtract extract)
+{
+    const uint64_t zero=0;
+    const size_t bytes=n*sizeof(T);
+    const size_t padding=(8-bytes%8)%8;
+    TinyMAT_writeU32(mat, datatype);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(bytes));
+    uint8_t* reserved=TinyMAT_reserveMem(mat, 2*bytes+padding+8);
+    if (reserved) {
+        split(reinterpret_cast<T*>(reserved), (bytes+padding+8)/sizeof(T));
+        memset(reserved+bytes, 0, padding);
+        const uint32_t tag[2]={datatype, static_cast<uint32_t>(bytes)};
+        memcpy(reserved+bytes+padding, tag, sizeof(tag));
+    } else {
+        extract(0);
+        if (padding>0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(padding), mat);
+        TinyMAT_writeU32(mat, datatype);
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(bytes));
+        extract(1);
+    }
+    if (padding>0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(padding), mat);
+}
+
+/*! \brief writes the real and imaginary part of the \a n interleaved complex values in \a data (see TinyMAT_writeDatElementsComplex() )
+    \ingroup tinymatwriter
+    \internal
+
+    The parts are split with SSE2 shuffles (see TinyMAT_deinterleaveRow() ), large arrays in parallel (see TinyMATWriter_setTransposeThreads() ).
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementsComplex(TinyMATWriterFile* mat, uint32_t datatype, const T* data, uint32_t n)
+{
+    TinyMAT_writeDatElementsComplex<T>(mat, datatype, n,
+        [mat, data, n](T* re, size_t im_offset) {
+            const int threads=TinyMAT_transposeThreads(mat, static_cast<uint64_t>(n)*2*sizeof(T));
+            TinyMAT_parallelRun(threads, [data, n, re, im_offset, threads](int t) {
+                const uint32_t i0=static_cast<uint32_t>(static_cast<uint64_t>(n)*t/threads);
+                const uint32_t i1=static_cast<uint32_t>(static_cast<uint64_t>(n)*(t+1)/threads);
+                TinyMAT_deinterleaveRow(data+2*static_cast<size_t>(i0), re+i0, im_offset, i1-i0, 2);
+            });
+        },
+        [mat, data, n](int part) {
+            T block[2*TINYMAT_COMPLEX_BLOCK_SIZE];
+            for (uint32_t i0=0; i0<n; i0+=TINYMAT_COMPLEX_BLOCK_SIZE) {
+                const uint32_t cnt=std::min<uint32_t>(TINYMAT_COMPLEX_BLOCK_SIZE, n-i0);
+                TinyMAT_deinterleaveRow(data+2*static_cast<size_t>(i0), block, TINYMAT_COMPLEX_BLOCK_SIZE, cnt, 2);
+                TinyMAT_fwrite(block+part*TINYMAT_COMPLEX_BLOCK_SIZE, sizeof(T), cnt, mat);
+            }
+        });
+}
+
+/*! \brief writes the real and imaginary part of \a nmatrices row-major matrices of interleaved complex values, transposed to column-major order
+    \ingroup tinymatwriter
+    \internal
+
+    Like TinyMAT_writeDatElementTransposed() with two channels: each tile is split into the parts with SSE2 and both are transposed
+    in the same pass directly into the two data elements.
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementsComplexTransposed(TinyMATWriterFile* mat, uint32_t datatype, const T* data, uint32_t cols, uint32_t rows, uint32_t nmatrices)
+{
+    TinyMAT_writeDatElementsComplex<T>(mat, datatype, static_cast<size_t>(cols)*rows*nmatrices,
+        [mat, data, cols, rows, nmatrices](T* re, size_t im_offset) {
+            TinyMAT_transpose(mat, re, data, sizeof(T), cols, rows, nmatrices, static_cast<size_t>(cols)*2, 2, -1, im_offset);
+        },
+        [mat, data, cols, rows, nmatrices](int part) {
+            const uint32_t block_cols=static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(cols, TINYMAT_TRANSPOSE_CHUNK_SIZE/(static_cast<size_t>(rows)*sizeof(T)))));
+            std::unique_ptr<T[]> chunk(new T[static_cast<size_t>(block_cols)*rows]);
+            for (uint32_t m=0; m<nmatrices; m++) {
+                const T* msrc=data+static_cast<size_t>(m)*cols*rows*2;
+                for (uint32_t c0=0; c0<cols; c0+=block_cols) {
+                    const uint32_t c1=std::min<uint32_t>(c0+block_cols, cols);
+                    TinyMAT_transpose(mat, chunk.get(), msrc+static_cast<size_t>(c0)*2, sizeof(T), c1-c0, rows, 1, static_cast<size_t>(cols)*2, 2, part);
+                    TinyMAT_fwrite(chunk.get(), sizeof(T), (c1-c0)*rows, mat);
+                }
+            }
+        });
+}
+
+/*! \brief writes the real and imaginary part of the strided complex array \a data (\a strides in complex values), gathered into column-major order
+    \ingroup tinymatwriter
+    \internal
+
+    Each part is gathered separately as strided array of type \a T (see TinyMAT_gather() ).
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementsComplexGathered(TinyMATWriterFile* mat, uint32_t datatype, const T* data, const size_t* sizes, const size_t* strides, uint32_t ndims)
+{
+    size_t items=1;
+    std::vector<size_t> part_strides(ndims);
+    for (uint32_t i=0; i<ndims; i++) {
+        items*=sizes[i];
+        part_strides[i]=2*strides[i];
+    }
+    TinyMAT_writeDatElementsComplex<T>(mat, datatype, items,
+        [mat, data, sizes, ndims, &part_strides](T* re, size_t im_offset) {
+            TinyMAT_gather(mat, re, data, sizeof(T), sizes, part_strides.data(), ndims);
+            TinyMAT_gather(mat, re+im_offset, data+1, sizeof(T), sizes, part_strides.data(), ndims);
+        },
+        [mat, data, sizes, ndims, &part_strides](int part) {
+            TinyMAT_fwriteGathered(mat, data+part, sizes, part_strides.data(), ndims);
+        });
+}
+
+/*! \brief writes a complex array (colmajor), the overloads of TinyMATWriter_writeMatrixND_colmajor() for \c std::complex<T> only choose the class and data element for \a T
+    \ingroup tinymatwriter
+    \internal
+
+    The interleaved values are split into the real and imaginary part while they are written, so no planar copy is needed. Row-major arrays
+    and views (see TinyMATWriterArrayLayout ) are transposed or gathered at the same time. \a layout is checked, before anything is written.
+ */
+template <typename T>
+TINYMAT_inlineattrib static void TinyMAT_writeComplexND_colmajor_internal(TinyMATWriterFile *mat, const char *name, const std::complex<T> *data, const int32_t *sizes, uint32_t ndims, uint32_t classflags, uint32_t datatype, const TinyMATWriterArrayLayout& layout)
+{
+    if (!data || !sizes || ndims<=0) {
+        TinyMATWriter_writeEmptyMatrix(mat, name);
+    } else {
+        if (layout.conversion) throw std::runtime_error("complex arrays can not be converted while they are written");
+        std::vector<size_t> gather_sizes, gather_strides;
+        const bool gather=TinyMAT_gatherLayout(layout, sizeof(std::complex<T>), sizes, ndims, gather_sizes, gather_strides);
+        const bool transposed=layout.transposed && !gather && ndims>1;
+        if (transposed && layout.channels>1) throw std::runtime_error("complex arrays can not be split into channels while they are written");
+        mat->addStructItemName(name);
+        uint32_t nentries=1;
+        for (uint32_t i=0; i<ndims; i++) {
+            nentries=nentries*sizes[i];
+        }
+        // std::complex<T> is layout-compatible with T[2]
+        const T* values=reinterpret_cast<const T*>(data);
+        const uint64_t data_bytes=static_cast<uint64_t>(nentries)*sizeof(T);
+        // the imaginary part is a second data element behind the real part
+        const uint32_t size_bytes=static_cast<uint32_t>(TinyMAT_matrixContentSize(ndims, strlen(name), data_bytes)+8+((data_bytes+7)/8)*8);
+        TinyMAT_beginVariable(mat, name, static_cast<uint64_t>(size_bytes)+8, data, 2*data_bytes);
+
+        uint32_t arrayflags[2]={classflags|TINYMAT_mxCOMPLEX_flag, 0};
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write real and imaginary part
+        if (gather && nentries>0) {
+            TinyMAT_writeDatElementsComplexGathered(mat, datatype, values, gather_sizes.data(), gather_strides.data(), ndims);
+        } else if (transposed && nentries>0) {
+            TinyMAT_writeDatElementsComplexTransposed(mat, datatype, values, sizes[1], sizes[0], nentries/(sizes[0]*sizes[1]));
+        } else {
+            TinyMAT_writeDatElementsComplex(mat, datatype, values, nentries);
+        }
+        TinyMAT_endVariable(mat);
+    }
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const std::complex<double> *data, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeComplexND_colmajor_internal(mat, name, data, sizes, ndims, TINYMAT_mxDOUBLE_CLASS_arrayflags, TINYMAT_miDOUBLE, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const std::complex<double> *data, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const std::complex<float> *data, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeComplexND_colmajor_internal(mat, name, data, sizes, ndims, TINYMAT_mxSINGLE_CLASS_arrayflags, TINYMAT_miSINGLE, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const std::complex<float> *data, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+/*! \brief converts \a n values of \a src to the bytes 0 and 1 of a logical array */
+TINYMAT_inlineattrib static void TinyMAT_boolToBytes(uint8_t* dst, const bool* src, size_t n) {
+    const uint8_t* bsrc=reinterpret_cast<const uint8_t*>(src);
+    size_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    const __m128i zero=_mm_setzero_si128();
+    const __m128i one=_mm_set1_epi8(1);
+    for (; i+16<=n; i+=16) {
+        const __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i*>(bsrc+i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i), _mm_andnot_si128(_mm_cmpeq_epi8(v, zero), one));
+    }
+#endif
+    for (; i<n; i++) dst[i]=(bsrc[i]!=0)?1:0;
+}
+
+/*! \brief expands the first \a n bits of \a words (bit \c i is bit \c i%64 of \c words[i/64] ) to the bytes 0 and 1 of a logical array */
+TINYMAT_inlineattrib static void TinyMAT_unpackBits(uint8_t* dst, const uint64_t* words, size_t n) {
+    size_t i=0;
+#ifdef TINYMAT_HAS_SSE2
+    // byte k of a vector selects bit k%8 of the byte, that is broadcast into its half of the vector
+    const __m128i mask=_mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+    const __m128i one=_mm_set1_epi8(1);
+    for (; i+64<=n; i+=64) {
+        const uint64_t w=words[i/64];
+        for (int k=0; k<4; k++) {
+            __m128i v=_mm_cvtsi32_si128(static_cast<int>((w>>(16*k))&0xFFFF));
+            v=_mm_unpacklo_epi8(v, v);
+            v=_mm_unpacklo_epi16(v, v);
+            v=_mm_unpacklo_epi32(v, v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i+16*k), _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, mask), mask), one));
+        }
+    }
+#endif
+    for (; i<n; i++) dst[i]=static_cast<uint8_t>((words[i/64]>>(i%64))&1);
+}
+
+/*! \brief writes the data element of a logical array with \a n elements, \a convert(dst, first, count) fills \a dst with the bytes
+           of the elements \a first ... \a first+count-1
+    \ingroup tinymatwriter
+    \internal
+
+    The bytes are converted directly into the memory cache, or block-wise on the stack, if the output goes into a file.
+ */
+template <typename TConvert>
+TINYMAT_inlineattrib static void TinyMAT_writeDatElementLogical(TinyMATWriterFile* mat, size_t n, TConvert convert) {
+    TinyMAT_writeU32(mat, TINYMAT_miINT8);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(n));
+    if (n==0) return;
+    uint8_t* reserved=TinyMAT_reserveMem(mat, n);
+    if (reserved) {
+        convert(reserved, 0, n);
+    } else {
+        // a multiple of 64, so blocks of packed bits start at a word
+        uint8_t block[16384];
+        for (size_t i0=0; i0<n; i0+=sizeof(block)) {
+            const size_t cnt=std::min(sizeof(block), n-i0);
+            convert(block, i0, cnt);
+            TinyMAT_fwrite(block, 1, static_cast<uint32_t>(cnt), mat);
+        }
+    }
+    // write padding
+    const uint64_t zero=0;
+    if (n%8!=0) TinyMAT_fwrite(&zero, 1, static_cast<uint32_t>(8-n%8), mat);
+}
+
+TINYMAT_inlineattrib static void TinyMAT_writeDatElement_logical(TinyMATWriterFile* mat, const bool* data, uint32_t items) {
+    TinyMAT_writeDatElementLogical(mat, items, [data](uint8_t* dst, size_t first, size_t count) { TinyMAT_boolToBytes(dst, data+first, count); });
+}
+
+void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile *mat, const char *name, const bool *data_real, const int32_t *sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout)
+{
+    TinyMAT_writeMatrixND_colmajor_internal(mat, name, data_real, sizes, ndims, TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags, TINYMAT_miINT8, TinyMAT_writeDatElement_logical, layout);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile *mat, const char *name, const bool *data_real, const int32_t *sizes, uint32_t ndims)
+{
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+void TinyMATWriter_writeLogicalBitsND_colmajor(TinyMATWriterFile* mat, const char* name, const uint64_t* bits, const int32_t* sizes, uint32_t ndims)
+{
+    if (!bits || !sizes || ndims<=0) {
+        TinyMATWriter_writeEmptyMatrix(mat, name);
+    } else {
+        mat->addStructItemName(name);
+        uint32_t nentries=1;
+        for (uint32_t i=0; i<ndims; i++) nentries=nentries*sizes[i];
+        const uint32_t size_bytes=static_cast<uint32_t>(TinyMAT_matrixContentSize(ndims, strlen(name), nentries));
+        TinyMAT_beginVariable(mat, name, static_cast<uint64_t>(size_bytes)+8, bits, (nentries+7)/8);
+
+        uint32_t arrayflags[2]={TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags, 0};
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write data type
+        TinyMAT_writeDatElementLogical(mat, nentries, [bits](uint8_t* dst, size_t first, size_t count) { TinyMAT_unpackBits(dst, bits+first/64, count); });
+        TinyMAT_endVariable(mat);
+    }
+}
+
+/*! \brief writes a sparse matrix in CSC format (see TinyMATWriter_writeSparseCSC() ), \a values is \c NULL for a logical matrix
+    \ingroup tinymatwriter
+    \internal
+
+    The row indices, column pointers and values are written directly as the ir, jc and pr data elements of the miMATRIX element.
+ */
+static void TinyMAT_writeSparse(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* colptr, const int32_t* rowind, const double* values) {
+    if (rows<0 || cols<0 || !colptr || colptr[0]!=0 || (colptr[cols]>0 && !rowind)) {
+        throw std::runtime_error("invalid size or column pointers of a sparse matrix");
+    }
+    for (int32_t c=0; c<cols; c++) {
+        const int32_t first=colptr[c];
+        const int32_t last=colptr[c+1];
+        if (last<first) throw std::runtime_error("the column pointers of a sparse matrix are not ascending");
+        for (int32_t k=first; k<last; k++) {
+            if (rowind[k]<0 || rowind[k]>=rows || (k>first && rowind[k]<=rowind[k-1])) {
+                throw std::runtime_error("a row index of a sparse matrix is out of range, or not ascending and unique within its column");
+            }
+        }
+    }
+    const uint32_t nnz=static_cast<uint32_t>(colptr[cols]);
+    // MATLAB expects space for at least one entry
+    const uint32_t nzmax=std::max<uint32_t>(nnz, 1);
+    const bool logical=(values==NULL);
+    const uint64_t value_bytes=static_cast<uint64_t>(nzmax)*(logical?1:sizeof(double));
+    const uint64_t size_bytes=16 + (8+8) + (8+((strlen(name)+7)/8)*8) + (8+((static_cast<uint64_t>(nzmax)*4+7)/8)*8)
+                              + (8+((static_cast<uint64_t>(cols+1)*4+7)/8)*8) + (8+((value_bytes+7)/8)*8);
+    TinyMAT_checkMatrixSize(size_bytes);
+    mat->addStructItemName(name);
+    if (logical) {
+        TinyMAT_beginVariable(mat, name, size_bytes+8, rowind, static_cast<uint64_t>(nnz)*4);
+    } else {
+        TinyMAT_beginVariable(mat, name, size_bytes+8, values, static_cast<uint64_t>(nnz)*sizeof(double));
+    }
+
+    uint32_t arrayflags[2]={static_cast<uint32_t>(logical?TINYMAT_mxSPARSE_LOGICAL_CLASS_arrayflags:TINYMAT_mxSPARSE_CLASS_arrayflags), nzmax};
+    const int32_t sizes[2]={rows, cols};
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(size_bytes));
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeDatElement_i32a(mat, sizes, 2);
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write row indices (ir), column pointers (jc) and values (pr)
+    const int32_t zero_index=0;
+    const double zero_value=0;
+    TinyMAT_writeDatElement_i32a(mat, (nnz>0)?rowind:&zero_index, nzmax);
+    TinyMAT_writeDatElement_i32a(mat, colptr, static_cast<size_t>(cols)+1);
+    if (logical) {
+        TinyMAT_writeDatElementLogical(mat, nzmax, [](uint8_t* dst, size_t, size_t count) { memset(dst, 1, count); });
+    } else {
+        TinyMAT_writeDatElement_dbla(mat, (nnz>0)?values:&zero_value, nzmax);
+    }
+    TinyMAT_endVariable(mat);
+}
+
+/*! \brief stable counting sort of the \a n entries of a sparse matrix by \a key (in 0...nkeys-1), used to convert CSR and COO matrices to CSC
+    \ingroup tinymatwriter
+    \internal
+
+    Entry \c k is moved to position \c p of the output: \c other_out[p]=other[k] and \c values_out[p]=values[k] (if \a values is not \c NULL ).
+    \a ptr receives the position of the first entry of each key (\a nkeys +1 values). Each thread counts the keys of one part of the entries and
+    then moves them behind the entries with the same key of the threads before, so the order of entries with the same key is preserved.
+
+    \return \c false if a key is out of range
+ */
+static bool TinyMAT_sortSparse(size_t n, const int32_t* key, int32_t nkeys, const int32_t* other, const double* values, int32_t* ptr, int32_t* other_out, double* values_out, int threads) {
+    // each thread needs counters for all keys, so there should be more entries than counters
+    threads=static_cast<int>(std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(threads), n/(static_cast<size_t>(nkeys)+1))));
+    std::vector<int32_t> next(static_cast<size_t>(threads)*nkeys, 0);
+    std::vector<char> bad(threads, 0);
+    TinyMAT_parallelRun(threads, [&](int t) {
+        int32_t* cnt=next.data()+static_cast<size_t>(t)*nkeys;
+        for (size_t k=n*t/threads; k<n*(t+1)/threads; k++) {
+            const int32_t c=key[k];
+            if (c<0 || c>=nkeys) {
+                bad[t]=1;
+                return;
+            }
+            cnt[c]++;
+        }
+    });
+    for (int t=0; t<threads; t++) {
+        if (bad[t]) return false;
+    }
+    // turn the counters into the next output position of each thread and key
+    int32_t pos=0;
+    for (int32_t c=0; c<nkeys; c++) {
+        ptr[c]=pos;
+        for (int t=0; t<threads; t++) {
+            int32_t& cnt=next[static_cast<size_t>(t)*nkeys+c];
+            const int32_t count=cnt;
+            cnt=pos;
+            pos+=count;
+        }
+    }
+    ptr[nkeys]=pos;
+    TinyMAT_parallelRun(threads, [&](int t) {
+        int32_t* dst=next.data()+static_cast<size_t>(t)*nkeys;
+        const size_t k1=n*(t+1)/threads;
+        if (values) {
+            for (size_t k=n*t/threads; k<k1; k++) {
+                const int32_t p=dst[key[k]]++;
+                other_out[p]=other[k];
+                values_out[p]=values[k];
+            }
+        } else {
+            for (size_t k=n*t/threads; k<k1; k++) {
+                other_out[dst[key[k]]++]=other[k];
+            }
+        }
+    });
+    return true;
+}
+
+/*! \brief writes the index of the row (or column) of each entry of a compressed sparse matrix with pointers \a ptr into \a out
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static void TinyMAT_expandSparsePointers(int32_t nptr, const int32_t* ptr, int32_t* out) {
+    for (int32_t r=0; r<nptr; r++) {
+        for (int32_t k=ptr[r]; k<ptr[r+1]; k++) out[k]=r;
+    }
+}
+
+void TinyMATWriter_writeSparseCSC(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* colptr, const int32_t* rowind, const double* values)
+{
+    TinyMAT_writeSparse(mat, name, rows, cols, colptr, rowind, values);
+}
+
+void TinyMATWriter_writeSparseCSR(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* rowptr, const int32_t* colind, const double* values)
+{
+    if (rows<0 || cols<0 || !rowptr || rowptr[0]!=0 || (rowptr[rows]>0 && !colind)) {
+        throw std::runtime_error("invalid size or row pointers of a sparse matrix");
+    }
+    for (int32_t r=0; r<rows; r++) {
+        if (rowptr[r+1]<rowptr[r]) throw std::runtime_error("the row pointers of a sparse matrix are not ascending");
+    }
+    const size_t nnz=static_cast<size_t>(rowptr[rows]);
+    std::unique_ptr<int32_t[]> rowof(new int32_t[nnz]);
+    TinyMAT_expandSparsePointers(rows, rowptr, rowof.get());
+    // the rows stay ascending within each column, as the sort is stable
+    std::unique_ptr<int32_t[]> colptr(new int32_t[static_cast<size_t>(cols)+1]);
+    std::unique_ptr<int32_t[]> rowind(new int32_t[nnz]);
+    std::unique_ptr<double[]> sorted(values?new double[nnz]:NULL);
+    const int threads=TinyMAT_transposeThreads(mat, static_cast<uint64_t>(nnz)*(values?16:8));
+    if (!TinyMAT_sortSparse(nnz, colind, cols, rowof.get(), values, colptr.get(), rowind.get(), sorted.get(), threads)) {
+        throw std::runtime_error("a column index of a sparse matrix is out of range");
+    }
+    TinyMAT_writeSparse(mat, name, rows, cols, colptr.get(), rowind.get(), sorted.get());
+}
+
+void TinyMATWriter_writeSparseCOO(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* rowind, const int32_t* colind, const double* values, size_t nnz)
+{
+    if (rows<0 || cols<0 || nnz>static_cast<size_t>(INT32_MAX) || (nnz>0 && (!rowind || !colind))) {
+        throw std::runtime_error("invalid size or indices of a sparse matrix");
+    }
+    const int threads=TinyMAT_transposeThreads(mat, static_cast<uint64_t>(nnz)*(values?16:8));
+    // sort by row and then by column, so the rows are ascending within each column
+    std::unique_ptr<int32_t[]> rowptr(new int32_t[static_cast<size_t>(rows)+1]);
+    std::unique_ptr<int32_t[]> bycol(new int32_t[nnz]);
+    std::unique_ptr<double[]> byrow_values(values?new double[nnz]:NULL);
+    if (!TinyMAT_sortSparse(nnz, rowind, rows, colind, values, rowptr.get(), bycol.get(), byrow_values.get(), threads)) {
+        throw std::runtime_error("a row index of a sparse matrix is out of range");
+    }
+    std::unique_ptr<int32_t[]> rowof(new int32_t[nnz]);
+    TinyMAT_expandSparsePointers(rows, rowptr.get(), rowof.get());
+    std::unique_ptr<int32_t[]> colptr(new int32_t[static_cast<size_t>(cols)+1]);
+    std::unique_ptr<int32_t[]> sorted_rows(new int32_t[nnz]);
+    std::unique_ptr<double[]> sorted_values(values?new double[nnz]:NULL);
+    if (!TinyMAT_sortSparse(nnz, bycol.get(), cols, rowof.get(), byrow_values.get(), colptr.get(), sorted_rows.get(), sorted_values.get(), threads)) {
+        throw std::runtime_error("a column index of a sparse matrix is out of range");
+    }
+    // sum the values of entries with the same coordinates, which are now next to each other
+    int32_t out=0;
+    for (int32_t c=0; c<cols; c++) {
+        const int32_t first=colptr[c];
+        const int32_t last=colptr[c+1];
+        colptr[c]=out;
+        for (int32_t k=first; k<last; k++) {
+            if (out>colptr[c] && sorted_rows[out-1]==sorted_rows[k]) {
+                if (values) sorted_values[out-1]+=sorted_values[k];
+            } else {
+                sorted_rows[out]=sorted_rows[k];
+                if (values) sorted_values[out]=sorted_values[k];
+                out++;
+            }
+        }
+    }
+    colptr[cols]=out;
+    TinyMAT_writeSparse(mat, name, rows, cols, colptr.get(), sorted_rows.get(), sorted_values.get());
+}
+
+
+TinyMATWriterFile* TinyMATWriter_open(const char* filename, const char* description, size_t bufSize) {
+    TinyMATWriterOptions options;
+    options.backend=TINYMAT_BACKEND_DEFAULT;
+    options.buffer_size=bufSize;
+    options.description=description;
+    return TinyMATWriter_openWithOptions(filename, &options);
+}
+
+TinyMATWriterFile* TinyMATWriter_openWithOptions(const char* filename, const TinyMATWriterOptions* options) {
+    TinyMATWriterOptions defaults;
+    if (!options) options=&defaults;
+    const char* description=options->description;
+    TinyMATWriterFile* mat=TinyMAT_fopen(filename, options);
+
+    if (TinyMATWriter_fOK(mat)) {
+        // setup and write Description field (116 bytes)
+        char stdmsg[512];
+        for (int i=0; i<512; i++) stdmsg[i]='\0';
+        time_t rawtime;
+        ::time(&rawtime);
+        struct tm * timeinfo;
+#ifdef HAVE_GMTIME_S
+        struct tm ti;
+        ::gmtime_s(&ti, &rawtime);
+        timeinfo=&ti;
+#else
+        timeinfo = ::gmtime(&rawtime);
+#endif
+#ifdef HAVE_SPRINTF_S
+        sprintf_s(stdmsg, 512,"MATLAB 5.0 MAT-file, written by TinyMAT, %d-%02d-%02d %02d:%02d:%02d UTC", 1900+timeinfo->tm_year, timeinfo->tm_mon+1, timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+#else
+        sprintf(stdmsg, "MATLAB 5.0 MAT-file, written by TinyMAT, %d-%02d-%02d %02d:%02d:%02d UTC", 1900+timeinfo->tm_year, timeinfo->tm_mon+1, timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+#endif
+        size_t slstd=strlen(stdmsg);
+        char desc[116];
+        size_t sl=0;
+        if (description) sl=strlen(description);
+        if (slstd>0) {
+            for (size_t i=0; i<slstd; i++) {
+                desc[i]=stdmsg[i];
+            }
+        }
+        size_t maxv=slstd;
+        if (sl>0) {
+            maxv=maxv+2+sl;
+        }
+        if (maxv>116) maxv=116;
+        if (sl>0) {
+            desc[slstd]=':';
+            desc[slstd+1]=' ';
+            for (size_t i=slstd+2; i<sl; i++) {
+                desc[i]=description[i];
+            }
+        }
+        if (maxv<116) {
+            desc[maxv]='\0';
+            for (size_t i=maxv+1; i<116; i++) {
+                desc[i]=' ';
+            }
+        } else {
+            desc[115]='\0';
+        }
+        TinyMAT_fwrite(desc, 1, 116,mat);
+        
+        // write "Header Subsystem Data Offset Field" (not used, i.e. write 00000000)
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(0x00000000));
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(0x00000000));
+        
+        // write "Header Flag Fields"
+        TinyMAT_writeU16(mat, static_cast<uint16_t>(0x0100)); // version
+        TinyMAT_write8(mat, (int8_t)'I'); // endian indicator
+        TinyMAT_write8(mat, (int8_t)'M');
+        return mat;
+    } else {
+        TinyMAT_fclose(mat);
+        return NULL;
+    }
+}
+
+TinyMATWriterFile* TinyMATWriter_openSink(TinyMATWriterSinkWriteFunction write, TinyMATWriterSinkPatchFunction patch, TinyMATWriterSinkFlushFunction flush, void* context, const char* description) {
+    if (!write) return NULL;
+    TinyMATWriterOptions options;
+    options.backend=TINYMAT_BACKEND_CUSTOM;
+    options.description=description;
+    options.sink.write=write;
+    options.sink.patch=patch;
+    options.sink.flush=flush;
+    options.sink.context=context;
+    return TinyMATWriter_openWithOptions(NULL, &options);
+}
+
+TinyMATWriterFile* TinyMATWriter_openMemory(const char* description, size_t bufSize) {
+    TinyMATWriterOptions options;
+    options.backend=TINYMAT_BACKEND_MEMORY;
+    options.buffer_size=bufSize;
+    options.description=description;
+    return TinyMATWriter_openWithOptions(NULL, &options);
+}
+
+int TinyMATWriter_flush(TinyMATWriterFile* mat) {
+    if (!TinyMAT_isOpen(mat)) return FALSE;
+    TinyMAT_flushCompression(mat);
+    if (mat->backend==TINYMAT_BACKEND_CUSTOM) {
+        return (!mat->sink.flush || mat->sink.flush(mat->sink.context));
+    } else if (mat->backend==TINYMAT_BACKEND_STDIO) {
+        return (fflush(mat->file)==0);
+    } else if (mat->backend==TINYMAT_BACKEND_MEMORY && mat->file) {
+        TinyMAT_flushMem(mat, 0);
+        return (fflush(mat->file)==0);
+#ifdef TINYMAT_HAS_MMAP
+    } else if (mat->backend==TINYMAT_BACKEND_MMAP && mat->filedata.data) {
+        return (msync(mat->filedata.data, mat->filedata.size, MS_ASYNC)==0);
+#endif
+    }
+    return TRUE;
+}
+
+int TinyMATWriter_setMemoryLimit(TinyMATWriterFile* mat, uint64_t limit) {
+    if (!mat || mat->backend!=TINYMAT_BACKEND_MEMORY || !mat->file) return FALSE;
+    mat->memory_limit=limit;
+    return TRUE;
+}
+
+int TinyMATWriter_backend(const TinyMATWriterFile* mat) {
+    if (!mat) return TINYMAT_BACKEND_AUTO;
+    return mat->backend;
+}
+
+#define TINYMAT_mxCELL_CLASS_arrayflags 0x00000001
+#define TINYMAT_mxSTRUCT_CLASS_arrayflags 0x00000002
+
+
+void TinyMATWriter_writeDoubleList(TinyMATWriterFile *mat, const char *name, const std::list<double> &data, bool columnVector)
+{
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat);
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxDOUBLE_CLASS_arrayflags, 0};
+
+
+    size_bytes+=16; // array flags
+    size_bytes+=16; // dimensions flags
+    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
+    size_bytes+=8+8*(uint32_t)data.size(); // actual data
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    if (columnVector) {
+        TinyMAT_writeU32(mat, (uint32_t)1);
+        TinyMAT_writeU32(mat, (uint32_t)data.size());
+    } else {
+        TinyMAT_writeU32(mat, (uint32_t)data.size());
+        TinyMAT_writeU32(mat, (uint32_t)1);
+    }
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    double * d=NULL;
+    if (data.size()>0) {
+        d=(double*)malloc(data.size()*sizeof(double));
+        int i=0;
+        for (std::list<double>::const_iterator it=data.begin(); it!=data.end(); it++) {
+            d[i]=*it;
+            i++;
+        }
+    }
+
+    // write data type
+    TinyMAT_writeDatElement_dbla(mat, d, (uint32_t)data.size());
+    if (d) free(d);
+    TinyMAT_endVariable(mat);
+}
+
+
+void TinyMATWriter_writeDoubleVector(TinyMATWriterFile *mat, const char *name, const std::vector<double> &data, bool columnVector)
+{
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat);
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxDOUBLE_CLASS_arrayflags, 0};
+
+
+    size_bytes+=16; // array flags
+    size_bytes+=16; // dimensions flags
+    size_bytes+=8+(uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
+    size_bytes+=8+8*(uint32_t)data.size(); // actual data
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    if (columnVector) {
+        TinyMAT_writeU32(mat, (uint32_t)1);
+        TinyMAT_writeU32(mat, (uint32_t)data.size());
+    } else {
+        TinyMAT_writeU32(mat, (uint32_t)data.size());
+        TinyMAT_writeU32(mat, (uint32_t)1);
+    }
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    double * d=NULL;
+    if (data.size()>0) {
+        d=(double*)malloc(data.size()*sizeof(double));
+        int i=0;
+        for (std::vector<double>::const_iterator it=data.begin(); it!=data.end(); it++) {
+            d[i]=*it;
+            i++;
+        }
+    }
+
+    // write data type
+    TinyMAT_writeDatElement_dbla(mat, d, (uint32_t)data.size());
+    if (d) free(d);
+    TinyMAT_endVariable(mat);
+}
+
+
+
+
+void TinyMATWriter_writeEmptyMatrix(TinyMATWriterFile *mat, const char *name)
+{
+
+  mat->addStructItemName(name);
+  TinyMAT_beginVariable(mat);
+  uint32_t size_bytes = 0;
+  uint32_t arrayflags[2] = { TINYMAT_mxDOUBLE_CLASS_arrayflags, 0 };
+
+
+  size_bytes += 16; // array flags
+  size_bytes += 16; // dimensions flags
+  size_bytes += 8 + (uint32_t)TinyMAT_DatElement_realstringlen8bit(name); // array name
+  size_bytes += 8 + 8 * 0; // actual data
+
+                           // write tag header
+  TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+  TinyMAT_writeU32(mat, size_bytes);
+
+  // write arrayflags
+  TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+  // write field dimensions
+  TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+  TinyMAT_writeU32(mat, (uint32_t)8);
+  TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+  TinyMAT_writeU32(mat, static_cast<uint32_t>(0));
+
+  // write field name
+  TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+  // write no-double-data element
+  TinyMAT_writeDatElement_dbla(mat, NULL, 0);
+
+  TinyMAT_endVariable(mat);
+}
+
+void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const char *data)
+{
+    TinyMATWriter_writeString(mat, name, data, (uint32_t)strlen(data));
+}
+
+
+void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const std::string &data)
+{
+    TinyMATWriter_writeString(mat, name, data.c_str(), (uint32_t)data.size());
+}
+
+void TinyMATWriter_writeString(TinyMATWriterFile *mat, const char *name, const char *data, uint32_t slen)
+{
+    mat->addStructItemName(name);
+    // number of MATLAB characters
+    const size_t units=TinyMAT_utf16Length(mat, data, slen);
+    const uint32_t size_bytes=static_cast<uint32_t>(TinyMAT_matrixContentSize(2, strlen(name), static_cast<uint64_t>(units)*2));
+    TinyMAT_beginVariable(mat, name, static_cast<uint64_t>(size_bytes)+8, data, slen);
+    uint32_t arrayflags[2];
+    arrayflags[0]=TINYMAT_mxCHAR_CLASS_CLASS_arrayflags;
+    arrayflags[1]=0;
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    TinyMAT_writeU32(mat, 1);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(units));
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+
+    // write data type
+    TinyMAT_writeDatElement_string(mat, data, slen, units);
+    TinyMAT_endVariable(mat);
+}
+
+
+
+
+
+/*! \brief completes all open structs and cell arrays and all pending compressions, so the file is complete
+    \ingroup tinymatwriter
+    \internal
+ */
+static void TinyMAT_finish(TinyMATWriterFile* mat) {
+    while (mat->stack.size()>0) {
+        if (mat->stack[mat->stack.size()-1]==TinyMATWriterStackItem::Struct) {
+            TinyMATWriter_endStruct(mat);
+        } else {
+            TinyMATWriter_endCellArray(mat);
+        }
+    }
+    TinyMAT_flushCompression(mat);
+}
+
+void TinyMATWriter_close(TinyMATWriterFile* mat) {
+    if (mat) {
+        TinyMAT_finish(mat);
+        if (mat) TinyMAT_fclose(mat);
+    }
+}
+
+int TinyMATWriter_closeAndTakeBuffer(TinyMATWriterFile* mat, uint8_t** data, size_t* size) {
+    if (data) *data=NULL;
+    if (size) *size=0;
+    if (!mat) return FALSE;
+    TinyMAT_finish(mat);
+    if (mat->backend!=TINYMAT_BACKEND_MEMORY || mat->flushed>0 || !data || !size) {
+        TinyMAT_fclose(mat);
+        return FALSE;
+    }
+    TinyMAT_resolveReferences(mat->filedata);
+    if (mat->file && mat->filedata.count>0) {
+        fseek(mat->file, 0, SEEK_SET);
+        fwrite(mat->filedata.data, 1, mat->filedata.count, mat->file);
+    }
+    *data=mat->filedata.data;
+    *size=mat->filedata.count;
+    mat->filedata=TinyMATWriterBuffer();
+    TinyMAT_fclose(mat);
+    return TRUE;
+}
+
+void TinyMATWriter_freeBuffer(uint8_t* data) {
+    if (data) free(data);
+}
+
+int TinyMATWriter_setCompression(TinyMATWriterFile* mat, int level) {
+    if (!mat) return FALSE;
+    mat->compression_level=std::min<int>(std::max<int>(level, TINYMAT_COMPRESSION_NONE), TINYMAT_COMPRESSION_BEST);
+#ifdef TINYMAT_USES_ZLIB
+    return TRUE;
+#else
+    return (level<=TINYMAT_COMPRESSION_NONE);
+#endif
+}
+
+int TinyMATWriter_setNextCompression(TinyMATWriterFile* mat, int level) {
+    if (!mat) return FALSE;
+    mat->next_compression_level=std::min<int>(std::max<int>(level, TINYMAT_COMPRESSION_NONE), TINYMAT_COMPRESSION_BEST);
+#ifdef TINYMAT_USES_ZLIB
+    return TRUE;
+#else
+    return (level<=TINYMAT_COMPRESSION_NONE);
+#endif
+}
+
+int TinyMATWriter_setCompressionStreaming(TinyMATWriterFile* mat, uint64_t threshold) {
+    if (!mat) return FALSE;
+    mat->streaming_threshold=threshold;
+#ifdef TINYMAT_USES_ZLIB
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+int TinyMATWriter_setCompressionThreads(TinyMATWriterFile* mat, int threads) {
+    if (!mat) return FALSE;
+#if defined(TINYMAT_USES_ZLIB) && !defined(TINYMAT_NO_THREADS)
+    if (threads==TINYMAT_COMPRESSION_THREADS_AUTO) {
+        threads=static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (mat->compression_pool) {
+        if (threads>1 && mat->compression_pool->threads.size()==static_cast<size_t>(threads)) return TRUE;
+        TinyMAT_flushCompression(mat);
+        delete mat->compression_pool;
+        mat->compression_pool=NULL;
+    }
+    if (threads>1) {
+        mat->compression_pool=new TinyMATWriterCompressionPool(threads);
+    }
+    return TRUE;
+#else
+    return (threads==0 || threads==1);
+#endif
+}
+
+/*! \brief returns a modifiable copy of the compression policy of \a mat, which has to be installed with TinyMAT_setPolicy()
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static TinyMATWriterCompressionPolicy TinyMAT_copyPolicy(const TinyMATWriterFile* mat) {
+    if (mat->compression_policy) return *(mat->compression_policy);
+    return TinyMATWriterCompressionPolicy();
+}
+
+TINYMAT_inlineattrib static void TinyMAT_setPolicy(TinyMATWriterFile* mat, const TinyMATWriterCompressionPolicy& policy) {
+    mat->compression_policy=std::make_shared<const TinyMATWriterCompressionPolicy>(policy);
+}
+
+int TinyMATWriter_setAdaptiveCompression(TinyMATWriterFile* mat, int enabled) {
+    if (!mat) return FALSE;
+    TinyMATWriterCompressionPolicy policy=TinyMAT_copyPolicy(mat);
+    policy.adaptive=(enabled!=FALSE);
+    TinyMAT_setPolicy(mat, policy);
+#ifdef TINYMAT_USES_ZLIB
+    return TRUE;
+#else
+    return (enabled==FALSE);
+#endif
+}
+
+int TinyMATWriter_setAdaptiveCompressionThresholds(TinyMATWriterFile* mat, uint64_t min_size, double raw_ratio, double fast_ratio, size_t sample_size) {
+    if (!mat || raw_ratio<fast_ratio || sample_size<=0) return FALSE;
+    TinyMATWriterCompressionPolicy policy=TinyMAT_copyPolicy(mat);
+    policy.min_size=min_size;
+    policy.raw_ratio=raw_ratio;
+    policy.fast_ratio=fast_ratio;
+    policy.sample_size=sample_size;
+    TinyMAT_setPolicy(mat, policy);
+    return TRUE;
+}
+
+int TinyMATWriter_addCompressionRule(TinyMATWriterFile* mat, const char* pattern, int level) {
+    if (!mat || !pattern) return FALSE;
+    TinyMATWriterCompressionPolicy policy=TinyMAT_copyPolicy(mat);
+    TinyMATWriterCompressionRule rule;
+    rule.pattern=pattern;
+    rule.level=std::min<int>(std::max<int>(level, TINYMAT_COMPRESSION_NONE), TINYMAT_COMPRESSION_BEST);
+    policy.rules.push_back(rule);
+    TinyMAT_setPolicy(mat, policy);
+#ifdef TINYMAT_USES_ZLIB
+    return TRUE;
+#else
+    return (level<=TINYMAT_COMPRESSION_NONE);
+#endif
+}
+
+void TinyMATWriter_clearCompressionRules(TinyMATWriterFile* mat) {
+    if (!mat) return;
+    TinyMATWriterCompressionPolicy policy=TinyMAT_copyPolicy(mat);
+    policy.rules.clear();
+    TinyMAT_setPolicy(mat, policy);
+}
+
+void TinyMATWriter_setCompressionReport(TinyMATWriterFile* mat, TinyMATWriterCompressionReportFunction report, void* userdata) {
+    if (!mat) return;
+    mat->compression_report=report;
+    mat->compression_report_userdata=userdata;
+}
+
+std::string TinyMAT_combineStrings(const std::vector<std::string>& fieldnames, int32_t* maxlen_out=NULL, int32_t minlen=32) {
+    std::vector<std::string> names;
+    int32_t maxlen=0;
+    for (auto i = fieldnames.begin(); i != fieldnames.end(); ++i) {
+        std::string ni=*i;
+        while (static_cast<int32_t>(ni.size())>(minlen-1)) {
+            ni.erase(ni.size()-1, 1);
+        }
+        if ((int32_t)ni.size()>maxlen) maxlen=(int32_t)ni.size();
+        names.push_back(ni);
+    }
+    if (maxlen<minlen) maxlen=minlen;
+    // pad all field names to maxlen
+    std::string joinednames;
+    for (size_t ii=0; ii<names.size(); ii++) {
+        while ((int64_t)names[ii].size()<maxlen) {
+            names[ii].push_back('\0');
+        }
+        joinednames.append(names[ii]);
+    }
+    if (maxlen_out) *maxlen_out=maxlen;
+    return joinednames;
+}
+
+
+
+void TinyMATWriter_startStruct(TinyMATWriterFile *mat, const char *name) {
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat, true);
+    mat->startStruct();
+
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
+    
+
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    mat->lastStruct().sizepos=TinyMAT_ftell(mat);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    TinyMAT_write32(mat, (int32_t)1);
+    TinyMAT_write32(mat, (int32_t)1);
+
+    // write struct name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    mat->lastStruct().data_start=TinyMAT_ftell(mat);
+}
+
+
+void TinyMATWriter_endStruct(TinyMATWriterFile* mat) {
+    /*
+        The field names of the struct have to be put into the file BEFORE the actual data, but they are only known now,
+        as the API collects them internally in the uppermost TinyMATWriterStruct item in the structures-stack of TinyMATWriterFile.
+        The output always goes into a memory buffer (structs and cell arrays are staged on the other backends, see
+        TinyMAT_beginVariable() ), so the field names are inserted as a separate block in front of the data
+        (see TinyMAT_insertMem() ) and the data is never moved.
+    */
+    TinyMATWriterStruct& struc=mat->lastStruct();
+
+    int32_t maxlen=0;
+    std::string joinednames=TinyMAT_combineStrings(struc.itemnames, &maxlen);
+
+    TinyMATWriterBuffer* mem=TinyMAT_activeMem(mat);
+    // field name length and field names, as written by TinyMAT_writeDatElementS_i32() and TinyMAT_writeDatElement_stringas8bit()
+    const uint32_t nameslen=static_cast<uint32_t>(joinednames.size());
+    const size_t namespadded=(nameslen+7)/8*8;
+    std::shared_ptr<std::vector<uint8_t> > header=std::make_shared<std::vector<uint8_t> >(16+namespadded, 0);
+    const uint16_t lentag[2]={static_cast<uint16_t>(TINYMAT_miINT32), static_cast<uint16_t>(sizeof(maxlen))};
+    const uint32_t namestag[2]={static_cast<uint32_t>(TINYMAT_miINT8), nameslen};
+    memcpy(header->data(), lentag, 4);
+    memcpy(header->data()+4, &maxlen, 4);
+    memcpy(header->data()+8, namestag, 8);
+    if (nameslen>0) memcpy(header->data()+16, joinednames.data(), nameslen);
+    else header->resize(16);
+    const uint64_t flushed=(mem==&(mat->filedata))?mat->flushed:0;
+    TinyMAT_insertMem(mem, static_cast<uint64_t>(struc.data_start)-flushed, header);
+
+
+    long endpos=TinyMAT_ftell(mat);
+    TinyMAT_fseek(mat, struc.sizepos);
+    uint32_t size_bytes=endpos-struc.sizepos-4;
+    TinyMAT_writeU32(mat, size_bytes);
+    TinyMAT_fseek(mat, endpos);
+    mat->endStruct();
+    TinyMAT_endVariable(mat);
+}
+
+
+void TinyMATWriter_writeStruct(TinyMATWriterFile *mat, const char *name, const std::map<std::string, double> &data)
+{
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat);
+    mat->startStruct();
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
+    std::map<std::string, double>::const_iterator i;
+    std::vector<std::string> names;
+    int32_t maxlen=0;
+    for (i = data.begin(); i != data.end(); ++i) {
+        std::string ni=i->first;
+        while (ni.size()>31) {
+            ni.erase(ni.size()-1, 1);
+        }
+        if ((int32_t)ni.size()>maxlen) maxlen=(int32_t)ni.size();
+        names.push_back(ni);
+    }
+    if (maxlen<32) maxlen=32;
+    // pad all field names to maxlen
+    std::string joinednames;
+    for (size_t ii=0; ii<names.size(); ii++) {
+        while ((int64_t)names[ii].size()<maxlen) {
+            names[ii].push_back('\0');
+        }
+        joinednames.append(names[ii]);
+    }
+
+
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    long sizepos;
+    sizepos=TinyMAT_ftell(mat);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    TinyMAT_write32(mat, (int32_t)1);
+    TinyMAT_write32(mat, (int32_t)1);
+
+    // write struct name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write field name length
+    TinyMAT_writeDatElementS_i32(mat, maxlen);
+
+    // write field names
+    TinyMAT_writeDatElement_stringas8bit(mat, joinednames.c_str(), (uint32_t)joinednames.size());
+
+    // write data type
+    for (i = data.begin(); i != data.end(); ++i) {
+        double v=i->second;
+        TinyMATWriter_writeMatrix2D_colmajor(mat, "", &v, 1, 1);
+    }
+
+    long endpos;
+    endpos=TinyMAT_ftell(mat);
+    TinyMAT_fseek(mat, sizepos);
+    size_bytes=endpos-sizepos-4;
+    TinyMAT_writeU32(mat, size_bytes);
+    TinyMAT_fseek(mat, endpos);
+    mat->endStruct();
+    TinyMAT_endVariable(mat);
+}
+
+/*! \brief collects the small elements of a struct array and writes them in bulk (see TinyMATWriter_writeStructArray() )
+    \ingroup tinymatwriter
+    \internal
+
+    If the output goes into a memory buffer, all elements are reserved at once with TinyMAT_reserveMem() and filled directly,
+    otherwise they are collected in a block, which is written, whenever it is full.
+ */
+struct TinyMATWriterBulk {
+    inline TinyMATWriterBulk(TinyMATWriterFile* mat_, uint64_t total) :
+      mat(mat_),
+      dst(TinyMAT_reserveMem(mat_, static_cast<size_t>(total))),
+      pos(0),
+      capacity(static_cast<size_t>(total))
+    {
+        if (!dst) {
+            block.reset(new uint64_t[TINYMAT_BULK_BLOCK_SIZE/sizeof(uint64_t)]);
+            dst=reinterpret_cast<uint8_t*>(block.get());
+            capacity=TINYMAT_BULK_BLOCK_SIZE;
+        }
+    }
+
+    /** \brief returns memory for the next \a bytes bytes of output, or NULL if they do not fit into the block, then they have to be written with TinyMAT_fwrite() after flush() */
+    inline uint8_t* claim(size_t bytes) {
+        if (pos+bytes>capacity) {
+            if (!block || bytes>capacity) return NULL;
+            flush();
+        }
+        uint8_t* res=dst+pos;
+        pos+=bytes;
+        return res;
+    }
+
+    /** \brief writes the collected output (only if it is collected in a block) */
+    inline void flush() {
+        if (block && pos>0) TinyMAT_fwrite(dst, 1, static_cast<uint32_t>(pos), mat);
+        if (block) pos=0;
+    }
+
+    TinyMATWriterFile* mat;
+    uint8_t* dst;
+    size_t pos;
+    size_t capacity;
+    std::unique_ptr<uint64_t[]> block;
+};
+
+/*! \brief writes the tag, array flags, dimensions {1, \a cols } and the empty name of a struct array field into \a p (48 bytes) and returns the position behind them
+    \ingroup tinymatwriter
+    \internal
+ */
+TINYMAT_inlineattrib static uint8_t* TinyMAT_putFieldHeader(uint8_t* p, uint32_t size_bytes, uint32_t classflags, uint32_t cols) {
+    const uint32_t header[12]={TINYMAT_miMATRIX, size_bytes,
+                               TINYMAT_miUINT32, 8, classflags, 0,
+                               TINYMAT_miINT32, 8, 1, cols,
+                               TINYMAT_miINT8, 0};
+    memcpy(p, header, sizeof(header));
+    return p+sizeof(header);
+}
+
+/*! \brief a field of TinyMATWriter_writeStructArray() (or the elements of TinyMATWriter_writeRaggedCellArray() ) with its storage class
+    \ingroup tinymatwriter
+    \internal
+ */
+struct TinyMATWriterStructColumn {
+    const TinyMATWriterStructField* field;
+    uint32_t classflags;
+    uint32_t datatype;
+    /** \brief size of one value in bytes */
+    size_t value_size;
+    /** \brief size of the miMATRIX element of one struct array element (with tag), not used for strings */
+    uint64_t element_size;
+    /** \brief for strings: length in bytes and UTF-16 code units of the string of each element */
+    std::vector<std::pair<uint32_t, uint32_t> > strings;
+};
+
+/*! \brief sets the class, data type and value size of \a c for the field type \a type ( \c TINYMAT_FIELD_DOUBLE ... )
+    \ingroup tinymatwriter
+    \internal
+    \return \c false, if \a type is unknown
+ */
+TINYMAT_inlineattrib static bool TinyMAT_fieldStorage(int type, TinyMATWriterStructColumn& c) {
+    switch (type) {
+        case TINYMAT_FIELD_DOUBLE: c.classflags=TINYMAT_mxDOUBLE_CLASS_arrayflags; c.datatype=TINYMAT_miDOUBLE; c.value_size=sizeof(double); break;
+        case TINYMAT_FIELD_SINGLE: c.classflags=TINYMAT_mxSINGLE_CLASS_arrayflags; c.datatype=TINYMAT_miSINGLE; c.value_size=sizeof(float); break;
+        case TINYMAT_FIELD_INT8: c.classflags=TINYMAT_mxINT8_CLASS_arrayflags; c.datatype=TINYMAT_miINT8; c.value_size=1; break;
+        case TINYMAT_FIELD_UINT8: c.classflags=TINYMAT_mxUINT8_CLASS_arrayflags; c.datatype=TINYMAT_miUINT8; c.value_size=1; break;
+        case TINYMAT_FIELD_INT16: c.classflags=TINYMAT_mxINT16_CLASS_arrayflags; c.datatype=TINYMAT_miINT16; c.value_size=2; break;
+        case TINYMAT_FIELD_UINT16: c.classflags=TINYMAT_mxUINT16_CLASS_arrayflags; c.datatype=TINYMAT_miUINT16; c.value_size=2; break;
+        case TINYMAT_FIELD_INT32: c.classflags=TINYMAT_mxINT32_CLASS_arrayflags; c.datatype=TINYMAT_miINT32; c.value_size=4; break;
+        case TINYMAT_FIELD_UINT32: c.classflags=TINYMAT_mxUINT32_CLASS_arrayflags; c.datatype=TINYMAT_miUINT32; c.value_size=4; break;
+        case TINYMAT_FIELD_INT64: c.classflags=TINYMAT_mxINT64_CLASS_arrayflags; c.datatype=TINYMAT_miINT64; c.value_size=8; break;
+        case TINYMAT_FIELD_UINT64: c.classflags=TINYMAT_mxUINT64_CLASS_arrayflags; c.datatype=TINYMAT_miUINT64; c.value_size=8; break;
+        case TINYMAT_FIELD_LOGICAL: c.classflags=TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags; c.datatype=TINYMAT_miINT8; c.value_size=sizeof(bool); break;
+        case TINYMAT_FIELD_STRING: c.classflags=TINYMAT_mxCHAR_CLASS_CLASS_arrayflags; c.datatype=TINYMAT_miUINT16; c.value_size=2; break;
+        default: return false;
+    }
+    return true;
+}
+
+/*! \brief writes an unnamed 1 x \a count array with the \a values in the storage class of \a c (not for strings) through \a bulk
+    \ingroup tinymatwriter
+    \internal
+
+    If the array does not fit into the block of \a bulk, only its header is collected and the values are written directly.
+ */
+TINYMAT_inlineattrib static void TinyMAT_writeBulkRow(TinyMATWriterBulk& bulk, const TinyMATWriterStructColumn& c, const uint8_t* values, uint32_t count) {
+    // logical values are stored as one byte each
+    const bool logical=(c.classflags==TINYMAT_mxUINT8_LOGICAL_CLASS_arrayflags);
+    const uint32_t used=static_cast<uint32_t>(count*(logical?1:c.value_size));
+    const uint32_t bytes=((used+7)/8)*8;
+    const size_t element_size=48+8+static_cast<size_t>(bytes);
+    uint8_t* p=bulk.claim(element_size);
+    if (p) {
+        p=TinyMAT_putFieldHeader(p, static_cast<uint32_t>(element_size-8), c.classflags, count);
+        const uint32_t tag[2]={c.datatype, used};
+        memcpy(p, tag, 8);
+        if (logical) {
+            TinyMAT_boolToBytes(p+8, reinterpret_cast<const bool*>(values), count);
+        } else if (used>0) {
+            memcpy(p+8, values, used);
+        }
+        memset(p+8+used, 0, bytes-used);
+    } else {
+        TinyMAT_putFieldHeader(bulk.claim(48), static_cast<uint32_t>(element_size-8), c.classflags, count);
+        bulk.flush();
+        if (logical) {
+            TinyMAT_writeDatElement_logical(bulk.mat, reinterpret_cast<const bool*>(values), count);
+        } else {
+            const uint32_t tag[2]={c.datatype, used};
+            TinyMAT_fwrite(tag, 1, 8, bulk.mat);
+            TinyMAT_fwrite(values, 1, used, bulk.mat);
+            const uint64_t zero=0;
+            if (bytes>used) TinyMAT_fwrite(&zero, 1, bytes-used, bulk.mat);
+        }
+    }
+}
+
+void TinyMATWriter_writeStructArray(TinyMATWriterFile* mat, const char* name, const int32_t* sizes, uint32_t ndims, const TinyMATWriterStructField* fields, uint32_t nfields)
+{
+    if (!sizes || ndims<=0) {
+        TinyMATWriter_writeEmptyMatrix(mat, name);
+        return;
+    }
+    size_t nel=1;
+    for (uint32_t i=0; i<ndims; i++) nel=nel*static_cast<size_t>(sizes[i]);
+
+    // storage class and size of each field, the largest numeric column decides about adaptive compression
+    std::vector<TinyMATWriterStructColumn> cols(nfields);
+    std::vector<std::string> names(nfields);
+    uint64_t data_bytes=0;
+    const void* payload=NULL;
+    uint64_t payload_bytes=0;
+    for (uint32_t f=0; f<nfields; f++) {
+        TinyMATWriterStructColumn& c=cols[f];
+        c.field=&(fields[f]);
+        names[f]=fields[f].name?fields[f].name:"";
+        if (!TinyMAT_fieldStorage(fields[f].type, c)) throw std::runtime_error("unknown type of a struct array field");
+        if (!fields[f].data && nel>0 && (fields[f].count>0 || fields[f].type==TINYMAT_FIELD_STRING)) {
+            throw std::runtime_error("a field of the struct array has no data");
+        }
+        if (fields[f].type==TINYMAT_FIELD_STRING) {
+            const char* const* strs=static_cast<const char* const*>(fields[f].data);
+            c.strings.resize(nel);
+            for (size_t i=0; i<nel; i++) {
+                const char* str=strs[i]?strs[i]:"";
+                const uint32_t slen=static_cast<uint32_t>(strlen(str));
+                const uint32_t units=static_cast<uint32_t>(TinyMAT_utf16Length(mat, str, slen));
+                c.strings[i]=std::make_pair(slen, units);
+                data_bytes+=8+TinyMAT_matrixContentSize(2, 0, static_cast<uint64_t>(units)*2);
+            }
+        } else {
+            // logical values are stored as one byte each
+            const uint64_t bytes=static_cast<uint64_t>(fields[f].count)*((fields[f].type==TINYMAT_FIELD_LOGICAL)?1:c.value_size);
+            c.element_size=8+TinyMAT_matrixContentSize(2, 0, bytes);
+            data_bytes+=c.element_size*nel;
+            if (bytes*nel>payload_bytes) {
+                payload=fields[f].data;
+                payload_bytes=bytes*nel;
+            }
+        }
+    }
+    int32_t maxlen=0;
+    const std::string joinednames=TinyMAT_combineStrings(names, &maxlen);
+    const size_t namelen=strlen(name);
+    const uint64_t size_bytes=16 + (8+((static_cast<uint64_t>(ndims)*4+7)/8)*8) + (8+((namelen+7)/8)*8)
+                              + 8 + (8+((joinednames.size()+7)/8)*8) + data_bytes;
+    TinyMAT_checkMatrixSize(size_bytes);
+
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat, name, size_bytes+8, payload, payload_bytes);
+
+    uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(size_bytes));
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+    // write struct name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write field name length
+    TinyMAT_writeDatElementS_i32(mat, maxlen);
+
+    // write field names
+    TinyMAT_writeDatElement_stringas8bit(mat, joinednames.c_str(), (uint32_t)joinednames.size());
+
+    // write the fields of all elements
+    const bool utf8=(mat->string_encoding==TINYMAT_STRING_ENCODING_UTF8);
+    TinyMATWriterBulk bulk(mat, data_bytes);
+    for (size_t i=0; i<nel; i++) {
+        for (uint32_t f=0; f<nfields; f++) {
+            const TinyMATWriterStructColumn& c=cols[f];
+            if (c.field->type==TINYMAT_FIELD_STRING) {
+                const char* str=static_cast<const char* const*>(c.field->data)[i];
+                const uint32_t slen=c.strings[i].first;
+                const uint32_t units=c.strings[i].second;
+                const uint64_t content=TinyMAT_matrixContentSize(2, 0, static_cast<uint64_t>(units)*2);
+                uint8_t* p=bulk.claim(static_cast<size_t>(content)+8);
+                if (p) {
+                    p=TinyMAT_putFieldHeader(p, static_cast<uint32_t>(content), c.classflags, units);
+                    const uint32_t tag[2]={TINYMAT_miUINT16, units*2};
+                    memcpy(p, tag, 8);
+                    size_t spos=0;
+                    TinyMAT_encodeUTF16(reinterpret_cast<uint16_t*>(p+8), units, reinterpret_cast<const uint8_t*>(str), slen, spos, utf8);
+                    const size_t padded=((static_cast<size_t>(units)*2+7)/8)*8;
+                    memset(p+8+units*2, 0, padded-units*2);
+                } else {
+                    TinyMAT_putFieldHeader(bulk.claim(48), static_cast<uint32_t>(content), c.classflags, units);
+                    bulk.flush();
+                    TinyMAT_writeDatElement_string(mat, str, slen, units);
+                }
+                continue;
+            }
+            const uint32_t count=c.field->count;
+            TinyMAT_writeBulkRow(bulk, c, static_cast<const uint8_t*>(c.field->data)+static_cast<size_t>(i)*count*c.value_size, count);
+        }
+    }
+    bulk.flush();
+    TinyMAT_endVariable(mat);
+}
+
+/*! \brief writes a cell array with \a nel elements, which are 1 x n arrays of the field type \a type ( \c TINYMAT_FIELD_DOUBLE ... )
+    \ingroup tinymatwriter
+    \internal
+
+    \a element(i, count) returns the values of element \c i and sets \a count to their number. All sizes are computed first,
+    so the miMATRIX elements of the cell array and of its elements are written with their final sizes and in bulk (see TinyMATWriterBulk ).
+ */
+template <typename TElement>
+static void TinyMAT_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const int32_t* sizes, uint32_t ndims, int type, size_t nel, TElement element)
+{
+    TinyMATWriterStructColumn c;
+    if (type==TINYMAT_FIELD_STRING || !TinyMAT_fieldStorage(type, c)) throw std::runtime_error("unknown type of the elements of a ragged cell array");
+    const size_t stored_size=(type==TINYMAT_FIELD_LOGICAL)?1:c.value_size;
+
+    // the largest element decides about adaptive compression
+    uint64_t data_bytes=0;
+    const void* payload=NULL;
+    uint64_t payload_bytes=0;
+    for (size_t i=0; i<nel; i++) {
+        uint32_t count=0;
+        const uint8_t* values=element(i, count);
+        const uint64_t bytes=static_cast<uint64_t>(count)*stored_size;
+        data_bytes+=8+TinyMAT_matrixContentSize(2, 0, bytes);
+        if (bytes>payload_bytes) {
+            payload=values;
+            payload_bytes=bytes;
+        }
+    }
+    const size_t namelen=strlen(name);
+    const uint64_t size_bytes=16 + (8+((static_cast<uint64_t>(ndims)*4+7)/8)*8) + (8+((namelen+7)/8)*8) + data_bytes;
+    TinyMAT_checkMatrixSize(size_bytes);
+
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat, name, size_bytes+8, payload, payload_bytes);
+
+    uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(size_bytes));
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+    // write cell array name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write the elements
+    TinyMATWriterBulk bulk(mat, data_bytes);
+    for (size_t i=0; i<nel; i++) {
+        uint32_t count=0;
+        const uint8_t* values=element(i, count);
+        TinyMAT_writeBulkRow(bulk, c, values, count);
+    }
+    bulk.flush();
+    TinyMAT_endVariable(mat);
+}
+
+void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const int32_t* sizes, uint32_t ndims, const void* values, const uint64_t* offsets, int type)
+{
+    if (!sizes || ndims<=0 || !offsets) {
+        TinyMATWriter_writeEmptyMatrix(mat, name);
+        return;
+    }
+    size_t nel=1;
+    for (uint32_t i=0; i<ndims; i++) nel=nel*static_cast<size_t>(sizes[i]);
+    for (size_t i=0; i<nel; i++) {
+        if (offsets[i+1]<offsets[i]) throw std::runtime_error("the offsets of a ragged cell array have to be increasing");
+        if (offsets[i+1]-offsets[i]>static_cast<uint64_t>(INT32_MAX)) throw std::runtime_error("an element of a ragged cell array is too large");
+    }
+    if (!values && offsets[nel]>offsets[0]) throw std::runtime_error("a ragged cell array has no values");
+    TinyMATWriterStructColumn c;
+    const size_t value_size=TinyMAT_fieldStorage(type, c)?c.value_size:0;
+    const uint8_t* bytes=static_cast<const uint8_t*>(values);
+    TinyMAT_writeRaggedCellArray(mat, name, sizes, ndims, type, nel, [bytes, offsets, value_size](size_t i, uint32_t& count) {
+        count=static_cast<uint32_t>(offsets[i+1]-offsets[i]);
+        return bytes+offsets[i]*value_size;
+    });
+}
+
+/*! \brief implements the overloads of TinyMATWriter_writeRaggedCellArray() for vectors of vectors
+    \ingroup tinymatwriter
+    \internal
+ */
+template <typename T>
+static void TinyMAT_writeRaggedCellArrayVectors(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<T> >& data, int type)
+{
+    for (size_t i=0; i<data.size(); i++) {
+        if (data[i].size()>static_cast<size_t>(INT32_MAX)) throw std::runtime_error("an element of a ragged cell array is too large");
+    }
+    const int32_t sizes[2]={1, static_cast<int32_t>(data.size())};
+    TinyMAT_writeRaggedCellArray(mat, name, sizes, 2, type, data.size(), [&data](size_t i, uint32_t& count) {
+        count=static_cast<uint32_t>(data[i].size());
+        return reinterpret_cast<const uint8_t*>(data[i].data());
+    });
+}
+
+void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<double> >& data)
+{
+    TinyMAT_writeRaggedCellArrayVectors(mat, name, data, TINYMAT_FIELD_DOUBLE);
+}
+
+void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<float> >& data)
+{
+    TinyMAT_writeRaggedCellArrayVectors(mat, name, data, TINYMAT_FIELD_SINGLE);
+}
+
+void TinyMATWriter_startCellArray(TinyMATWriterFile * mat, const char * name, const int32_t * sizes, uint32_t ndims)
+{
+  mat->addStructItemName(name);
+  // the cells may be structs, which insert their field names
+  TinyMAT_beginVariable(mat, true);
+  mat->startCell();
+
+  uint32_t size_bytes = 0;
+  uint32_t arrayflags[2] = { TINYMAT_mxCELL_CLASS_arrayflags, 0 };
+
+
+  // write tag header
+  TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+  mat->lastCell().sizepos = TinyMAT_ftell(mat);
+  TinyMAT_writeU32(mat, size_bytes);
+
+  // write arrayflags
+  TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+  // write field dimensions
+  TinyMAT_writeDatElement_i32a(mat, sizes, ndims);
+
+  // write struct name
+  TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+  mat->lastCell().data_start = TinyMAT_ftell(mat);
+
+
+}
+
+void TinyMATWriter_endCellArray(TinyMATWriterFile * mat)
+{
+  TinyMATWriterCell& cell = mat->lastCell();
+
+  long endpos = TinyMAT_ftell(mat);
+  TinyMAT_fseek(mat, cell.sizepos);
+  uint32_t size_bytes = endpos - cell.sizepos - 4;
+  TinyMAT_writeU32(mat, size_bytes);
+  TinyMAT_fseek(mat, endpos);
+
+  mat->endCell();
+  TinyMAT_endVariable(mat);
+}
+
+
+void TinyMATWriter_writeStringList(TinyMATWriterFile *mat, const char *name, const std::list<std::string> &data)
+{
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat);
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    long sizepos=TinyMAT_ftell(mat);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    TinyMAT_write32(mat, (int32_t)1);
+    TinyMAT_write32(mat, (int32_t)data.size());
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write data type
+    for (std::list<std::string>::const_iterator it=data.begin(); it!=data.end(); it++) {
+        TinyMATWriter_writeString(mat, "", it->c_str(), (uint32_t)it->size());
+    }
+
+    long endpos=TinyMAT_ftell(mat);
+    TinyMAT_fseek(mat, sizepos);
+    size_bytes=endpos-sizepos-4;
+    TinyMAT_writeU32(mat, size_bytes);
+    TinyMAT_fseek(mat, endpos);
+    TinyMAT_endVariable(mat);
+}
+
+
+void TinyMATWriter_writeStringVector(TinyMATWriterFile *mat, const char *name, const std::vector<std::string> &data)
+{
+    mat->addStructItemName(name);
+    TinyMAT_beginVariable(mat);
+    uint32_t size_bytes=0;
+    uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+    // write tag header
+    TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+    long sizepos=TinyMAT_ftell(mat);
+    TinyMAT_writeU32(mat, size_bytes);
+
+    // write arrayflags
+    TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+    // write field dimensions
+    TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+    TinyMAT_writeU32(mat, (uint32_t)8);
+    TinyMAT_write32(mat, (int32_t)1);
+    TinyMAT_write32(mat, (int32_t)data.size());
+
+    // write field name
+    TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+    // write data type
+    for (std::vector<std::string>::const_iterator it=data.begin(); it!=data.end(); it++) {
+        TinyMATWriter_writeString(mat, "", it->c_str(), (uint32_t)it->size());
+    }
+
+    long endpos=TinyMAT_ftell(mat);
+    TinyMAT_fseek(mat, sizepos);
+    size_bytes=endpos-sizepos-4;
+    TinyMAT_writeU32(mat, size_bytes);
+    TinyMAT_fseek(mat, endpos);
+    TinyMAT_endVariable(mat);
+}
+
+
+#ifdef TINYMAT_USES_QVARIANT
+    /*! \brief encodes \a str for TinyMATWriter_writeString(): as UTF-8, or as Latin-1 for \c TINYMAT_STRING_ENCODING_LATIN1 (see TinyMATWriter_setStringEncoding() )
+        \ingroup tinymatwriter
+        \internal
+     */
+    TINYMAT_inlineattrib static QByteArray TinyMAT_encodeQString(const TinyMATWriterFile* mat, const QString& str) {
+        return (mat->string_encoding==TINYMAT_STRING_ENCODING_LATIN1)?str.toLatin1():str.toUtf8();
+    }
+
+    void TinyMATWriter_writeQVariantList(TinyMATWriterFile *mat, const char *name, const QVariantList &data)
+    {
+        mat->addStructItemName(name);
+        TinyMAT_beginVariable(mat);
+        uint32_t size_bytes=0;
+        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+
+
+
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        long sizepos=TinyMAT_ftell(mat);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+        TinyMAT_writeU32(mat, (uint32_t)8);
+        TinyMAT_write32(mat, (int32_t)1);
+        TinyMAT_write32(mat, (int32_t)data.size());
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write data type
+        for (int i=0; i<data.size(); i++) {
+            if (data[i].type()==QVariant::String) {
+                QByteArray a=TinyMAT_encodeQString(mat, data[i].toString());
+                TinyMATWriter_writeString(mat, "", a.data(), a.size());
+            } else if (data[i].type()==QVariant::Map) {
+                QVariantMap a=data[i].toMap();
+                TinyMATWriter_writeQVariantMap(mat, "", a);
+            } else if (data[i].type()==QVariant::List) {
+                QVariantList a=data[i].toList();
+                //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
+                TinyMATWriter_writeQVariantList(mat, "", a);
+
+            } else if (data[i].canConvert(QVariant::Double)) {
+                double a=data[i].toDouble();
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
+            } else if (data[i].canConvert(QVariant::PointF)) {
+                double a[2]={data[i].toPointF().x(), data[i].toPointF().y()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (data[i].canConvert(QVariant::Point)) {
+                double a[2]={(double)data[i].toPoint().x(), (double)data[i].toPoint().y()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (data[i].canConvert(QVariant::SizeF)) {
+                double a[2]={data[i].toSizeF().width(), data[i].toSizeF().height()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (data[i].canConvert(QVariant::Size)) {
+                double a[2]={(double)data[i].toSize().width(), (double)data[i].toSize().height()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (data[i].canConvert(QVariant::String)) {
+                QByteArray a=TinyMAT_encodeQString(mat, data[i].toString());
+                TinyMATWriter_writeString(mat, "", a.data(), a.size());
+            } else {
+                TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
+            }
+        }
+
+        long endpos=TinyMAT_ftell(mat);
+        TinyMAT_fseek(mat, sizepos);
+        size_bytes=endpos-sizepos-4;
+        TinyMAT_writeU32(mat, size_bytes);
+        TinyMAT_fseek(mat, endpos);
+        TinyMAT_endVariable(mat);
+    }
+
+    void TinyMATWriter_writeQStringList(TinyMATWriterFile *mat, const char *name, const QStringList &data)
+    {
+        mat->addStructItemName(name);
+        TinyMAT_beginVariable(mat);
+        uint32_t size_bytes=0;
+        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        long sizepos=TinyMAT_ftell(mat);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+        TinyMAT_writeU32(mat, (uint32_t)8);
+        TinyMAT_write32(mat, (int32_t)1);
+        TinyMAT_write32(mat, (int32_t)data.size());
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write data type
+        for (int i=0; i<data.size(); i++) {
+            QByteArray a=TinyMAT_encodeQString(mat, data[i]);
+            TinyMATWriter_writeString(mat, "", a.data(), a.size());
+        }
+
+        long endpos=TinyMAT_ftell(mat);
+        TinyMAT_fseek(mat, sizepos);
+        size_bytes=endpos-sizepos-4;
+        TinyMAT_writeU32(mat, size_bytes);
+        TinyMAT_fseek(mat, endpos);
+        TinyMAT_endVariable(mat);
+    }
+
+    void TinyMATWriter_writeQVariantMatrix_listofcols(TinyMATWriterFile *mat, const char *name, const QList<QList<QVariant> > &data)
+    {
+        mat->addStructItemName(name);
+        TinyMAT_beginVariable(mat);
+        uint32_t size_bytes=0;
+        uint32_t arrayflags[2]={TINYMAT_mxCELL_CLASS_arrayflags, 0};
+
+
+        int32_t maxrows=0;
+        for (int i=0; i<data.size(); i++) {
+            for (int j=0; j<data[i].size(); j++) {
+                maxrows=qMax(maxrows, data[i].size());
+            }
+        }
+
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        long sizepos;
+        sizepos=TinyMAT_ftell(mat);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+        TinyMAT_writeU32(mat, (uint32_t)8);
+        TinyMAT_write32(mat, (int32_t)maxrows);
+        TinyMAT_write32(mat, (int32_t)data.size());
+
+        // write field name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write data type
+        for (int j=0; j<maxrows; j++) {
+            for (int i=0; i<data.size(); i++) {
+                QVariant v;
+                if (j<data[i].size()) {
+                    v=data[i].operator[](j);
+                }
+                //std::cout<<"+++ "<<i<<"/"<<j<<":   "<<TinyMAT_ftell(mat)<<" "<<(TinyMAT_ftell(mat)%8)<<"  write '"<<v.toString().toStdString()<<"'\n";
+                if (v.type()==QVariant::String) {
+                    QByteArray a=TinyMAT_encodeQString(mat, v.toString());
+                    //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
+                    TinyMATWriter_writeString(mat, "", a.data(), a.size());
+                } else if (v.type()==QVariant::Map) {
+                    QVariantMap a=v.toMap();
+                    TinyMATWriter_writeQVariantMap(mat, "", a);
+
+                } else if (v.type()==QVariant::List) {
+                    QVariantList a=v.toList();
+                    //std::cout<<i<<" "<<j<<" "<<QString(a).toStdString()<<"  length="<<a.size()<<"\n";
+                    TinyMATWriter_writeQVariantList(mat, "", a);
+                } else if (v.canConvert(QVariant::Double)) {
+                    double a=v.toDouble();
+                    //std::cout<<i<<" "<<j<<" "<<a<<"\n";
+                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
+                } else if (v.canConvert(QVariant::PointF)) {
+                    double a[2]={v.toPointF().x(), v.toPointF().y()};
+                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+                } else if (v.canConvert(QVariant::Point)) {
+                    double a[2]={(double)v.toPoint().x(), (double)v.toPoint().y()};
+                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+                } else if (v.canConvert(QVariant::SizeF)) {
+                    double a[2]={v.toSizeF().width(), v.toSizeF().height()};
+                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+                } else if (v.canConvert(QVariant::Size)) {
+                    double a[2]={(double)v.toSize().width(), (double)v.toSize().height()};
+                    TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+                } else if (v.canConvert(QVariant::String)) {
+                    QByteArray a=TinyMAT_encodeQString(mat, v.toString());
+                    TinyMATWriter_writeString(mat, "", a.data(), a.size());
+                } else {
+                    //std::cout<<i<<" "<<j<<" "<<"EMPTY"<<"\n";
+                    TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
+                }
+                //std::cout<<"### "<<i<<"/"<<j<<":   "<<TinyMAT_ftell(mat)<<" "<<(TinyMAT_ftell(mat)%8)<<"\n";
+            }
+        }
+
+        long endpos;
+        endpos=TinyMAT_ftell(mat);
+        TinyMAT_fseek(mat, sizepos);
+        //fsetpos(mat->file, &sizepos);
+        size_bytes=endpos-sizepos-4;
+        TinyMAT_writeU32(mat, size_bytes);
+        TinyMAT_fseek(mat, endpos);
+        //fsetpos(mat->file, &endpos);
+        //std::cout<<endpos<<" "<<TinyMAT_ftell(mat)<<"\n";
+        TinyMAT_endVariable(mat);
+    }
+
+
+
+
+    void TinyMATWriter_writeQVariantMap(TinyMATWriterFile *mat, const char *name, const QVariantMap &data)
+    {
+        mat->addStructItemName(name);
+        TinyMAT_beginVariable(mat);
+        mat->startStruct();
+        uint32_t size_bytes=0;
+        uint32_t arrayflags[2]={TINYMAT_mxSTRUCT_CLASS_arrayflags, 0};
+        QVariantMap::ConstIterator i;
+        QList<QByteArray> names;
+        int32_t maxlen=0;
+        for (i = data.begin(); i != data.end(); ++i) {
+            QString ni=i.key();
+            QByteArray n=ni.toLocal8Bit();
+            n=n.left(31);
+            maxlen=qMax(maxlen, (int32_t)n.size());
+            names<<n;
+        }
+        if (maxlen<32) maxlen=32;
+        // pad all field names to maxlen
+        for (int ii=0; ii<names.size(); ii++) {
+            while (names[ii].size()<maxlen) {
+                names[ii].append('\0');
+            }
+        }
+
+
+
+        // write tag header
+        TinyMAT_writeU32(mat, (uint32_t)TINYMAT_miMATRIX);
+        long sizepos;
+        sizepos=TinyMAT_ftell(mat);
+        TinyMAT_writeU32(mat, size_bytes);
+
+        // write arrayflags
+        TinyMAT_writeDatElement_u32a(mat, arrayflags, 2);
+
+        // write field dimensions
+        TinyMAT_writeU32(mat, static_cast<uint32_t>(TINYMAT_miINT32));
+        TinyMAT_writeU32(mat, (uint32_t)8);
+        TinyMAT_write32(mat, (int32_t)1);
+        TinyMAT_write32(mat, (int32_t)1);
+
+        // write struct name
+        TinyMAT_writeDatElement_stringas8bit(mat, name);
+
+        // write field name length
+        TinyMAT_writeDatElementS_i32(mat, maxlen);
+
+        // write field names
+        QByteArray joinednames;//=names.join();
+        for (int i=0; i<names.size(); i++)  {
+            joinednames+=names[i];
+        }
+        TinyMAT_writeDatElement_i8a(mat, (int8_t*)joinednames.data(), joinednames.size());
+
+        // write data type
+        for (i = data.begin(); i != data.end(); ++i) {
+            QVariant v=i.value();
+            QString n=i.key();
+
+            if (v.type()==QVariant::String) {
+                QByteArray a=TinyMAT_encodeQString(mat, v.toString());
+                TinyMATWriter_writeString(mat, "", a.data(), a.size());
+            } else if (v.type()==QVariant::List) {
+                QVariantList a=v.toList();
+                TinyMATWriter_writeQVariantList(mat, "", a);
+            } else if (v.type()==QVariant::Map) {
+                QVariantMap a=v.toMap();
+                TinyMATWriter_writeQVariantMap(mat, "", a);
+            } else if (v.canConvert(QVariant::Double)) {
+                double a=v.toDouble();
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", &a, 1, 1);
+            } else if (v.canConvert(QVariant::PointF)) {
+                double a[2]={v.toPointF().x(), v.toPointF().y()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (v.canConvert(QVariant::Point)) {
+                double a[2]={(double)v.toPoint().x(), (double)v.toPoint().y()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (v.canConvert(QVariant::SizeF)) {
+                double a[2]={v.toSizeF().width(), v.toSizeF().height()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (v.canConvert(QVariant::Size)) {
+                double a[2]={(double)v.toSize().width(), (double)v.toSize().height()};
+                TinyMATWriter_writeMatrix2D_colmajor(mat, "", a, 1, 2);
+            } else if (v.canConvert(QVariant::String)) {
+                QByteArray a=TinyMAT_encodeQString(mat, v.toString());
+                TinyMATWriter_writeString(mat, "", a.data(), a.size());
+            } else {
+                TinyMATWriter_writeMatrix2D_colmajor<double>(mat, "", NULL, 0, 0);
+            }
+        }
+
+        long endpos;
+        endpos=TinyMAT_ftell(mat);
+        TinyMAT_fseek(mat, sizepos);
+        size_bytes=endpos-sizepos-4;
+        TinyMAT_writeU32(mat, size_bytes);
+        TinyMAT_fseek(mat, endpos);
+        mat->endStruct();
+        TinyMAT_endVariable(mat);
+    }
+
+#endif
+
+#ifdef TINYMAT_USES_OPENCV
+void TinyMATWriter_writeCVMat(TinyMATWriterFile* mat, const char* name, const cv::Mat& img) {
+    if (img.rows<=0 || img.cols<=0) {
+      //throw std::runtime_error("OpenCV Matrix has too many dimensions or is empty");
+      TinyMATWriter_writeEmptyMatrix(mat, name);
+    } else if (img.isContinuous()) {
+      //mat->addStructItemName(name);
+      int32_t sizes[2] = { img.cols, img.rows };
+      uint32_t ndims = 2;
+      if (img.depth() == CV_8U) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const uint8_t*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_8S) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const int8_t*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_16U) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const uint16_t*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_16S) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const int16_t*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_32S) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const int32_t*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_32F) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const float*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else if (img.depth() == CV_64F) {
+        TinyMATWriter_writeMultiChannelMatrixND_rowmajor(mat, name, (const double*)img.data, sizes, ndims, (uint32_t)img.channels());
+      } else {
+        throw std::runtime_error("OpenCV Matrix has a datatype which is not supported by TinyMATWriter_writeCVMat()");
+      }
+    } else {
+      // a region of interest or an image with padded rows is gathered directly from img, without cloning it
+      int32_t sizes[3] = { img.rows, img.cols, img.channels() };
+      int64_t strides[3] = { (int64_t)img.step[0], (int64_t)img.elemSize(), (int64_t)img.elemSize1() };
+      uint32_t ndims = (img.channels()>1)?3:2;
+      if (img.depth() == CV_8U) {
+        TinyMATWriterView<uint8_t> view = { (const uint8_t*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_8S) {
+        TinyMATWriterView<int8_t> view = { (const int8_t*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_16U) {
+        TinyMATWriterView<uint16_t> view = { (const uint16_t*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_16S) {
+        TinyMATWriterView<int16_t> view = { (const int16_t*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_32S) {
+        TinyMATWriterView<int32_t> view = { (const int32_t*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_32F) {
+        TinyMATWriterView<float> view = { (const float*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else if (img.depth() == CV_64F) {
+        TinyMATWriterView<double> view = { (const double*)img.data, sizes, strides, ndims };
+        TinyMATWriter_writeMatrixND_view(mat, name, view);
+      } else {
+        throw std::runtime_error("OpenCV Matrix has a datatype which is not supported by TinyMATWriter_writeCVMat()");
+      }
+    }
+}
+
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2d>& data_vec) {
+  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
+  double* tmp = (double*)malloc(data_vec.size() * 2 * sizeof(double));
+  int i = 0;
+  for (auto& it : data_vec) {
+
+    tmp[0 + i] = it.x;
+    tmp[(data_vec.size()) + i] = it.y;
+    i++;
+  }
+  TinyMATWriter_writeMatrix2D_rowmajor<double>(mat, name, tmp, (int32_t)data_vec.size(), 2);
+  free(tmp);
+}
+
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2i>& data_vec) {
+  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
+  int* tmp = (int*)malloc(data_vec.size() * 2 * sizeof(int));
+  int i = 0;
+  for (auto& it : data_vec) {
+
+    tmp[0 + i] = it.x;
+    tmp[(data_vec.size()) + i] = it.y;
+    i++;
+  }
+  TinyMATWriter_writeMatrix2D_rowmajor<int>(mat, name, tmp, (int32_t)data_vec.size(), 2);
+  free(tmp);
+}
+
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2f>& data_vec) {
+  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
+  float* tmp = (float*)malloc(data_vec.size() * 2 * sizeof(float));
+  int i = 0;
+  for (auto& it : data_vec) {
+
+    tmp[0 + i] = it.x;
+    tmp[(data_vec.size()) + i] = it.y;
+    i++;
+  }
+  TinyMATWriter_writeMatrix2D_rowmajor<float>(mat, name, tmp, (int32_t)data_vec.size(), 2);
+  free(tmp);
+}
+
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2l>& data_vec) {
+  if (data_vec.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+  int32_t siz[2] = { 2, (int32_t)data_vec.size() };
+  int64_t* tmp = (int64_t*)malloc(data_vec.size() * 2 * sizeof(int64_t));
+  int i = 0;
+  for (auto& it : data_vec) {
+
+    tmp[0 + i] = it.x;
+    tmp[(data_vec.size()) + i] = it.y;
+    i++;
+  }
+  TinyMATWriter_writeMatrix2D_rowmajor<int64_t>(mat, name, tmp, (int32_t)data_vec.size(), 2);
+  free(tmp);
+}
+
+#endif
+
+void TinyMATWriter_writeMatrixND_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) {
+	TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, sizes, ndims);
+}
+
+void TinyMATWriter_writeMatrix2D_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows) {
+	int32_t siz[2]={cols, rows};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
+}
+
+void TinyMATWriter_writeString_exp(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen) {
+	TinyMATWriter_writeString(mat, name, data, slen);
+}
+
+void TinyMATWriter_writeMatrixND_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) {
+	TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, sizes, ndims);
+}
+
+void TinyMATWriter_writeMatrix2D_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows) {
+    int32_t siz[2]={rows, cols};
+    TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, siz, 2);
+}
+
+long TinyMATWriter_ftell(TinyMATWriterFile* file) {
+	TinyMAT_flushCompression(file);
+	return TinyMAT_ftell(file);
+}
+
+uint8_t* TinyMATWriter_data(TinyMATWriterFile* file) {
+	TinyMAT_flushCompression(file);
+	TinyMAT_resolveReferences(file->filedata);
+	return file->filedata.data;
+}
@@ -1,1414 +1,2420 @@
-/*
-    Copyright (c) 2008-2015 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
-
-
-    This software is free software: you can redistribute it and/or modify
-    it under the terms of the GNU Lesser General Public License (LGPL) as published by
-    the Free Software Foundation, either version 2 of the License, or
-    (at your option) any later version.
-
-    This program is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with this program.  If not, see <http://www.gnu.org/licenses/>.
-
-
-*/
-
-
-#ifndef TINYMATWRITER_H
-#define TINYMATWRITER_H
-
-#include "tinymatwriter_export.h"
-
-#include <stdint.h>
-#include <memory>
-#include <list>
-#include <vector>
-#include <string>
-#include <map>
-
-#ifdef TINYMAT_USES_QVARIANT
-#  include <QVariant>
-#  include <QList>
-#  include <QStringList>
-#  include <QMap>
-#  include <QVector>
-#  include <QString>
-#endif
-
-
-#ifdef TINYMAT_USES_OPENCV
-#pragma warning(push, 0)
-#  include <opencv2/opencv.hpp>
-#pragma warning(pop)
-#endif
-
-/*! \defgroup tinymatwriter Tiny Matlab(r) MAT writer library
-
-\code
-    TinyMATWriterFile* mat=TinyMATWriter_open("test.mat");
-	if (mat) {
-		double mat1[4]={1,2,3,4};
-		double vec1[8]={1,2,3,4,5,6,7,8};
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector1", vec1, 1,8);
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "matrix1", mat1, 2,2);
-		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector2", vec1, 8,1);
-		TinyMATWriter_close(mat);
-	}
-\endcode
-    Here is Octave/Matlab code to test the output and create a comparable MAT-file:
-\code
-	mat1=[1,2;3,4];
-	vec1=[1,2,3,4,5,6,7,8];
-	vec2=vec1';
-
-	save("-v6", "./test_octave.mat", "vec1", "mat1", "vec2")
-
-	load("test.mat", "-v6")
-
-	if (vec1==vector1) 
-		disp('vec1 OK');
-	end
-
-	if (mat1==matrix1) 
-		disp('mat1 OK');
-	end
-
-	if (vec2==vector2) 
-		disp('vec2 OK');
-	end
-\endcode
-   
- */
-
-/*! \defgroup tinymatwriter_qt TinyMATWriter-Support for Qt Datatypes
-    \ingroup tinymatwriter
-
-    Functions in this group allow to directly store Qt-datatypes into MAT-files.
-*/
-/*! \defgroup tinymatwriter_opencv TinyMATWriter-Support for OpenCV Datatypes
-    \ingroup tinymatwriter
-
-    Functions in this group allow to directly store OpenCV-datatypes into MAT-files.
-*/
-
-
-
-/** \brief struct used to describe a TIFF file
-  * \ingroup tinymatwriter
-  */
-struct TinyMATWriterFile; // forward
-
-#ifndef TRUE
-#  define TRUE (0==0)
-#endif
-#ifndef FALSE
-#  define FALSE (0==1)
-#endif
-
-/*! \brief returns \c TRUE (non-zero) if the given TinyMATWriterFile has been opened successfully and is OK
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file
-    \return \c TRUE if the file is OK and can be written to or \c FALSE
-
-  */
-extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_fOK(const TinyMATWriterFile* mat);
-
-/*! \brief create a new MAT file
-    \ingroup tinymatwriter
-
-    \param filename name of the new TIFF file
-    \param description description of the file (max. 115 characters)
-    \param bufSize size of the IO-Buffer used for the MAT-file ... Choosing a size 
-                   in the range of the final file size may improve performance!
-                   The default-size is 100kB.
-    \return a new TinyMATWriterFile pointer on success, or NULL on errors
-
-  */
-extern "C" TINYMATWRITER_EXPORT TinyMATWriterFile* TinyMATWriter_open(const char* filename, const char* description=NULL, size_t bufSize=1024*100);
-
-/*! \brief write a string into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the string to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const char* data);
-/*! \brief write a string into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the string to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const std::string& data);
-
-/*! \brief write a string into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the string to write
-    \param slen length of the string in bytes
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen);
-
-
-/*! \brief write an empty (double) matrix into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeEmptyMatrix(TinyMATWriterFile* mat, const char* name);
-
-
-
-
-
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// METHODS TO WRITE MATRICES
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \brief write a N-dimensional double matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional float matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const float* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional uint64_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint64_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional int64_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int64_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional uint32_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint32_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional int32_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int32_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional uint16_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint16_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional int16_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int16_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional uint8_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint8_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional int8_t matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int8_t* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-/*! \brief write a N-dimensional bool matrix in column-major form into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const bool* data_real, const int32_t* sizes, uint32_t ndims) ;
-
-
-
-/*! \brief write a single (numeric) value (as 1x1 matrix) into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the value to write
-
-  */
-template<typename T>
-inline void TinyMATWriter_writeValue(TinyMATWriterFile* mat, const char* name, T data_real) {
-  TinyMATWriter_writeVectorAsColumn(mat, name, &data_real, 1);
-}
-
-
-/*! \brief write a N-dimensional double  matrix  into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... }
-    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
-    \param ndims number of dimensions
-
-  */
-template<typename T>
-inline void TinyMATWriter_writeMatrixND_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims) {
-    T* dat=NULL;
-    const T* datOut=NULL;
-    int32_t* siz=NULL;
-    bool freeDat=false;
-    if (data_real && sizes && ndims>1) {
-        uint32_t nentries=1;
-        uint32_t cols=1;
-        uint32_t rows=1;
-        uint32_t nmatrices=1;
-        uint32_t nonSingularDimensions=0;
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-                nentries=nentries*sizes[i];
-            }
-
-            if (i==0) cols=sizes[i];
-            else if (i==1) rows=sizes[i];
-            else {
-                nmatrices=nmatrices*sizes[i];
-            }
-            if (sizes[i]>1) nonSingularDimensions++;
-        }
-        if (nentries>0) {
-            siz=new int32_t[ndims];//=(int32_t*)malloc(ndims*sizeof(int32_t));
-            for (uint32_t i=0; i<ndims; i++) siz[i]=sizes[i];
-            if (ndims>1) {
-                siz[0]=sizes[1];
-                siz[1]=sizes[0];
-            }
-            if (nonSingularDimensions<=1) {
-              // this is not a matrix, but a simple vector
-              datOut=data_real;
-              freeDat=false;
-            } else {
-              dat=new T[nentries];//(T*)malloc(nentries*sizeof(T));
-              datOut=dat;
-              freeDat=true;
-              for (uint32_t m=0; m<nmatrices; m++) {
-                  for(uint32_t r=0; r<rows; r++) {
-                      for (uint32_t c=0; c<cols; c++) {
-                          dat[m*cols*rows+c*rows+r]=data_real[m*cols*rows+r*cols+c];
-                      }
-                  }
-              }
-            }
-        }
-
-    }
-    if (dat) {
-        TinyMATWriter_writeMatrixND_colmajor(mat, name, datOut, siz, ndims);
-        //free(dat);
-        //free(siz);
-        
-    } else {
-        TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, sizes, ndims);
-    }
-    if (freeDat && dat) delete[] dat;
-    if (siz) delete[] siz;
-}
-
-
-/*! \brief write a N-dimensional matrix with C color channels (e.g. C=3 RGBRGBRGB...) into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... },
-                     where each elements has the channels in order C2C2C3C1C2C3...
-    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
-    \param ndims number of dimensions
-    \param c number of channels
-
-    This function will actually write an ndims+1-dimensional matrix, where the outer-most dimension is the number
-    of channels. The input data is then separated into planes!
-
-  */
-template<typename T>
-inline void TinyMATWriter_writeMultiChannelMatrixND_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, uint32_t c) {
-    if (c==1) {
-      TinyMATWriter_writeMatrixND_rowmajor( mat, name, data_real, sizes, ndims);
-    } else {
-        uint32_t nentries=1;
-        int32_t* siz=(int32_t*)malloc((ndims+1)*sizeof(int32_t));
-        for (uint32_t i=0; i<ndims; i++) {
-            if (i==0) {
-                nentries=sizes[0];
-            } else {
-              nentries=nentries*sizes[i];
-            }
-            siz[i]=sizes[i];
-        }
-        siz[ndims]=c;
-        T* dat=(T*)calloc(nentries*c,sizeof(T));
-        uint32_t j=0;
-        // resort array into planes
-        for (uint32_t i=0; i<nentries; i++) {
-          for (uint32_t ci=0; ci<c; ci++) {
-            dat[ci*nentries+i]=data_real[j];
-            j++;
-          }
-        }
-        TinyMATWriter_writeMatrixND_rowmajor( mat, name, dat, siz, ndims+1);
-        free(dat);
-        free(siz);
-    }
-}
-
-
-
-/*! \brief write a N-dimensional matrix with C color channels (e.g. C=3 RGBRGBRGB...) into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... },
-                     where each elements has the channels in order C2C2C3C1C2C3...
-    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
-    \param ndims number of dimensions
-    \param c number of channels
-
-    This function will actually write an ndims+1-dimensional matrix, where the outer-most dimension is the number
-    of channels. The input data is then separated into planes!
-
-  */
-template<typename T>
-inline void TinyMATWriter_writeMultiChannelMatrix2D_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real,  int32_t cols, int32_t rows, uint32_t c) {
-  int32_t dims[2]={rows, cols};
-  TinyMATWriter_writeMultiChannelMatrix2D_rowmajor(mat, name, data_real, dims, 2, c);
-}
-
-
-/*! \brief write a 2-dimensional double matrix in column-major order into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in column-major order)
-    \param cols number of columns
-	\param rows number of rows
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeMatrix2D_colmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t cols, int32_t rows) {
-    int32_t siz[2]={rows, cols};
-    TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, siz, 2);
-}
-
-/*! \brief write a 2-dimensional double matrix in row-major order into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order)
-    \param cols number of columns
-    \param rows number of rows
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeMatrix2D_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t cols, int32_t rows) {
-    int32_t siz[2]={cols, rows};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
-}
-
-/*! \brief write a 2x2-dimensional double matrix with entries given in row-major order directly as parameters into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeMatrix2x2(TinyMATWriterFile* mat, const char* name, T m11, T m12, T m21, T m22) {
-    int32_t siz[2]={2, 2};
-    T data[4]={m11,m12,m21,m22};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-/*! \brief write a 3x3-dimensional double matrix with entries given in row-major order directly as parameters into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeMatrix3x3(TinyMATWriterFile* mat, const char* name, T m11, T m12, T m13, T m21, T m22, T m23, T m31, T m32, T m33) {
-    int32_t siz[2]={3,3};
-    T data[9]={m11,m12,m13,m21,m22,m23,m31,m32,m33};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-
-/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order)
-    \param cols number of columns
-    \param rows number of rows
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t rows) {
-    int32_t siz[2]={1, rows};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
-}
-
-
-/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file with data directly as parameter direct
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param d1 first entry
-    \param d2 second entry
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2) {
-    int32_t siz[2]={1,2};
-    T data[2]={d1, d2};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3) {
-    int32_t siz[2]={1,3};
-    T data[]={d1, d2, d3};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4) {
-    int32_t siz[2]={1,4};
-    T data[]={d1, d2, d3, d4};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5) {
-    int32_t siz[2]={1,5};
-    T data[]={d1, d2, d3, d4, d5};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6) {
-    int32_t siz[2]={1,6};
-    T data[]={d1, d2, d3, d4, d5, d6};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7) {
-    int32_t siz[2]={1,7};
-    T data[]={d1, d2, d3, d4, d5, d6, d7};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8) {
-    int32_t siz[2]={1,8};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9) {
-    int32_t siz[2]={1,9};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10) {
-    int32_t siz[2]={1, 10};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10, T d11) {
-    int32_t siz[2]={1,11};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10, T d11, T d12) {
-    int32_t siz[2]={1,12};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-
-/*! \brief write a 1-dimensional double vector as a column-vector into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_real the array to write (in row-major order)
-    \param cols number of columns
-    \param rows number of rows
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t rows) {
-    int32_t siz[2]={rows, 1};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
-}
-
-/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file with data directly as parameter direct
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param d1 first entry
-    \param d2 second entry
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2) {
-    int32_t siz[2]={2,1};
-    T data[2]={d1, d2};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3) {
-    int32_t siz[2]={3,1};
-    T data[]={d1, d2, d3};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4) {
-    int32_t siz[2]={4,1};
-    T data[]={d1, d2, d3, d4};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5) {
-    int32_t siz[2]={5,1};
-    T data[]={d1, d2, d3, d4, d5};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6) {
-    int32_t siz[2]={6,1};
-    T data[]={d1, d2, d3, d4, d5, d6};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7) {
-    int32_t siz[2]={7,1};
-    T data[]={d1, d2, d3, d4, d5, d6, d7};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8) {
-    int32_t siz[2]={8,1};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9) {
-    int32_t siz[2]={9,1};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-template<typename T>
-inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10) {
-    int32_t siz[2]={10,1};
-    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10};
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
-}
-
-
-/*! \brief write a 1-dimensional vector/list/... of values as a row-vector into a MAT-file
-    \ingroup tinymatwriter
-    \internal
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_vec the array to write. This container has to implement the function size() and
-                    an iterator with tool-functions begin() and end()
-
-
-    \note This function copies the contents of the container into a temporary array, which is then saved to 
-    the file. Use TinyMATWriter_writeContainerAsColumn() to use potential performance-optimizations for some 
-    container types.
-  */
-template<typename T>
-inline  void TinyMATWriter_writeContainerAsRow_internalCopy(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
-    int32_t siz[2]={1, (int32_t)data_vec.size()};
-    auto tmp=static_cast<typename T::value_type*>(malloc(data_vec.size()*sizeof(typename T::value_type)));
-    int i=0;
-    for (auto it=data_vec.begin(); it!=data_vec.end(); ++it) {
-      tmp[i]=*it;
-      i++;
-    }
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
-    free(tmp);
-}
-
-/*! \brief write a 1-dimensional vector/list/... of values as a column-vector into a MAT-file
-    \ingroup tinymatwriter
-    \internal
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_vec the array to write. This container has to implement the function size() and
-                    an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
-                    has to be integer numbers or floats
-
-    \note This function copies the contents of the container into a temporary array, which is then saved to 
-    the file. Use TinyMATWriter_writeContainerAsColumn() to use potential performance-optimizations for some 
-    container types.
-  */
-template<typename T>
-inline  void TinyMATWriter_writeContainerAsColumn_internalCopy(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
-    int32_t siz[2]={(int32_t)data_vec.size(), 1};
-    auto tmp=static_cast<typename T::value_type*>(malloc(data_vec.size()*sizeof(typename T::value_type)));
-    int i=0;
-    for (auto it=data_vec.begin(); it!=data_vec.end(); ++it) {
-      tmp[i]=*it;
-      i++;
-    }
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
-    free(tmp);
-}
-
-
-/*! \brief write a 1-dimensional vector/list/... of values as a row-vector into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_vec the array to write. This container has to implement the function size() and
-                    an iterator with tool-functions begin() and end()
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
-    TinyMATWriter_writeContainerAsRow_internalCopy<T>(mat, name, data_vec);
-}
-
-/*! \brief write a 1-dimensional vector/list/... of values as a column-vector into a MAT-file
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data_vec the array to write. This container has to implement the function size() and
-                    an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
-                    has to be integer numbers or floats
-
-  */
-template<typename T>
-inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
-    TinyMATWriter_writeContainerAsColumn_internalCopy(mat, name, data_vec);
-}
-
-#if (__cplusplus > 199711L) || ( defined(_MSC_VER) && ( _MSC_VER >= 1700 ) ) 
-
-  /*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
-      \ingroup tinymatwriter
-
-      This is a performance-optimized specialization.
-
-      \param mat the MAT-file to write into
-      \param name variable name for the new array
-      \param data_vec the array to write. This container has to implement the function size() and
-                      an iterator with tool-functions begin() and end()
-
-
-    */
-  template<typename T>
-  inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<T>& data_vec) {
-      if (data_vec.size()<=0) TinyMATWriter_writeEmptyMatrix(mat, name);
-      int32_t siz[2]={1, (int32_t)data_vec.size()};
-      const T* tmp=data_vec.data(); 
-      TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
-  }
-
-
-  /*! \brief write a 1-dimensional std::vector<bool> of values as a row-vector into a MAT-file
-      \ingroup tinymatwriter
-
-      \param mat the MAT-file to write into
-      \param name variable name for the new array
-      \param data_vec the array to write. This container has to implement the function size() and
-                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
-                      has to be integer numbers or floats
-
-    */
-  template<>
-  inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<bool>& data_vec) {
-      TinyMATWriter_writeContainerAsRow_internalCopy<std::vector<bool>>(mat, name, data_vec);
-  }
-
-  /*! \brief write a 1-dimensional std::vector of values as a column-vector into a MAT-file
-      \ingroup tinymatwriter
-
-      This is a performance-optimized specialization.
-
-      \param mat the MAT-file to write into
-      \param name variable name for the new array
-      \param data_vec the array to write. This container has to implement the function size() and
-                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
-                      has to be integer numbers or floats
-
-    */
-  template<typename T>
-  inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const std::vector<T>& data_vec) {
-    if (data_vec.size() <= 0) {
-      TinyMATWriter_writeEmptyMatrix(mat, name);
-      return;
-    } // if
-    int32_t siz[2] = { (int32_t)data_vec.size(), 1 };
-    const T* tmp = data_vec.data();
-    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
-  }
-
-  /*! \brief write a 1-dimensional std::vector<bool> of values as a column-vector into a MAT-file
-      \ingroup tinymatwriter
-
-      \param mat the MAT-file to write into
-      \param name variable name for the new array
-      \param data_vec the array to write. This container has to implement the function size() and
-                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
-                      has to be integer numbers or floats
-
-    */
-  template<>
-  inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const std::vector<bool>& data_vec) {
-      TinyMATWriter_writeContainerAsColumn_internalCopy(mat, name, data_vec);
-  }
-
-
-  /*! \brief write a std::vector of std::vector (vecor of row-vectors) as a matrix into a MAT-file
-  \ingroup tinymatwriter
-
-  \param mat the MAT-file to write into
-  \param name variable name for the new array
-  \param data_mat the array to write.
-
-  */
-  template<class T>
-  inline  void TinyMATWriter_writeRowsContainerAsMatrix(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<T> >& data_mat) {
-    if (data_mat.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-
-    int32_t rows = data_mat.size();
-    int32_t cols = 0;
-    for (size_t i = 0; i < data_mat.size(); i++) cols = std::max<int32_t>(cols, data_mat[i].size());
-
-    T* tmp = (T*)malloc(rows*cols * sizeof(T));
-    for (int32_t i = 0; i<rows*cols; i++) tmp[i] = 0;
-    int r = 0;
-    int c = 0;
-    for (auto it = data_mat.begin(); it != data_mat.end(); ++it) {
-      c = 0;
-      for (auto itc = it->begin(); itc != it->end(); ++itc) {
-        tmp[c*rows + r] = *itc;
-        c++;
-      }
-      r++;
-    }
-    int32_t siz[2] = { rows, cols };
-    TinyMATWriter_writeMatrixND_colmajor(mat, name, tmp, siz, 2);
-    free(tmp);
-  }
-
-
-  /*! \brief write a std::vector of std::vector (vecor of col-vectors) as a matrix into a MAT-file
-  \ingroup tinymatwriter
-
-  \param mat the MAT-file to write into
-  \param name variable name for the new array
-  \param data_mat the array to write.
-
-  */
-  template<class T>
-  inline  void TinyMATWriter_writeColsContainerAsMatrix(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<T> >& data_mat) {
-    if (data_mat.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
-
-    int32_t rows = 0;
-    int32_t cols = data_mat.size();
-    for (size_t i = 0; i < data_mat.size(); i++) rows = std::max<int32_t>(rows, data_mat[i].size());
-
-    T* tmp = (T*)malloc(rows*cols * sizeof(T));
-    for (int32_t i = 0; i<rows*cols; i++) tmp[i] = 0;
-    int r = 0;
-    int c = 0;
-    for (auto it = data_mat.begin(); it != data_mat.end(); ++it) {
-      r = 0;
-      for (auto itc = it->begin(); itc != it->end(); ++itc) {
-        tmp[c*rows + r] = *itc;
-        r++;
-      }
-      c++;
-    }
-    int32_t siz[2] = { rows, cols };
-    TinyMATWriter_writeMatrixND_colmajor(mat, name, tmp, siz, 2);
-    free(tmp);
-  }
-#endif
-
-/*! \brief write a 1-dimensional std::list<std::string> into a MAT-file as a cell array
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStringList(TinyMATWriterFile* mat, const char* name, const std::list<std::string>& data);
-
-/*! \brief write a 1-dimensional std::vector<std::string> into a MAT-file as a cell array
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStringVector(TinyMATWriterFile* mat, const char* name, const std::vector<std::string>& data);
-
-/*! \brief write a 1-dimensional std::list<double> into a MAT-file as a 1D matrix
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeDoubleList(TinyMATWriterFile* mat, const char* name, const std::list<double>& data, bool columnVector=false);
-
-/*! \brief write a 1-dimensional std::vector<double> into a MAT-file as a 1D matrix
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeDoubleVector(TinyMATWriterFile* mat, const char* name, const std::vector<double>& data, bool columnVector=false);
-
-
-/*! \brief write a a std::map<std::string,double> into a MAT-file as a struct
-    \ingroup tinymatwriter
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
-
-  */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStruct(TinyMATWriterFile* mat, const char* name, const std::map<std::string, double>& data);
-
-
-
-
-/*! \brief start to write a struct-element
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name variable name for the new array (max. len: 31 characters)
-*/
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_startStruct(TinyMATWriterFile *mat, const char *name);
-/*! \brief end to write a struct-element
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name struc the structure object to finish
-*/
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_endStruct(TinyMATWriterFile* mat);
-
-
-
-
-/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a generic Cell-Array
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name variable name for the new array (max. len: 31 characters)
-\param sizes number of entries in each dimension {rows, cols, matrices, ...}
-\param ndims number of dimensions
-
-After a call to this function, simply use any TinyMATWriter-function to write the cell-array
-entires in column-major order with "name" left blanck. Finally close the array by calling 
-TinyMATWriter_endCellArray(). You can nest severall startCellArray/endCellAray-calls.
-
-*/
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_startCellArray(TinyMATWriterFile *mat, const char *name, const int32_t* sizes, uint32_t ndims);
-
-/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 1D Cell-Array (column)
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name variable name for the new array (max. len: 31 characters)
-\param nitems number of entries in the vector
-
-
-After a call to this function, simply use any TinyMATWriter-function to write the cell-array
-entries with "name" left blanck. Finally close the array by calling TinyMATWriter_endCellArray().
-You can nest severall startCellArray/endCellAray-calls.
-
-*/
-extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellVectorAsCol(TinyMATWriterFile *mat, const char *name, int32_t nitems) {
-  int32_t dims[2] = { nitems,1 };
-  TinyMATWriter_startCellArray(mat, name, dims, 2);
-}
-
-/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 1D Cell-Array (row)
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name variable name for the new array (max. len: 31 characters)
-\param nitems number of entries in the vector
-
-After a call to this function, simply use any TinyMATWriter-function to write the cell-array
-entries with "name" left blanck. Finally close the array by calling TinyMATWriter_endCellArray().
-You can nest severall startCellArray/endCellAray-calls.
-
-*/
-extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellVectorAsRow(TinyMATWriterFile *mat, const char *name, int32_t nitems) {
-  int32_t dims[2] = { 1,nitems };
-  TinyMATWriter_startCellArray(mat, name, dims, 2);
-}
-
-/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 2D Cell-Array
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name variable name for the new array (max. len: 31 characters)
-\param cols number of columns in the cell array
-\param rows number of rows in the cell array
-
-After a call to this function, simply use any TinyMATWriter-function to write the cell-array
-entires in column-major order with "name" left blanck. Finally close the array by calling
-TinyMATWriter_endCellArray(). You can nest severall startCellArray/endCellAray-calls.
-
-*/
-extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellMatrix2D(TinyMATWriterFile *mat, const char *name, int32_t cols, int32_t rows) {
-  int32_t dims[2] = { rows,cols };
-  TinyMATWriter_startCellArray(mat, name, dims, 2);
-}
-
-/*! \brief Low-Level-Interface zum Schrieben von Cell-Arrays: beendet das aktuelle Cell-Array
-\ingroup tinymatwriter
-
-\param mat the MAT-file to write into
-\param name struc the structure object to finish
-*/
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_endCellArray(TinyMATWriterFile* mat);
-
-
-
-#ifdef TINYMAT_USES_OPENCV
-/*! \brief write an OpenCV cv::Mat into a MAT-file as a matrix
-    \ingroup tinymatwriter_opencv
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param img the cv::Mat to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeCVMat(TinyMATWriterFile* mat, const char* name, const cv::Mat& img);
-
-/*! \brief write a cv::Vec into a MAT-file as a row vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param vec the cv::Vec to write
-
-*/
-template <typename T, int cn>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVVecAsRow(TinyMATWriterFile* mat, const char* name, const cv::Vec<T, cn>& vec) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, vec.val, cn);
-}
-
-/*! \brief write a cv::Vec into a MAT-file as a column vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param vec the cv::Vec to write
-
-*/
-template <typename T, int cn>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVVecAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Vec<T, cn>& vec) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, vec.val, cn);
-}
-
-/*! \brief write a cv::Point_<T> as row-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the point to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPointAsRow(TinyMATWriterFile* mat, const char* name, const cv::Point_<T>& p) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y);
-}
-
-/*! \brief write a cv::Point_<T> as column-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the point to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPointAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Point_<T>& p) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y);
-}
-
-/*! \brief write a cv::Point3_<T> as column-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the point to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPoint3AsColumn(TinyMATWriterFile* mat, const char* name, const cv::Point3_<T>& p) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y, p.z);
-}
-
-
-
-/*! \brief write a cv::Point3_<T> as row-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the point to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPoint3AsRow(TinyMATWriterFile* mat, const char* name, const cv::Point3_<T>& p) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y, p.z);
-}
-
-
-/*! \brief write a cv::Scalar_<T> as column-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the cv::Scalar_<T> to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVScalarAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Scalar_<T>& p) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p[0], p[1], p[2], p[3]);
-}
-
-
-
-/*! \brief write a cv::Scalar_<T> as row-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the cv::Scalar_<T> to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVScalarAsRow(TinyMATWriterFile* mat, const char* name, const cv::Scalar_<T>& p) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, p[0], p[1], p[2], p[3]);
-}
-
-
-/*! \brief write a cv::Size_<T> as row-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the size-object to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVSizeAsRow(TinyMATWriterFile* mat, const char* name, const cv::Size_<T>& p) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.width, p.height);
-}
-
-/*! \brief write a cv::Size_<T> as column-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the size-object to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVSizeAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Size_<T>& p) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.width, p.height);
-}
-
-
-/*! \brief write a cv::Rect_<T> as row-vector \c [x,y,width,height]
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the rectangle-object to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRectAsRow(TinyMATWriterFile* mat, const char* name, const cv::Rect_<T>& p) {
-  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y, p.width, p.height);
-}
-
-/*! \brief write a cv::Rect_<T> as column-vector \c [x;y;width;height]
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the rectangle-object to write
-
-*/
-template <typename T>
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRectAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Rect_<T>& p) {
-  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y, p.width, p.height);
-}
-
-
-
-/*! \brief write a cv::Range as row-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the Range-object to write
-
-*/
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRangeAsRow(TinyMATWriterFile* mat, const char* name, const cv::Range& p) {
-  TinyMATWriter_writeVectorAsRow(mat, name, p.start, p.end);
-}
-
-/*! \brief write a cv::Range as column-vector
-\ingroup tinymatwriter_opencv
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param p the rectangle-object to write
-
-*/
-TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRangeAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Range& p) {
-  TinyMATWriter_writeVectorAsColumn(mat, name, p.start, p.end);
-}
-
-
-/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
-\ingroup tinymatwriter_opencv
-
-This is a performance-optimized specialization.
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param data_vec the array to write. This container has to implement the function size() and
-an iterator with tool-functions begin() and end()
-
-*/
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2d>& data_vec);
-
-/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
-\ingroup tinymatwriter_opencv
-
-This is a performance-optimized specialization.
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param data_vec the array to write. This container has to implement the function size() and
-an iterator with tool-functions begin() and end()
-
-*/
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2i>& data_vec);
-
-/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
-\ingroup tinymatwriter_opencv
-
-This is a performance-optimized specialization.
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param data_vec the array to write. This container has to implement the function size() and
-an iterator with tool-functions begin() and end()
-
-*/
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2f>& data_vec);
-
-/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
-\ingroup tinymatwriter_opencv
-
-This is a performance-optimized specialization.
-
-\param mat the MAT-file to write into
-\param name variable name for the new array
-\param data_vec the array to write. This container has to implement the function size() and
-an iterator with tool-functions begin() and end()
-
-*/
-template <>
-void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2l>& data_vec);
-
-#endif
-
-
-#ifdef TINYMAT_USES_QVARIANT
-/*! \brief write a 1-dimensional QVariantList into a MAT-file as a cell array
-    \ingroup tinymatwriter_qt
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantList(TinyMATWriterFile* mat, const char* name, const QVariantList& data);
-/*! \brief write a 1-dimensional QStringList into a MAT-file as a cell array
-    \ingroup tinymatwriter_qt
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeQStringList(TinyMATWriterFile* mat, const char* name, const QStringList& data);
-/*! \brief write a 1-dimensional QVariantList (as a list of columns) into a MAT-file as a cell array
-    \ingroup tinymatwriter_qt
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the array to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantMatrix_listofcols(TinyMATWriterFile* mat, const char* name, const QList<QList<QVariant> >& data);
-/*! \brief write a QVariantMap into a MAT-file as a struct
-    \ingroup tinymatwriter_qt
-
-    \param mat the MAT-file to write into
-    \param name variable name for the new array
-    \param data the map to write
-
-  */
-TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantMap(TinyMATWriterFile* mat, const char* name, const QVariantMap& data);
-
-#endif
-
-/*! \brief close a given MAT file
-    \ingroup tinymatwriter
-
-    \param tiff TIFF file to close
-
-    This function also releases memory allocated in TinyMATWriter_open() in \a tiff.
- */
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_close(TinyMATWriterFile* mat);
-
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims);
-
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrix2D_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows);
-
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeString_exp(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen);
-
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims);
-
-extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrix2D_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows);
-
-extern "C" TINYMATWRITER_EXPORT long TinyMATWriter_ftell(TinyMATWriterFile* file);
-
-extern "C" TINYMATWRITER_EXPORT uint8_t* TinyMATWriter_data(TinyMATWriterFile* file);
-
-#endif // TINYMATWRITER_H
+/*
+    Copyright (c) 2008-2015 Jan W. Krieger (<jan@jkrieger.de>, <j.krieger@dkfz.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+
+#ifndef TINYMATWRITER_H
+#define TINYMATWRITER_H
+
+#include "tinymatwriter_export.h"
+
+#include <stdint.h>
+#include <memory>
+#include <list>
+#include <vector>
+#include <string>
+#include <map>
+#include <complex>
+#include <stdexcept>
+
+#ifdef TINYMAT_USES_QVARIANT
+#  include <QVariant>
+#  include <QList>
+#  include <QStringList>
+#  include <QMap>
+#  include <QVector>
+#  include <QString>
+#endif
+
+
+#ifdef TINYMAT_USES_OPENCV
+#pragma warning(push, 0)
+#  include <opencv2/opencv.hpp>
+#pragma warning(pop)
+#endif
+
+/*! \defgroup tinymatwriter Tiny Matlab(r) MAT writer library
+
+\code
+    TinyMATWriterFile* mat=TinyMATWriter_open("test.mat");
+	if (mat) {
+		double mat1[4]={1,2,3,4};
+		double vec1[8]={1,2,3,4,5,6,7,8};
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector1", vec1, 1,8);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "matrix1", mat1, 2,2);
+		TinyMATWriter_writeMatrix2D_rowmajor(mat, "vector2", vec1, 8,1);
+		TinyMATWriter_close(mat);
+	}
+\endcode
+    Here is Octave/Matlab code to test the output and create a comparable MAT-file:
+\code
+	mat1=[1,2;3,4];
+	vec1=[1,2,3,4,5,6,7,8];
+	vec2=vec1';
+
+	save("-v6", "./test_octave.mat", "vec1", "mat1", "vec2")
+
+	load("test.mat", "-v6")
+
+	if (vec1==vector1) 
+		disp('vec1 OK');
+	end
+
+	if (mat1==matrix1) 
+		disp('mat1 OK');
+	end
+
+	if (vec2==vector2) 
+		disp('vec2 OK');
+	end
+\endcode
+   
+ */
+
+/*! \defgroup tinymatwriter_qt TinyMATWriter-Support for Qt Datatypes
+    \ingroup tinymatwriter
+
+    Functions in this group allow to directly store Qt-datatypes into MAT-files.
+*/
+/*! \defgroup tinymatwriter_opencv TinyMATWriter-Support for OpenCV Datatypes
+    \ingroup tinymatwriter
+
+    Functions in this group allow to directly store OpenCV-datatypes into MAT-files.
+*/
+
+
+
+/** \brief struct used to describe a TIFF file
+  * \ingroup tinymatwriter
+  */
+struct TinyMATWriterFile; // forward
+
+#ifndef TRUE
+#  define TRUE (0==0)
+#endif
+#ifndef FALSE
+#  define FALSE (0==1)
+#endif
+
+/*! \brief returns \c TRUE (non-zero) if the given TinyMATWriterFile has been opened successfully and is OK
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file
+    \return \c TRUE if the file is OK and can be written to or \c FALSE
+
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_fOK(const TinyMATWriterFile* mat);
+
+/*! \brief create a new MAT file
+    \ingroup tinymatwriter
+
+    \param filename name of the new TIFF file
+    \param description description of the file (max. 115 characters)
+    \param bufSize size of the IO-Buffer used for the MAT-file ... Choosing a size 
+                   in the range of the final file size may improve performance!
+                   The default-size is 100kB.
+    \return a new TinyMATWriterFile pointer on success, or NULL on errors
+
+  */
+extern "C" TINYMATWRITER_EXPORT TinyMATWriterFile* TinyMATWriter_open(const char* filename, const char* description=NULL, size_t bufSize=1024*100);
+
+/** \brief I/O backend: choose the backend from TinyMATWriterOptions::size_hint (or use a custom sink, if one is given)
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_AUTO 0
+/** \brief I/O backend: the file is created in a memory buffer and only written to disk on TinyMATWriter_close()
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_MEMORY 1
+/** \brief I/O backend: the file is written directly to disk with the libc stdio functions, sizes are patched with \c fseek()
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_STDIO 2
+/** \brief I/O backend: the file is memory-mapped and written directly, the OS writes it back (POSIX systems only, otherwise \c TINYMAT_BACKEND_MEMORY is used)
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_MMAP 3
+/** \brief I/O backend: the output is passed to the callbacks in TinyMATWriterOptions::sink, no file is created
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_CUSTOM 4
+
+/** \brief \c TINYMAT_BACKEND_AUTO uses \c TINYMAT_BACKEND_MEMORY for files with a TinyMATWriterOptions::size_hint below this size (256MB)
+  *         and \c TINYMAT_BACKEND_MMAP (or \c TINYMAT_BACKEND_STDIO, if not available) for larger files
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_BACKEND_AUTO_MEMORY_LIMIT (256*1024*1024)
+
+/** \brief sink callback: appends \a bytes bytes from \a data to the output, returns the number of bytes written (fewer than \a bytes signals an error)
+  * \ingroup tinymatwriter
+  */
+typedef size_t (*TinyMATWriterSinkWriteFunction)(const void* data, size_t bytes, void* context);
+/** \brief sink callback: overwrites \a bytes bytes at \a offset (counted from the start of the output), which have already been written, returns \c TRUE on success
+  * \ingroup tinymatwriter
+  */
+typedef int (*TinyMATWriterSinkPatchFunction)(uint64_t offset, const void* data, size_t bytes, void* context);
+/** \brief sink callback: passes buffered output on, called by TinyMATWriter_flush() and when the file is closed, returns \c TRUE on success
+  * \ingroup tinymatwriter
+  */
+typedef int (*TinyMATWriterSinkFlushFunction)(void* context);
+
+/*! \brief callbacks for the output of a \c TINYMAT_BACKEND_CUSTOM file (see TinyMATWriter_openSink() )
+    \ingroup tinymatwriter
+
+    The output is appended with \c write() in order. Only \c write() is required: variables, which would need to be changed after
+    they have been passed on, are assembled in memory first and are then written in one piece.
+  */
+struct TinyMATWriterSink {
+    inline TinyMATWriterSink() :
+      write(NULL),
+      patch(NULL),
+      flush(NULL),
+      context(NULL)
+    {
+    }
+
+    /** \brief appends data to the output */
+    TinyMATWriterSinkWriteFunction write;
+    /** \brief (optional) overwrites data that has already been written */
+    TinyMATWriterSinkPatchFunction patch;
+    /** \brief (optional) passes buffered output on */
+    TinyMATWriterSinkFlushFunction flush;
+    /** \brief passed on to all callbacks */
+    void* context;
+};
+
+/*! \brief options for TinyMATWriter_openWithOptions()
+    \ingroup tinymatwriter
+
+    \code
+    TinyMATWriterOptions options;
+    options.backend=TINYMAT_BACKEND_AUTO;
+    options.size_hint=expected_frames*frame_bytes; // multi-GB captures are memory-mapped, small files are kept in memory
+    TinyMATWriterFile* mat=TinyMATWriter_openWithOptions("capture.mat", &options);
+    \endcode
+  */
+struct TinyMATWriterOptions {
+    inline TinyMATWriterOptions() :
+      backend(TINYMAT_BACKEND_AUTO),
+      size_hint(0),
+      buffer_size(1024*100),
+      memory_limit(0),
+      description(NULL)
+    {
+    }
+
+    /** \brief the I/O backend (\c TINYMAT_BACKEND_AUTO, \c TINYMAT_BACKEND_MEMORY, \c TINYMAT_BACKEND_STDIO, \c TINYMAT_BACKEND_MMAP or \c TINYMAT_BACKEND_CUSTOM ) */
+    int backend;
+    /** \brief expected size of the file in bytes (0 if unknown), used to choose the backend for \c TINYMAT_BACKEND_AUTO and as initial size of memory buffers */
+    uint64_t size_hint;
+    /** \brief size of the IO-buffer (\c TINYMAT_BACKEND_STDIO ) or the initial memory buffer (\c TINYMAT_BACKEND_MEMORY, \c TINYMAT_BACKEND_MMAP ) */
+    size_t buffer_size;
+    /** \brief with \c TINYMAT_BACKEND_MEMORY , completed variables are written to the file, as soon as the memory buffer holds more than this many bytes (0: no limit, see TinyMATWriter_setMemoryLimit() ) */
+    uint64_t memory_limit;
+    /** \brief description of the file (max. 115 characters) */
+    const char* description;
+    /** \brief the output callbacks for \c TINYMAT_BACKEND_CUSTOM */
+    TinyMATWriterSink sink;
+};
+
+/*! \brief create a new MAT file, using the I/O backend given in \a options
+    \ingroup tinymatwriter
+
+    \param filename name of the new file (ignored for \c TINYMAT_BACKEND_CUSTOM ), for \c TINYMAT_BACKEND_MEMORY this may be \c NULL to create a file that only exists in memory
+    \param options the backend and its options, \c NULL uses the defaults of TinyMATWriterOptions
+    \return a new TinyMATWriterFile pointer on success, or NULL on errors
+
+    TinyMATWriter_open() uses the backend selected at compile time (see \c TinyMAT_FILEBACKEND_USE_MEMORY_CACHE and \c TinyMAT_FILEBACKEND_USE_MMAP ).
+    \c TINYMAT_BACKEND_AUTO without a TinyMATWriterOptions::size_hint uses the same backend.
+  */
+extern "C" TINYMATWRITER_EXPORT TinyMATWriterFile* TinyMATWriter_openWithOptions(const char* filename, const TinyMATWriterOptions* options);
+
+/*! \brief create a new MAT file, that only exists in memory
+    \ingroup tinymatwriter
+
+    \param description description of the file (max. 115 characters)
+    \param bufSize initial size of the memory buffer, choosing a size in the range of the final file size avoids reallocations
+    \return a new TinyMATWriterFile pointer on success, or NULL on errors
+
+    No file is created (also no MEMFS-file in the WASM build). Use TinyMATWriter_data() and TinyMATWriter_ftell() to access
+    the data while writing, or TinyMATWriter_closeAndTakeBuffer() to take over the finished file:
+
+    \code
+    TinyMATWriterFile* mat=TinyMATWriter_openMemory();
+    TinyMATWriter_writeMatrix2D_rowmajor(mat, "matrix1", mat1, 2,2);
+    uint8_t* data=NULL;
+    size_t size=0;
+    if (TinyMATWriter_closeAndTakeBuffer(mat, &data, &size)) {
+        send(socket, data, size, 0);
+        TinyMATWriter_freeBuffer(data);
+    }
+    \endcode
+
+    This is the same as TinyMATWriter_openWithOptions() with \c TINYMAT_BACKEND_MEMORY and no filename.
+  */
+extern "C" TINYMATWRITER_EXPORT TinyMATWriterFile* TinyMATWriter_openMemory(const char* description=NULL, size_t bufSize=1024*100);
+
+/*! \brief create a new MAT file, that passes its output to user callbacks instead of a file
+    \ingroup tinymatwriter
+
+    \param write appends data to the output (required)
+    \param patch overwrites data, that has already been written (optional, may be \c NULL )
+    \param flush passes buffered output on, called by TinyMATWriter_flush() and TinyMATWriter_close() (optional, may be \c NULL )
+    \param context passed on to all callbacks
+    \param description description of the file (max. 115 characters)
+    \return a new TinyMATWriterFile pointer on success, or NULL on errors
+
+    This creates a \c TINYMAT_BACKEND_CUSTOM file, so the MAT output can go to sockets, shared memory, ring buffers or
+    further processing layers without a filesystem (e.g. in the WASM build). The output is always produced in order with
+    \a write. Most variables are assembled in memory and passed on in one piece. \a patch is only used to fix the size of large
+    compressed arrays, which are compressed while they are written (see TinyMATWriter_setCompressionStreaming() ). Without
+    \a patch these arrays are also assembled in memory. Errors returned by the callbacks are reported as \c std::runtime_error .
+
+    \code
+    size_t sendData(const void* data, size_t bytes, void* context) {
+        return send(*(int*)context, data, bytes, 0);
+    }
+
+    TinyMATWriterFile* mat=TinyMATWriter_openSink(sendData, NULL, NULL, &socket);
+    \endcode
+  */
+extern "C" TINYMATWRITER_EXPORT TinyMATWriterFile* TinyMATWriter_openSink(TinyMATWriterSinkWriteFunction write, TinyMATWriterSinkPatchFunction patch, TinyMATWriterSinkFlushFunction flush, void* context, const char* description=NULL);
+
+/*! \brief passes all output written so far on to the backend (e.g. \c fflush() or the flush callback of a sink)
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file
+    \return \c TRUE on success
+
+    Variables, that are still compressed by TinyMATWriter_setCompressionThreads(), are committed first. With \c TINYMAT_BACKEND_MEMORY
+    all completed top-level variables are written to the file and the memory buffer is reused (see TinyMATWriter_setMemoryLimit() ),
+    variables inside open structs or cell arrays stay in memory.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_flush(TinyMATWriterFile* mat);
+
+/*! \brief limits the memory buffer of \c TINYMAT_BACKEND_MEMORY : above \a limit bytes, all completed variables are written to the file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file
+    \param limit size of the memory buffer (in bytes), above which it is flushed, \c 0 keeps the whole file in memory until TinyMATWriter_close() (default)
+    \return \c TRUE on success, \c FALSE if \a mat does not use \c TINYMAT_BACKEND_MEMORY or has no file (see TinyMATWriter_openMemory() )
+
+    A top-level variable does not change any more, once it is complete, so everything in front of the next variable
+    can be written to the file. The check is done before each top-level variable and the buffer is reused afterwards,
+    so the memory stays below \a limit plus the size of the largest variable (an open struct or cell array counts as one variable),
+    no matter how large the file grows.
+
+    The part of the file, that has been flushed, is not available to TinyMATWriter_data() and TinyMATWriter_closeAndTakeBuffer() any more.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setMemoryLimit(TinyMATWriterFile* mat, uint64_t limit);
+
+/*! \brief switches compact storage of integer-valued numeric arrays on or off (default: off)
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param enabled if non-zero, each numeric array, whose values are all integers (no NaN or -0), is stored with the narrowest
+                    integer type (\c miUINT8, \c miINT8, \c miUINT16, ... \c miINT32 ), that holds all of them
+    \return \c TRUE on success
+
+    The class of the array (e.g. \c double ) is not changed, MATLAB converts the values back when it reads the file (and writes such files itself).
+    The values are scanned once (with SSE2 for \c double and \c float ) before the array is written. Arrays written with
+    TinyMATWriter_writeMatrixND_view() and arrays in zero-copy mode are always stored with their own type.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setStorageNarrowing(TinyMATWriterFile* mat, int enabled);
+
+/*! \brief returns the I/O backend that is actually used for \a mat (i.e. \c TINYMAT_BACKEND_AUTO is resolved)
+    \ingroup tinymatwriter
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_backend(const TinyMATWriterFile* mat);
+
+/** \brief compression level: variables are stored uncompressed (default)
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_COMPRESSION_NONE 0
+/** \brief compression level: fastest zlib compression
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_COMPRESSION_FAST 1
+/** \brief compression level: zlib's default trade-off between speed and size
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_COMPRESSION_DEFAULT 6
+/** \brief compression level: best (and slowest) zlib compression
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_COMPRESSION_BEST 9
+
+/*! \brief set the compression level for all following top-level variables in a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param level the zlib compression level \c TINYMAT_COMPRESSION_NONE (0) ... \c TINYMAT_COMPRESSION_BEST (9)
+    \return \c TRUE on success, \c FALSE if compression was requested, but the library was built without zlib-support
+
+    Each top-level variable (i.e. not the fields of a struct or the entries of a cell array) is stored in
+    its own \c miCOMPRESSED element, which MATLAB and Octave read natively. Compressed files require MATLAB 7 or later.
+
+    \see TinyMATWriter_setNextCompression()
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setCompression(TinyMATWriterFile* mat, int level);
+
+/*! \brief set the compression level for the next top-level variable only, overriding the level set with TinyMATWriter_setCompression()
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param level the zlib compression level \c TINYMAT_COMPRESSION_NONE (0) ... \c TINYMAT_COMPRESSION_BEST (9)
+    \return \c TRUE on success, \c FALSE if compression was requested, but the library was built without zlib-support
+
+    \code
+    TinyMATWriter_setNextCompression(mat, TINYMAT_COMPRESSION_NONE);
+    TinyMATWriter_writeMatrixND_colmajor(mat, "noise", noise, sizes, 2); // stored uncompressed
+    TinyMATWriter_writeMatrixND_colmajor(mat, "frame", frame, sizes, 2); // stored with the level of the file
+    \endcode
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setNextCompression(TinyMATWriterFile* mat, int level);
+
+/** \brief compression decision: the level set with TinyMATWriter_setCompression() or TinyMATWriter_setNextCompression() was used
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_LEVEL 0
+/** \brief compression decision: the variable name matched a rule added with TinyMATWriter_addCompressionRule()
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_RULE 1
+/** \brief compression decision: the variable was too small to be worth compressing, it is stored raw
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_SMALL 2
+/** \brief compression decision: the trial compression saved (almost) nothing, the variable is stored raw
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_INCOMPRESSIBLE 3
+/** \brief compression decision: the trial compression saved little, the variable is compressed with \c TINYMAT_COMPRESSION_FAST
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_POORLY_COMPRESSIBLE 4
+/** \brief compression decision: the trial compression saved a lot, the variable is compressed with the configured level
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_DECISION_COMPRESSIBLE 5
+
+/*! \brief describes how a top-level variable was stored (see TinyMATWriter_setCompressionReport() )
+    \ingroup tinymatwriter
+  */
+struct TinyMATWriterCompressionDecision {
+    /** \brief name of the variable */
+    const char* name;
+    /** \brief size of the uncompressed miMATRIX element in bytes */
+    uint64_t raw_size;
+    /** \brief number of bytes written to the file for this variable */
+    uint64_t stored_size;
+    /** \brief compression level that was used, \c TINYMAT_COMPRESSION_NONE if the variable is stored raw */
+    int level;
+    /** \brief why this level was chosen, one of \c TINYMAT_DECISION_... */
+    int reason;
+    /** \brief ratio (compressed/raw) of the trial compression, or \c -1 if there was none */
+    double sample_ratio;
+};
+
+/** \brief callback for TinyMATWriter_setCompressionReport()
+  * \ingroup tinymatwriter
+  */
+typedef void (*TinyMATWriterCompressionReportFunction)(const TinyMATWriterCompressionDecision* decision, void* userdata);
+
+/*! \brief sample the payload of each compressed top-level variable, to decide whether to store it raw, with fast or with the configured compression
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param enabled \c TRUE to enable the adaptive policy, \c FALSE to always use the configured level
+    \return \c TRUE on success, \c FALSE if the library was built without zlib-support
+
+    The adaptive policy only applies to variables with a level above \c TINYMAT_COMPRESSION_NONE. For each of them it runs
+    a trial compression of a sample from the start, middle and end of the variable and decides (see TinyMATWriter_setAdaptiveCompressionThresholds() ):
+      - variables smaller than \c min_size are stored raw (\c TINYMAT_DECISION_SMALL)
+      - if the sample does not shrink below \c raw_ratio, the variable is stored raw (\c TINYMAT_DECISION_INCOMPRESSIBLE)
+      - if the sample does not shrink below \c fast_ratio, it is compressed with \c TINYMAT_COMPRESSION_FAST (\c TINYMAT_DECISION_POORLY_COMPRESSIBLE)
+      - otherwise it is compressed with the configured level (\c TINYMAT_DECISION_COMPRESSIBLE)
+    .
+    Rules added with TinyMATWriter_addCompressionRule() take precedence. The decision is made in the compression thread, if
+    TinyMATWriter_setCompressionThreads() is used.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setAdaptiveCompression(TinyMATWriterFile* mat, int enabled);
+
+/*! \brief set the thresholds of the adaptive compression policy (see TinyMATWriter_setAdaptiveCompression() )
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param min_size variables with fewer bytes are stored raw (default: 256)
+    \param raw_ratio variables are stored raw, if the sample compresses to this fraction of its size or more (default: 0.9)
+    \param fast_ratio variables are compressed fast, if the sample compresses to this fraction of its size or more (default: 0.6)
+    \param sample_size number of bytes compressed for the trial (default: 48kB)
+    \return \c TRUE on success, \c FALSE if the parameters are invalid (e.g. \a raw_ratio < \a fast_ratio )
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setAdaptiveCompressionThresholds(TinyMATWriterFile* mat, uint64_t min_size, double raw_ratio, double fast_ratio, size_t sample_size=3*16*1024);
+
+/*! \brief store all top-level variables with a name matching \a pattern with compression \a level
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param pattern pattern for the variable name, which may contain the wildcards \c * (any sequence) and \c ? (any character)
+    \param level the zlib compression level \c TINYMAT_COMPRESSION_NONE (0) ... \c TINYMAT_COMPRESSION_BEST (9)
+    \return \c TRUE on success, \c FALSE if compression was requested, but the library was built without zlib-support
+
+    Rules are checked in the order they were added, the first match wins. Rules override all other compression settings.
+
+    \code
+    TinyMATWriter_addCompressionRule(mat, "raw_*", TINYMAT_COMPRESSION_NONE);   // noisy sensor data
+    TinyMATWriter_addCompressionRule(mat, "mask*", TINYMAT_COMPRESSION_BEST);
+    \endcode
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_addCompressionRule(TinyMATWriterFile* mat, const char* pattern, int level);
+
+/*! \brief removes all rules added with TinyMATWriter_addCompressionRule()
+    \ingroup tinymatwriter
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_clearCompressionRules(TinyMATWriterFile* mat);
+
+/*! \brief \a report is called for every compressed (or staged) top-level variable, with the decision how it was stored
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param report the callback, or \c NULL to stop reporting
+    \param userdata passed on to \a report
+
+    The callback is called from the writing thread, in the order of the variables in the file. Only variables that are
+    compressed, or that the policy may store compressed (see TinyMATWriter_addCompressionRule() ), are reported.
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_setCompressionReport(TinyMATWriterFile* mat, TinyMATWriterCompressionReportFunction report, void* userdata);
+
+/** \brief default threshold for TinyMATWriter_setCompressionStreaming(): 64MB
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_COMPRESSION_STREAMING_DEFAULT (64*1024*1024)
+
+/*! \brief compressed top-level arrays of at least \a threshold bytes are compressed while they are written, instead of staging them in memory first
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param threshold minimum size of the variable in bytes, \c 0 to always stage variables (default: \c TINYMAT_COMPRESSION_STREAMING_DEFAULT )
+    \return \c TRUE on success, \c FALSE if the library was built without zlib-support
+
+    Usually a compressed variable is first written uncompressed into a staging buffer and then compressed as a whole, which needs
+    memory for the raw and the compressed variable at the same time. Arrays written with TinyMATWriter_writeMatrixND_colmajor()
+    (and the functions based on it) above the threshold are instead fed into zlib in chunks, which write the compressed data
+    directly into the output, so the additional memory does not depend on the size of the variable.
+
+    Streamed variables are compressed in the calling thread, even if TinyMATWriter_setCompressionThreads() is used.
+    The adaptive compression policy (see TinyMATWriter_setAdaptiveCompression() ) samples the array data before it is written.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setCompressionStreaming(TinyMATWriterFile* mat, uint64_t threshold);
+
+/** \brief use as many compression threads as the system has cores (see TinyMATWriter_setCompressionThreads() ) */
+#define TINYMAT_COMPRESSION_THREADS_AUTO -1
+
+/*! \brief compress top-level variables in parallel on \a threads worker threads
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param threads number of worker threads, \c 0 or \c 1 compresses synchronously in the calling thread (default),
+                   \c TINYMAT_COMPRESSION_THREADS_AUTO uses one thread per core
+    \return \c TRUE on success, \c FALSE if more than one thread was requested, but the library was built without zlib- or thread-support
+
+    When a compressed top-level variable is complete, its (uncompressed) data is handed to a worker thread and the write-call
+    returns immediately. The compressed variables are committed to the file in the order of the API calls, so the resulting
+    file is byte-identical to the one written with synchronous compression. Uncompressed variables, TinyMATWriter_ftell(),
+    TinyMATWriter_data() and TinyMATWriter_close() wait for all outstanding compressions.
+
+    At most \c 2*threads variables are kept in memory while waiting for compression, after that the write-calls block.
+    Errors from the worker threads are reported as exceptions from the write-call that commits the variable.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setCompressionThreads(TinyMATWriterFile* mat, int threads);
+
+/** \brief string encoding: strings are UTF-8, invalid bytes are stored as Latin-1 characters (default, see TinyMATWriter_setStringEncoding() )
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_STRING_ENCODING_UTF8 1
+/** \brief string encoding: each byte is a Latin-1 (ISO 8859-1) character (see TinyMATWriter_setStringEncoding() )
+  * \ingroup tinymatwriter
+  */
+#define TINYMAT_STRING_ENCODING_LATIN1 2
+
+/*! \brief sets the encoding of the strings passed to TinyMATWriter_writeString(), TinyMATWriter_writeStringVector(), ...
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param encoding \c TINYMAT_STRING_ENCODING_UTF8 (default) or \c TINYMAT_STRING_ENCODING_LATIN1
+    \return \c TRUE on success
+
+    MATLAB stores characters as UTF-16 code units, so the length of a written char array is the number of UTF-16 code units of the string.
+    Runs of ASCII characters are widened with SSE2 directly into the output. Variable and field names are always written as they are.
+    The Qt functions (e.g. TinyMATWriter_writeQStringList() ) pass their strings on in this encoding.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setStringEncoding(TinyMATWriterFile* mat, int encoding);
+
+/*! \brief write a string into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the string to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const char* data);
+/*! \brief write a string into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the string to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const std::string& data);
+
+/*! \brief write a string into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the string to write
+    \param slen length of the string in bytes
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeString(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen);
+
+
+/*! \brief write an empty (double) matrix into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeEmptyMatrix(TinyMATWriterFile* mat, const char* name);
+
+
+
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// METHODS TO WRITE MATRICES
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \brief write a N-dimensional double matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional float matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const float* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional uint64_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint64_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional int64_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int64_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional uint32_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint32_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional int32_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int32_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional uint16_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint16_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional int16_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int16_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional uint8_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const uint8_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional int8_t matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const int8_t* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional bool matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const bool* data_real, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional complex double matrix in column-major form into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write (in column-major order), real and imaginary parts are interleaved (e.g. the output of an FFT)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+    The interleaved values are split with SSE2 shuffles directly into the real and imaginary part of the output buffer (or block-wise,
+    if the output goes into a file), so no planar copy of the array is needed. The templates TinyMATWriter_writeMatrixND_rowmajor(),
+    TinyMATWriter_writeMatrix2D_colmajor(), TinyMATWriter_writeMatrix2D_rowmajor() and TinyMATWriter_writeMatrixND_view() also accept
+    \c std::complex arrays, row-major arrays are split and transposed in a single pass.
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const std::complex<double>* data, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional complex float matrix in column-major form into a MAT-file (see the overload for \c std::complex<double> )
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write (in column-major order), real and imaginary parts are interleaved
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor(TinyMATWriterFile* mat, const char* name, const std::complex<float>* data, const int32_t* sizes, uint32_t ndims) ;
+
+/*! \brief write a N-dimensional logical array, given as packed bits in column-major order, into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param bits the array to write, element \c i is bit \c i%64 of \c bits[i/64] (i.e. the least significant bit comes first)
+    \param sizes number of entries in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+
+    The bits are expanded to the bytes of the MATLAB \c logical array with SSE2 directly into the output buffer (or block-wise,
+    if the output goes into a file), so a mask needs only 1/8 of the memory of a \c bool array.
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeLogicalBitsND_colmajor(TinyMATWriterFile* mat, const char* name, const uint64_t* bits, const int32_t* sizes, uint32_t ndims);
+
+/*! \brief write a sparse \c double or \c logical matrix, given in compressed sparse column (CSC) format, into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param rows number of rows of the matrix
+    \param cols number of columns of the matrix
+    \param colptr the entries of column \c c are \c colptr[c]...colptr[c+1]-1 (\a cols +1 values, starting with 0)
+    \param rowind (zero-based) row of each entry, ascending within each column
+    \param values value of each entry, or \c NULL to write a \c logical matrix, which is \c true at all entries
+
+    This is the layout of MATLAB's sparse matrices, so the arrays are written directly without a copy.
+
+    \throws std::runtime_error if \a colptr is not ascending or a row index is out of range or not ascending within its column or the matrix does not fit into 4 GB (the limit of a MAT v5 variable)
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeSparseCSC(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* colptr, const int32_t* rowind, const double* values);
+
+/*! \brief write a sparse \c double or \c logical matrix, given in compressed sparse row (CSR) format, into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param rows number of rows of the matrix
+    \param cols number of columns of the matrix
+    \param rowptr the entries of row \c r are \c rowptr[r]...rowptr[r+1]-1 (\a rows +1 values, starting with 0)
+    \param colind (zero-based) column of each entry, in any order within a row
+    \param values value of each entry, or \c NULL to write a \c logical matrix, which is \c true at all entries
+
+    The matrix is converted to CSC with a counting sort by column (in parallel for large matrices, see TinyMATWriter_setTransposeThreads() ),
+    which needs temporary memory for a copy of the entries.
+
+    \throws std::runtime_error if \a rowptr is not ascending or a column index is out of range or appears twice in a row or the matrix does not fit into 4 GB (the limit of a MAT v5 variable)
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeSparseCSR(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* rowptr, const int32_t* colind, const double* values);
+
+/*! \brief write a sparse \c double or \c logical matrix, given as list of coordinates (COO, triplet format), into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param rows number of rows of the matrix
+    \param cols number of columns of the matrix
+    \param rowind (zero-based) row of each entry
+    \param colind (zero-based) column of each entry
+    \param values value of each entry, or \c NULL to write a \c logical matrix, which is \c true at all entries
+    \param nnz number of entries
+
+    The entries may be given in any order. Like MATLAB's \c sparse(i,j,v) , the values of entries with the same coordinates are summed.
+    The matrix is converted to CSC with two counting sorts, by row and by column (in parallel for large matrices, see TinyMATWriter_setTransposeThreads() ),
+    which need temporary memory for two copies of the entries.
+
+    \throws std::runtime_error if an index is out of range or the matrix does not fit into 4 GB (the limit of a MAT v5 variable)
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeSparseCOO(TinyMATWriterFile* mat, const char* name, int32_t rows, int32_t cols, const int32_t* rowind, const int32_t* colind, const double* values, size_t nnz);
+
+
+
+/*! \brief write a single (numeric) value (as 1x1 matrix) into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the value to write
+
+  */
+template<typename T>
+inline void TinyMATWriter_writeValue(TinyMATWriterFile* mat, const char* name, T data_real) {
+  TinyMATWriter_writeVectorAsColumn(mat, name, &data_real, 1);
+}
+
+
+/*! \brief transposes \a nmatrices consecutive row-major matrices from \a src into column-major order in \a dst
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file, which provides the number of threads (see TinyMATWriter_setTransposeThreads() ), may be \c NULL
+    \param dst output array with \a cols * \a rows * \a nmatrices elements, must not overlap \a src
+    \param src input array, the element \c [m][r][c] is moved to \c dst[m][c][r]
+    \param element_size size of one element in bytes
+    \param cols number of columns of each matrix
+    \param rows number of rows of each matrix
+    \param nmatrices number of matrices
+
+    The matrices are transposed tile by tile, where the tile size depends on \a element_size, so source and destination tile stay in the cache.
+    On x86 CPUs, tiles of 1-, 2-, 4- and 8-byte elements (this includes \c bool ) are transposed in SSE2 registers, otherwise by scalar code.
+    Large arrays are split into bands of tiles, which are transposed in parallel.
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_transposeMatrices(TinyMATWriterFile* mat, void* dst, const void* src, uint32_t element_size, uint32_t cols, uint32_t rows, uint32_t nmatrices);
+
+/** \brief use as many transpose threads as the system has cores (see TinyMATWriter_setTransposeThreads() ) */
+#define TINYMAT_TRANSPOSE_THREADS_AUTO -1
+
+/*! \brief sets the number of threads, that transpose large row-major arrays (see TinyMATWriter_transposeMatrices() )
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param threads number of threads, \c 1 transposes in the calling thread,
+                   \c TINYMAT_TRANSPOSE_THREADS_AUTO uses one thread per core (default)
+    \return \c TRUE on success, \c FALSE if more than one thread was requested, but the library was built without thread-support
+
+    Arrays below a few megabytes are always transposed in the calling thread.
+  */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_setTransposeThreads(TinyMATWriterFile* mat, int threads);
+
+/** \brief conversion while writing: \c double values are stored as \c single array (see TinyMATWriterConversion ) */
+#define TINYMAT_CONVERT_SINGLE 1
+/** \brief conversion while writing: values are quantized to an \c int16 array (see TinyMATWriterConversion ) */
+#define TINYMAT_CONVERT_INT16 2
+/** \brief conversion while writing: values are quantized to an \c uint16 array (see TinyMATWriterConversion ) */
+#define TINYMAT_CONVERT_UINT16 3
+
+/*! \brief describes how a \c double or \c float array is converted while it is written (see TinyMATWriter_writeMatrixND_colmajor_converted() )
+    \ingroup tinymatwriter
+
+    For \c TINYMAT_CONVERT_INT16 and \c TINYMAT_CONVERT_UINT16, each value \c x is stored as \c q=round((x-offset)/scale) , saturated to the
+    range of the integer type (NaN is stored as the smallest value), i.e. MATLAB restores the values with \c double(q)*scale+offset .
+    Like MATLAB's \c round() , ties are rounded away from zero (e.g. -6.5 is stored as -7).
+    \c TINYMAT_CONVERT_SINGLE ignores \c scale and \c offset .
+  */
+struct TinyMATWriterConversion {
+    inline TinyMATWriterConversion(int type_=TINYMAT_CONVERT_SINGLE, double scale_=1.0, double offset_=0.0) :
+      type(type_),
+      scale(scale_),
+      offset(offset_)
+    {
+    }
+
+    /** \brief the type of the stored array (\c TINYMAT_CONVERT_SINGLE, \c TINYMAT_CONVERT_INT16 or \c TINYMAT_CONVERT_UINT16 ) */
+    int type;
+    /** \brief quantization step, i.e. the value of one integer unit */
+    double scale;
+    /** \brief value, that is stored as 0 */
+    double offset;
+};
+
+/*! \brief describes how the array passed to TinyMATWriter_writeMatrixND_layout() is stored in memory and how it is converted
+           while it is written
+    \ingroup tinymatwriter
+
+    The default is a dense array in column-major order, that is copied into the file. The templates TinyMATWriter_writeMatrixND_rowmajor(),
+    TinyMATWriter_writeMultiChannelMatrixND_rowmajor(), TinyMATWriter_writeMatrixND_permuted(), TinyMATWriter_writeMatrixND_view(),
+    TinyMATWriter_writeMatrixND_colmajor_converted() and TinyMATWriter_writeMatrixND_colmajor_ref() fill this in, so they do not need
+    a temporary copy of the array.
+  */
+struct TinyMATWriterArrayLayout {
+    inline TinyMATWriterArrayLayout() :
+      transposed(false),
+      channels(1),
+      strides(NULL),
+      conversion(NULL),
+      reference(false)
+    {
+    }
+
+    /** \brief the array is given in row-major order and transposed while it is written (the sizes passed to TinyMATWriter_writeMatrixND_layout()
+               are those of the column-major result). The matrices are transposed directly into the output buffer, or block-wise,
+               if the output goes into a file. */
+    bool transposed;
+    /** \brief for \c transposed arrays: each element consists of this many interleaved channels (e.g. RGBRGB...), which are split into planes
+               (the last dimension) while the array is transposed (with SSE2 for 3 and 4 channels of 8, 16 and 32 bits) */
+    uint32_t channels;
+    /** \brief if not \c NULL : distance (in bytes) between consecutive elements along each axis of the written array, which is gathered into
+               column-major order while it is written (see TinyMATWriter_writeMatrixND_view() ). The strides have to be non-negative
+               multiples of the element size. */
+    const int64_t* strides;
+    /** \brief if not \c NULL : the \c double or \c float array is converted as described while it is written (the class of the written array
+               is that of the conversion). The values are converted with SSE2 directly into the output buffer, or block-wise,
+               if the output goes into a file. This can be combined with \c transposed , but not with \c strides . */
+    const TinyMATWriterConversion* conversion;
+    /** \brief the array may be referenced instead of copied (zero-copy mode, see TinyMATWriter_writeMatrixND_colmajor_ref() ) */
+    bool reference;
+};
+
+/*! \brief write a N-dimensional \c double array, that is stored as described by \a layout , into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write
+    \param sizes number of entries in each dimension of the written array {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+    \param layout memory layout of \a data_real and conversion while it is written
+
+    \throws std::runtime_error if \a layout is invalid for the array (e.g. a stride is not a multiple of the element size, an unknown
+            conversion type, a quantization \c scale, that is 0 or not finite, or a conversion of an integer or complex array),
+            in this case nothing is written
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c float array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const float* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c uint64_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const uint64_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c int64_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const int64_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c uint32_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const uint32_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c int32_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const int32_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c uint16_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const uint16_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c int16_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const int16_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c uint8_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const uint8_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c int8_t array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const int8_t* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional \c bool array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const bool* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional complex \c double array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+
+    Complex arrays can not be converted or split into channels while they are written.
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const std::complex<double>* data, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+/*! \brief write a N-dimensional complex \c float array, that is stored as described by \a layout , into a MAT-file (see the overload for \c double )
+    \ingroup tinymatwriter
+
+    Complex arrays can not be converted or split into channels while they are written.
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_layout(TinyMATWriterFile* mat, const char* name, const std::complex<float>* data, const int32_t* sizes, uint32_t ndims, const TinyMATWriterArrayLayout& layout);
+
+/*! \brief describes a strided N-dimensional array (e.g. a submatrix, a region of interest or an image with padded rows), that is written
+           without copying it first (see TinyMATWriter_writeMatrixND_view() )
+    \ingroup tinymatwriter
+ */
+template<typename T>
+struct TinyMATWriterView {
+    /** \brief address of element (0,0,...) */
+    const T* data;
+    /** \brief sizes of the axes of the array in MATLAB's order, i.e. {rows, cols, ...} */
+    const int32_t* sizes;
+    /** \brief distance (in bytes) between consecutive elements along each axis, e.g. {row step, sizeof(T)} for a row-major matrix */
+    const int64_t* strides;
+    /** \brief number of axes */
+    uint32_t ndims;
+};
+
+/*! \brief write a strided N-dimensional array (see TinyMATWriterView ) into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param view the array to write
+
+    The elements are gathered directly into the output, the fastest kernel is chosen for the stride pattern: contiguous runs are copied,
+    an axis, which is contiguous in memory, is transposed in tiles against the first axis (see TinyMATWriter_writeMatrixND_permuted() ).
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_view(TinyMATWriterFile* mat, const char* name, const TinyMATWriterView<T>& view) {
+    TinyMATWriterArrayLayout layout;
+    layout.strides=view.strides;
+    TinyMATWriter_writeMatrixND_layout(mat, name, view.data, view.sizes, view.ndims, layout);
+}
+
+/*! \brief write a N-dimensional array with permuted axes into a MAT-file, i.e. the MATLAB array \c permute(data,perm+1)
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write, the first axis varies fastest (i.e. for C-order tensors, \a sizes lists the axes in reverse order)
+    \param sizes sizes of the \a ndims axes of \a data_real
+    \param ndims number of axes
+    \param perm axis \c i of the written array is axis \c perm[i] of \a data_real (zero-based)
+
+    The axes are permuted in a single pass directly into the output: if an axis is contiguous in \a data_real, it is transposed against
+    the first written axis in tiles (in parallel for large arrays, see TinyMATWriter_setTransposeThreads() ).
+    E.g. a C-order NHWC tensor has \c sizes={C,W,H,N} and is written as a HxWxCxN array with \c perm={2,1,0,3} .
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_permuted(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, const uint32_t* perm) {
+    if (!data_real || !sizes || !perm || ndims<=0) {
+        TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, sizes, ndims);
+        return;
+    }
+    // axis i of the written array is gathered with the stride of axis perm[i] of data_real
+    std::vector<int32_t> siz(ndims);
+    std::vector<int64_t> strides(ndims);
+    std::vector<bool> used(ndims, false);
+    for (uint32_t i=0; i<ndims; i++) {
+        if (perm[i]>=ndims || used[perm[i]]) throw std::runtime_error("invalid permutation of the dimensions of an array");
+        used[perm[i]]=true;
+        siz[i]=sizes[perm[i]];
+        strides[i]=sizeof(T);
+        for (uint32_t k=0; k<perm[i]; k++) strides[i]*=sizes[k];
+    }
+    TinyMATWriterArrayLayout layout;
+    layout.strides=strides.data();
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, siz.data(), ndims, layout);
+}
+
+/*! \brief writes the row-major array \a data_real (see TinyMATWriter_writeMatrixND_rowmajor() ), converted as given by \a layout
+    \ingroup tinymatwriter
+    \internal
+
+    \c layout.transposed is set, if \a data_real has to be transposed.
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_rowmajor_layout(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, TinyMATWriterArrayLayout layout) {
+    int32_t* siz=NULL;
+    bool transpose=false;
+    if (data_real && sizes && ndims>1) {
+        uint32_t nentries=1;
+        uint32_t nonSingularDimensions=0;
+        for (uint32_t i=0; i<ndims; i++) {
+            if (i==0) {
+                nentries=sizes[0];
+            } else {
+                nentries=nentries*sizes[i];
+            }
+            if (sizes[i]>1) nonSingularDimensions++;
+        }
+        if (nentries>0) {
+            siz=new int32_t[ndims];//=(int32_t*)malloc(ndims*sizeof(int32_t));
+            for (uint32_t i=0; i<ndims; i++) siz[i]=sizes[i];
+            if (ndims>1) {
+                siz[0]=sizes[1];
+                siz[1]=sizes[0];
+            }
+            // a simple vector (nonSingularDimensions<=1) is the same in row- and column-major order
+            transpose=(nonSingularDimensions>1);
+        }
+
+    }
+    if (transpose) {
+        // the array is transposed while it is written, so no transposed copy is needed
+        layout.transposed=true;
+        TinyMATWriter_writeMatrixND_layout(mat, name, data_real, siz, ndims, layout);
+    } else {
+        TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, layout);
+    }
+    if (siz) delete[] siz;
+}
+
+/*! \brief write a N-dimensional double  matrix  into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... }
+    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
+    \param ndims number of dimensions
+
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims) {
+    TinyMATWriter_writeMatrixND_rowmajor_layout(mat, name, data_real, sizes, ndims, TinyMATWriterArrayLayout());
+}
+
+
+/*! \brief writes the scale and offset of a quantized array \a name as the scalars \c name_scale and \c name_offset
+    \ingroup tinymatwriter
+    \internal
+  */
+inline void TinyMATWriter_writeConversionScalars(TinyMATWriterFile* mat, const char* name, const TinyMATWriterConversion& conversion) {
+    if (name && conversion.type!=TINYMAT_CONVERT_SINGLE) {
+        const int32_t siz[2]={1, 1};
+        TinyMATWriter_writeMatrixND_colmajor(mat, (std::string(name)+"_scale").c_str(), &conversion.scale, siz, 2);
+        TinyMATWriter_writeMatrixND_colmajor(mat, (std::string(name)+"_offset").c_str(), &conversion.offset, siz, 2);
+    }
+}
+
+/*! \brief write a N-dimensional \c double or \c float array (in column-major order), that is converted to \c single or quantized to
+           \c int16 / \c uint16 while it is written
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write
+    \param sizes number of entries in each dimension
+    \param ndims number of dimensions
+    \param conversion the type of the written array and the quantization (see TinyMATWriterConversion )
+
+    For quantized arrays, \c conversion.scale and \c conversion.offset are written as the scalars \c name_scale and \c name_offset
+    after the array, so \c double(name)*name_scale+name_offset restores the values. No converted copy of the array is made.
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_colmajor_converted(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterConversion& conversion) {
+    TinyMATWriterArrayLayout layout;
+    layout.conversion=&conversion;
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, layout);
+    TinyMATWriter_writeConversionScalars(mat, name, conversion);
+}
+
+/*! \brief like TinyMATWriter_writeMatrixND_colmajor_converted(), but \a data_real is given in row-major order (see TinyMATWriter_writeMatrixND_rowmajor() )
+    \ingroup tinymatwriter
+
+    The array is transposed in blocks, which are converted while they are copied into the output.
+  */
+template<typename T>
+inline void TinyMATWriter_writeMatrixND_rowmajor_converted(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, const TinyMATWriterConversion& conversion) {
+    TinyMATWriterArrayLayout layout;
+    layout.conversion=&conversion;
+    TinyMATWriter_writeMatrixND_rowmajor_layout(mat, name, data_real, sizes, ndims, layout);
+    TinyMATWriter_writeConversionScalars(mat, name, conversion);
+}
+
+/*! \brief write a N-dimensional matrix with C color channels (e.g. C=3 RGBRGBRGB...) into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... },
+                     where each elements has the channels in order C2C2C3C1C2C3...
+    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
+    \param ndims number of dimensions
+    \param c number of channels
+
+    This function will actually write an ndims+1-dimensional matrix, where the outer-most dimension is the number
+    of channels. The input data is then separated into planes!
+
+  */
+template<typename T>
+inline void TinyMATWriter_writeMultiChannelMatrixND_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims, uint32_t c) {
+    uint32_t npixels=(data_real && sizes && ndims>1)?1:0;
+    for (uint32_t i=0; i<ndims && npixels>0; i++) npixels=npixels*sizes[i];
+    if (c==1) {
+      TinyMATWriter_writeMatrixND_rowmajor( mat, name, data_real, sizes, ndims);
+    } else if (npixels>0) {
+        // channels are split into planes while the array is transposed into the file, so no temporary copy is needed
+        int32_t* siz=(int32_t*)malloc((ndims+1)*sizeof(int32_t));
+        for (uint32_t i=0; i<ndims; i++) siz[i]=sizes[i];
+        siz[0]=sizes[1];
+        siz[1]=sizes[0];
+        siz[ndims]=c;
+        TinyMATWriterArrayLayout layout;
+        layout.transposed=true;
+        layout.channels=c;
+        TinyMATWriter_writeMatrixND_layout(mat, name, data_real, siz, ndims+1, layout);
+        free(siz);
+    } else {
+        uint32_t nentries=1;
+        int32_t* siz=(int32_t*)malloc((ndims+1)*sizeof(int32_t));
+        for (uint32_t i=0; i<ndims; i++) {
+            if (i==0) {
+                nentries=sizes[0];
+            } else {
+              nentries=nentries*sizes[i];
+            }
+            siz[i]=sizes[i];
+        }
+        siz[ndims]=c;
+        T* dat=(T*)calloc(nentries*c,sizeof(T));
+        uint32_t j=0;
+        // resort array into planes
+        for (uint32_t i=0; i<nentries; i++) {
+          for (uint32_t ci=0; ci<c; ci++) {
+            dat[ci*nentries+i]=data_real[j];
+            j++;
+          }
+        }
+        TinyMATWriter_writeMatrixND_rowmajor( mat, name, dat, siz, ndims+1);
+        free(dat);
+        free(siz);
+    }
+}
+
+
+
+/*! \brief write a N-dimensional matrix with C color channels (e.g. C=3 RGBRGBRGB...) into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order) {M1row1, M1row2, ..., M1rowC, M2row1, M2row2, ... },
+                     where each elements has the channels in order C2C2C3C1C2C3...
+    \param sizes number of entries in each dimension {cols, rows, matrices, ...}
+    \param ndims number of dimensions
+    \param c number of channels
+
+    This function will actually write an ndims+1-dimensional matrix, where the outer-most dimension is the number
+    of channels. The input data is then separated into planes!
+
+  */
+template<typename T>
+inline void TinyMATWriter_writeMultiChannelMatrix2D_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real,  int32_t cols, int32_t rows, uint32_t c) {
+  int32_t dims[2]={rows, cols};
+  TinyMATWriter_writeMultiChannelMatrix2D_rowmajor(mat, name, data_real, dims, 2, c);
+}
+
+
+/*! \brief write a 2-dimensional double matrix in column-major order into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param cols number of columns
+	\param rows number of rows
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrix2D_colmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t cols, int32_t rows) {
+    int32_t siz[2]={rows, cols};
+    TinyMATWriter_writeMatrixND_colmajor(mat, name, data_real, siz, 2);
+}
+
+/*! \brief write a N-dimensional array in column-major order into a MAT-file, without copying the data (zero-copy mode)
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in column-major order)
+    \param sizes array with the sizes of the dimensions
+    \param ndims number of dimensions
+
+    \warning \a data_real has to stay valid and unchanged until the file is closed!
+
+    With \c TINYMAT_BACKEND_MEMORY an uncompressed top-level array is not copied into the memory buffer, which only receives
+    its headers. TinyMATWriter_close() assembles the file from both with a single \c writev(), so the data is copied once
+    instead of twice. TinyMATWriter_data() and TinyMATWriter_closeAndTakeBuffer() have to copy the referenced arrays into the
+    buffer, as they return one contiguous block of memory. In all other cases this is the same as TinyMATWriter_writeMatrixND_colmajor().
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrixND_colmajor_ref(TinyMATWriterFile* mat, const char* name, const T* data_real, const int32_t* sizes, uint32_t ndims) {
+    TinyMATWriterArrayLayout layout;
+    layout.reference=true;
+    TinyMATWriter_writeMatrixND_layout(mat, name, data_real, sizes, ndims, layout);
+}
+
+/*! \brief write a 2-dimensional matrix in column-major order into a MAT-file, without copying the data (see TinyMATWriter_writeMatrixND_colmajor_ref() )
+    \ingroup tinymatwriter
+
+    \warning \a data_real has to stay valid and unchanged until the file is closed!
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrix2D_colmajor_ref(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t cols, int32_t rows) {
+    int32_t siz[2]={rows, cols};
+    TinyMATWriter_writeMatrixND_colmajor_ref(mat, name, data_real, siz, 2);
+}
+
+/*! \brief write a 2-dimensional double matrix in row-major order into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order)
+    \param cols number of columns
+    \param rows number of rows
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrix2D_rowmajor(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t cols, int32_t rows) {
+    int32_t siz[2]={cols, rows};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
+}
+
+/*! \brief write a 2x2-dimensional double matrix with entries given in row-major order directly as parameters into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrix2x2(TinyMATWriterFile* mat, const char* name, T m11, T m12, T m21, T m22) {
+    int32_t siz[2]={2, 2};
+    T data[4]={m11,m12,m21,m22};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+/*! \brief write a 3x3-dimensional double matrix with entries given in row-major order directly as parameters into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeMatrix3x3(TinyMATWriterFile* mat, const char* name, T m11, T m12, T m13, T m21, T m22, T m23, T m31, T m32, T m33) {
+    int32_t siz[2]={3,3};
+    T data[9]={m11,m12,m13,m21,m22,m23,m31,m32,m33};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+
+/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order)
+    \param cols number of columns
+    \param rows number of rows
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t rows) {
+    int32_t siz[2]={1, rows};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
+}
+
+
+/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file with data directly as parameter direct
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param d1 first entry
+    \param d2 second entry
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2) {
+    int32_t siz[2]={1,2};
+    T data[2]={d1, d2};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3) {
+    int32_t siz[2]={1,3};
+    T data[]={d1, d2, d3};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4) {
+    int32_t siz[2]={1,4};
+    T data[]={d1, d2, d3, d4};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5) {
+    int32_t siz[2]={1,5};
+    T data[]={d1, d2, d3, d4, d5};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6) {
+    int32_t siz[2]={1,6};
+    T data[]={d1, d2, d3, d4, d5, d6};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7) {
+    int32_t siz[2]={1,7};
+    T data[]={d1, d2, d3, d4, d5, d6, d7};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8) {
+    int32_t siz[2]={1,8};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9) {
+    int32_t siz[2]={1,9};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10) {
+    int32_t siz[2]={1, 10};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10, T d11) {
+    int32_t siz[2]={1,11};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsRow(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10, T d11, T d12) {
+    int32_t siz[2]={1,12};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+
+/*! \brief write a 1-dimensional double vector as a column-vector into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_real the array to write (in row-major order)
+    \param cols number of columns
+    \param rows number of rows
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, const T* data_real, int32_t rows) {
+    int32_t siz[2]={rows, 1};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data_real, siz, 2);
+}
+
+/*! \brief write a 1-dimensional double vector as a row-vector into a MAT-file with data directly as parameter direct
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param d1 first entry
+    \param d2 second entry
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2) {
+    int32_t siz[2]={2,1};
+    T data[2]={d1, d2};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3) {
+    int32_t siz[2]={3,1};
+    T data[]={d1, d2, d3};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4) {
+    int32_t siz[2]={4,1};
+    T data[]={d1, d2, d3, d4};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5) {
+    int32_t siz[2]={5,1};
+    T data[]={d1, d2, d3, d4, d5};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6) {
+    int32_t siz[2]={6,1};
+    T data[]={d1, d2, d3, d4, d5, d6};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7) {
+    int32_t siz[2]={7,1};
+    T data[]={d1, d2, d3, d4, d5, d6, d7};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8) {
+    int32_t siz[2]={8,1};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9) {
+    int32_t siz[2]={9,1};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+template<typename T>
+inline  void TinyMATWriter_writeVectorAsColumn(TinyMATWriterFile* mat, const char* name, T d1, T d2, T d3, T d4, T d5, T d6, T d7, T d8, T d9, T d10) {
+    int32_t siz[2]={10,1};
+    T data[]={d1, d2, d3, d4, d5, d6, d7, d8, d9, d10};
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, data, siz, 2);
+}
+
+
+/*! \brief write a 1-dimensional vector/list/... of values as a row-vector into a MAT-file
+    \ingroup tinymatwriter
+    \internal
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_vec the array to write. This container has to implement the function size() and
+                    an iterator with tool-functions begin() and end()
+
+
+    \note This function copies the contents of the container into a temporary array, which is then saved to 
+    the file. Use TinyMATWriter_writeContainerAsColumn() to use potential performance-optimizations for some 
+    container types.
+  */
+template<typename T>
+inline  void TinyMATWriter_writeContainerAsRow_internalCopy(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
+    int32_t siz[2]={1, (int32_t)data_vec.size()};
+    auto tmp=static_cast<typename T::value_type*>(malloc(data_vec.size()*sizeof(typename T::value_type)));
+    int i=0;
+    for (auto it=data_vec.begin(); it!=data_vec.end(); ++it) {
+      tmp[i]=*it;
+      i++;
+    }
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
+    free(tmp);
+}
+
+/*! \brief write a 1-dimensional vector/list/... of values as a column-vector into a MAT-file
+    \ingroup tinymatwriter
+    \internal
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_vec the array to write. This container has to implement the function size() and
+                    an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
+                    has to be integer numbers or floats
+
+    \note This function copies the contents of the container into a temporary array, which is then saved to 
+    the file. Use TinyMATWriter_writeContainerAsColumn() to use potential performance-optimizations for some 
+    container types.
+  */
+template<typename T>
+inline  void TinyMATWriter_writeContainerAsColumn_internalCopy(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
+    int32_t siz[2]={(int32_t)data_vec.size(), 1};
+    auto tmp=static_cast<typename T::value_type*>(malloc(data_vec.size()*sizeof(typename T::value_type)));
+    int i=0;
+    for (auto it=data_vec.begin(); it!=data_vec.end(); ++it) {
+      tmp[i]=*it;
+      i++;
+    }
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
+    free(tmp);
+}
+
+
+/*! \brief write a 1-dimensional vector/list/... of values as a row-vector into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_vec the array to write. This container has to implement the function size() and
+                    an iterator with tool-functions begin() and end()
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
+    TinyMATWriter_writeContainerAsRow_internalCopy<T>(mat, name, data_vec);
+}
+
+/*! \brief write a 1-dimensional vector/list/... of values as a column-vector into a MAT-file
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data_vec the array to write. This container has to implement the function size() and
+                    an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
+                    has to be integer numbers or floats
+
+  */
+template<typename T>
+inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const T& data_vec) {
+    TinyMATWriter_writeContainerAsColumn_internalCopy(mat, name, data_vec);
+}
+
+#if (__cplusplus > 199711L) || ( defined(_MSC_VER) && ( _MSC_VER >= 1700 ) ) 
+
+  /*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
+      \ingroup tinymatwriter
+
+      This is a performance-optimized specialization.
+
+      \param mat the MAT-file to write into
+      \param name variable name for the new array
+      \param data_vec the array to write. This container has to implement the function size() and
+                      an iterator with tool-functions begin() and end()
+
+
+    */
+  template<typename T>
+  inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<T>& data_vec) {
+      if (data_vec.size()<=0) TinyMATWriter_writeEmptyMatrix(mat, name);
+      int32_t siz[2]={1, (int32_t)data_vec.size()};
+      const T* tmp=data_vec.data(); 
+      TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
+  }
+
+
+  /*! \brief packs a std::vector<bool> into 64-bit words for TinyMATWriter_writeLogicalBitsND_colmajor()
+      \ingroup tinymatwriter
+      \internal
+    */
+  inline std::vector<uint64_t> TinyMATWriter_packBits(const std::vector<bool>& data_vec) {
+      std::vector<uint64_t> bits((data_vec.size()+63)/64, 0);
+      for (size_t i=0; i<data_vec.size(); i++) {
+          if (data_vec[i]) bits[i/64]|=static_cast<uint64_t>(1)<<(i%64);
+      }
+      return bits;
+  }
+
+  /*! \brief write a 1-dimensional std::vector<bool> of values as a row-vector into a MAT-file
+      \ingroup tinymatwriter
+
+      \param mat the MAT-file to write into
+      \param name variable name for the new array
+      \param data_vec the array to write. This container has to implement the function size() and
+                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
+                      has to be integer numbers or floats
+
+    */
+  template<>
+  inline  void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<bool>& data_vec) {
+      int32_t siz[2]={1, (int32_t)data_vec.size()};
+      const std::vector<uint64_t> bits=TinyMATWriter_packBits(data_vec);
+      TinyMATWriter_writeLogicalBitsND_colmajor(mat, name, bits.data(), siz, 2);
+  }
+
+  /*! \brief write a 1-dimensional std::vector of values as a column-vector into a MAT-file
+      \ingroup tinymatwriter
+
+      This is a performance-optimized specialization.
+
+      \param mat the MAT-file to write into
+      \param name variable name for the new array
+      \param data_vec the array to write. This container has to implement the function size() and
+                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
+                      has to be integer numbers or floats
+
+    */
+  template<typename T>
+  inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const std::vector<T>& data_vec) {
+    if (data_vec.size() <= 0) {
+      TinyMATWriter_writeEmptyMatrix(mat, name);
+      return;
+    } // if
+    int32_t siz[2] = { (int32_t)data_vec.size(), 1 };
+    const T* tmp = data_vec.data();
+    TinyMATWriter_writeMatrixND_rowmajor(mat, name, tmp, siz, 2);
+  }
+
+  /*! \brief write a 1-dimensional std::vector<bool> of values as a column-vector into a MAT-file
+      \ingroup tinymatwriter
+
+      \param mat the MAT-file to write into
+      \param name variable name for the new array
+      \param data_vec the array to write. This container has to implement the function size() and
+                      an iterator with tool-functions begin() and end(). Data-Items (T::value_type)
+                      has to be integer numbers or floats
+
+    */
+  template<>
+  inline  void TinyMATWriter_writeContainerAsColumn(TinyMATWriterFile* mat, const char* name, const std::vector<bool>& data_vec) {
+      int32_t siz[2]={(int32_t)data_vec.size(), 1};
+      const std::vector<uint64_t> bits=TinyMATWriter_packBits(data_vec);
+      TinyMATWriter_writeLogicalBitsND_colmajor(mat, name, bits.data(), siz, 2);
+  }
+
+
+  /*! \brief write a std::vector of std::vector (vecor of row-vectors) as a matrix into a MAT-file
+  \ingroup tinymatwriter
+
+  \param mat the MAT-file to write into
+  \param name variable name for the new array
+  \param data_mat the array to write.
+
+  */
+  template<class T>
+  inline  void TinyMATWriter_writeRowsContainerAsMatrix(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<T> >& data_mat) {
+    if (data_mat.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+
+    int32_t rows = data_mat.size();
+    int32_t cols = 0;
+    for (size_t i = 0; i < data_mat.size(); i++) cols = std::max<int32_t>(cols, data_mat[i].size());
+
+    T* tmp = (T*)malloc(rows*cols * sizeof(T));
+    for (int32_t i = 0; i<rows*cols; i++) tmp[i] = 0;
+    int r = 0;
+    int c = 0;
+    for (auto it = data_mat.begin(); it != data_mat.end(); ++it) {
+      c = 0;
+      for (auto itc = it->begin(); itc != it->end(); ++itc) {
+        tmp[c*rows + r] = *itc;
+        c++;
+      }
+      r++;
+    }
+    int32_t siz[2] = { rows, cols };
+    TinyMATWriter_writeMatrixND_colmajor(mat, name, tmp, siz, 2);
+    free(tmp);
+  }
+
+
+  /*! \brief write a std::vector of std::vector (vecor of col-vectors) as a matrix into a MAT-file
+  \ingroup tinymatwriter
+
+  \param mat the MAT-file to write into
+  \param name variable name for the new array
+  \param data_mat the array to write.
+
+  */
+  template<class T>
+  inline  void TinyMATWriter_writeColsContainerAsMatrix(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<T> >& data_mat) {
+    if (data_mat.size() <= 0) TinyMATWriter_writeEmptyMatrix(mat, name);
+
+    int32_t rows = 0;
+    int32_t cols = data_mat.size();
+    for (size_t i = 0; i < data_mat.size(); i++) rows = std::max<int32_t>(rows, data_mat[i].size());
+
+    T* tmp = (T*)malloc(rows*cols * sizeof(T));
+    for (int32_t i = 0; i<rows*cols; i++) tmp[i] = 0;
+    int r = 0;
+    int c = 0;
+    for (auto it = data_mat.begin(); it != data_mat.end(); ++it) {
+      r = 0;
+      for (auto itc = it->begin(); itc != it->end(); ++itc) {
+        tmp[c*rows + r] = *itc;
+        r++;
+      }
+      c++;
+    }
+    int32_t siz[2] = { rows, cols };
+    TinyMATWriter_writeMatrixND_colmajor(mat, name, tmp, siz, 2);
+    free(tmp);
+  }
+#endif
+
+/*! \brief write a 1-dimensional std::list<std::string> into a MAT-file as a cell array
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStringList(TinyMATWriterFile* mat, const char* name, const std::list<std::string>& data);
+
+/*! \brief write a 1-dimensional std::vector<std::string> into a MAT-file as a cell array
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStringVector(TinyMATWriterFile* mat, const char* name, const std::vector<std::string>& data);
+
+/*! \brief write a 1-dimensional std::list<double> into a MAT-file as a 1D matrix
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeDoubleList(TinyMATWriterFile* mat, const char* name, const std::list<double>& data, bool columnVector=false);
+
+/*! \brief write a 1-dimensional std::vector<double> into a MAT-file as a 1D matrix
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeDoubleVector(TinyMATWriterFile* mat, const char* name, const std::vector<double>& data, bool columnVector=false);
+
+
+/*! \brief write a a std::map<std::string,double> into a MAT-file as a struct
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+    \param columnVector if \C true, data is stored as a column vector ... otherwise as a row-vetor
+
+  */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeStruct(TinyMATWriterFile* mat, const char* name, const std::map<std::string, double>& data);
+
+
+
+
+/*! \brief start to write a struct-element
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name variable name for the new array (max. len: 31 characters)
+*/
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_startStruct(TinyMATWriterFile *mat, const char *name);
+/*! \brief end to write a struct-element
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name struc the structure object to finish
+*/
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_endStruct(TinyMATWriterFile* mat);
+
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c double values */
+#define TINYMAT_FIELD_DOUBLE 1
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c float values, stored as \c single */
+#define TINYMAT_FIELD_SINGLE 2
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c int8_t values */
+#define TINYMAT_FIELD_INT8 3
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c uint8_t values */
+#define TINYMAT_FIELD_UINT8 4
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c int16_t values */
+#define TINYMAT_FIELD_INT16 5
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c uint16_t values */
+#define TINYMAT_FIELD_UINT16 6
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c int32_t values */
+#define TINYMAT_FIELD_INT32 7
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c uint32_t values */
+#define TINYMAT_FIELD_UINT32 8
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c int64_t values */
+#define TINYMAT_FIELD_INT64 9
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c uint64_t values */
+#define TINYMAT_FIELD_UINT64 10
+/** \brief type of a struct array field (see TinyMATWriterStructField ): \c bool values, stored as \c logical */
+#define TINYMAT_FIELD_LOGICAL 11
+/** \brief type of a struct array field (see TinyMATWriterStructField ): one zero-terminated string (<tt>const char*</tt>, may be \c NULL ) per element, stored as \c char (see TinyMATWriter_setStringEncoding() ) */
+#define TINYMAT_FIELD_STRING 12
+
+/*! \brief one field of a struct array, given as a column with the values of all elements (see TinyMATWriter_writeStructArray() )
+    \ingroup tinymatwriter
+
+    \a data holds \a count values for every element of the struct array, element after element in column-major order of the struct array,
+    i.e. the values of element \c i start at \c data+i*count . Each element stores them as 1 x \a count row vector.
+    For \c TINYMAT_FIELD_STRING, \a data is an array of <tt>const char*</tt> with one string per element and \a count is ignored.
+  */
+struct TinyMATWriterStructField {
+    inline TinyMATWriterStructField(const char* name_=NULL, const void* data_=NULL, int type_=TINYMAT_FIELD_DOUBLE, uint32_t count_=1) :
+      name(name_),
+      data(data_),
+      type(type_),
+      count(count_)
+    {
+    }
+
+    /** \brief name of the field (max. len: 31 characters) */
+    const char* name;
+    /** \brief the column of values */
+    const void* data;
+    /** \brief type of the values (\c TINYMAT_FIELD_DOUBLE ... \c TINYMAT_FIELD_STRING ) */
+    int type;
+    /** \brief number of values per element */
+    uint32_t count;
+};
+
+/*! \brief write an N-dimensional struct array (e.g. a table of records as 1 x N struct), whose fields are given as columns
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array (max. len: 31 characters)
+    \param sizes number of elements in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+    \param fields the \a nfields fields of the struct array
+    \param nfields number of fields
+
+    The elements are written in column-major order, each with the values of all fields, directly from the columns. All sizes are
+    computed in advance, so nothing has to be patched afterwards, and the many small field arrays are collected and written in bulk.
+
+    \code
+    std::vector<double> time(n), position(3*n);
+    std::vector<int32_t> id(n);
+    std::vector<const char*> label(n);
+    // ...
+    const TinyMATWriterStructField fields[4]={
+        TinyMATWriterStructField("time", time.data(), TINYMAT_FIELD_DOUBLE),
+        TinyMATWriterStructField("position", position.data(), TINYMAT_FIELD_DOUBLE, 3),
+        TinyMATWriterStructField("id", id.data(), TINYMAT_FIELD_INT32),
+        TinyMATWriterStructField("label", label.data(), TINYMAT_FIELD_STRING)
+    };
+    const int32_t sizes[2]={1, static_cast<int32_t>(n)};
+    TinyMATWriter_writeStructArray(mat, "records", sizes, 2, fields, 4);
+    // in MATLAB: records(5).position is a 1x3 vector
+    \endcode
+
+    \throws std::runtime_error if the type of a field is unknown, a field has no data or the struct array does not fit into 4 GB (the limit of a MAT v5 variable)
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeStructArray(TinyMATWriterFile* mat, const char* name, const int32_t* sizes, uint32_t ndims, const TinyMATWriterStructField* fields, uint32_t nfields);
+
+/*! \brief write an N-dimensional cell array of row vectors with different lengths (ragged data, e.g. traces), given as flat values with offsets
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array (max. len: 31 characters)
+    \param sizes number of elements in each dimension {rows, cols, matrices, ...}
+    \param ndims number of dimensions
+    \param values the values of all elements, one after the other in column-major order of the cell array
+    \param offsets the values of element \c i are \c values[offsets[i]] ... \c values[offsets[i+1]-1] (one offset more than elements)
+    \param type type of the values (\c TINYMAT_FIELD_DOUBLE ... \c TINYMAT_FIELD_LOGICAL, see TinyMATWriterStructField )
+
+    Each element is stored as 1 x n row vector. In contrast to writing the elements between TinyMATWriter_startCellArray() and
+    TinyMATWriter_endCellArray(), all sizes are computed in advance, so nothing has to be patched afterwards, and the elements
+    are written in bulk (directly into a single reservation of the output buffer, or block-wise, if the output goes into a file).
+
+    \throws std::runtime_error if \a type is unknown or a string, the offsets are decreasing, an element has more than 2^31-1 values or the cell array does not fit into 4 GB (the limit of a MAT v5 variable)
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const int32_t* sizes, uint32_t ndims, const void* values, const uint64_t* offsets, int type);
+
+/*! \brief write a vector of \c double vectors as 1 x N cell array of row vectors (see TinyMATWriter_writeRaggedCellArray() )
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array (max. len: 31 characters)
+    \param data the elements of the cell array
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<double> >& data);
+
+/*! \brief write a vector of \c float vectors as 1 x N cell array of \c single row vectors (see TinyMATWriter_writeRaggedCellArray() )
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array (max. len: 31 characters)
+    \param data the elements of the cell array
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeRaggedCellArray(TinyMATWriterFile* mat, const char* name, const std::vector<std::vector<float> >& data);
+
+
+
+
+/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a generic Cell-Array
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name variable name for the new array (max. len: 31 characters)
+\param sizes number of entries in each dimension {rows, cols, matrices, ...}
+\param ndims number of dimensions
+
+After a call to this function, simply use any TinyMATWriter-function to write the cell-array
+entires in column-major order with "name" left blanck. Finally close the array by calling 
+TinyMATWriter_endCellArray(). You can nest severall startCellArray/endCellAray-calls.
+
+*/
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_startCellArray(TinyMATWriterFile *mat, const char *name, const int32_t* sizes, uint32_t ndims);
+
+/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 1D Cell-Array (column)
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name variable name for the new array (max. len: 31 characters)
+\param nitems number of entries in the vector
+
+
+After a call to this function, simply use any TinyMATWriter-function to write the cell-array
+entries with "name" left blanck. Finally close the array by calling TinyMATWriter_endCellArray().
+You can nest severall startCellArray/endCellAray-calls.
+
+*/
+extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellVectorAsCol(TinyMATWriterFile *mat, const char *name, int32_t nitems) {
+  int32_t dims[2] = { nitems,1 };
+  TinyMATWriter_startCellArray(mat, name, dims, 2);
+}
+
+/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 1D Cell-Array (row)
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name variable name for the new array (max. len: 31 characters)
+\param nitems number of entries in the vector
+
+After a call to this function, simply use any TinyMATWriter-function to write the cell-array
+entries with "name" left blanck. Finally close the array by calling TinyMATWriter_endCellArray().
+You can nest severall startCellArray/endCellAray-calls.
+
+*/
+extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellVectorAsRow(TinyMATWriterFile *mat, const char *name, int32_t nitems) {
+  int32_t dims[2] = { 1,nitems };
+  TinyMATWriter_startCellArray(mat, name, dims, 2);
+}
+
+/*! \brief Low-Level-Interface for writing Cell-Arrays: starts a 2D Cell-Array
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name variable name for the new array (max. len: 31 characters)
+\param cols number of columns in the cell array
+\param rows number of rows in the cell array
+
+After a call to this function, simply use any TinyMATWriter-function to write the cell-array
+entires in column-major order with "name" left blanck. Finally close the array by calling
+TinyMATWriter_endCellArray(). You can nest severall startCellArray/endCellAray-calls.
+
+*/
+extern "C" TINYMATWRITER_EXPORT inline void TinyMATWriter_startCellMatrix2D(TinyMATWriterFile *mat, const char *name, int32_t cols, int32_t rows) {
+  int32_t dims[2] = { rows,cols };
+  TinyMATWriter_startCellArray(mat, name, dims, 2);
+}
+
+/*! \brief Low-Level-Interface zum Schrieben von Cell-Arrays: beendet das aktuelle Cell-Array
+\ingroup tinymatwriter
+
+\param mat the MAT-file to write into
+\param name struc the structure object to finish
+*/
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_endCellArray(TinyMATWriterFile* mat);
+
+
+
+#ifdef TINYMAT_USES_OPENCV
+/*! \brief write an OpenCV cv::Mat into a MAT-file as a matrix
+    \ingroup tinymatwriter_opencv
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param img the cv::Mat to write
+
+    Non-continuous matrices (regions of interest, padded rows) are gathered directly from \a img (see TinyMATWriter_writeMatrixND_view() ).
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeCVMat(TinyMATWriterFile* mat, const char* name, const cv::Mat& img);
+
+/*! \brief write a cv::Vec into a MAT-file as a row vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param vec the cv::Vec to write
+
+*/
+template <typename T, int cn>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVVecAsRow(TinyMATWriterFile* mat, const char* name, const cv::Vec<T, cn>& vec) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, vec.val, cn);
+}
+
+/*! \brief write a cv::Vec into a MAT-file as a column vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param vec the cv::Vec to write
+
+*/
+template <typename T, int cn>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVVecAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Vec<T, cn>& vec) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, vec.val, cn);
+}
+
+/*! \brief write a cv::Point_<T> as row-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the point to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPointAsRow(TinyMATWriterFile* mat, const char* name, const cv::Point_<T>& p) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y);
+}
+
+/*! \brief write a cv::Point_<T> as column-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the point to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPointAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Point_<T>& p) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y);
+}
+
+/*! \brief write a cv::Point3_<T> as column-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the point to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPoint3AsColumn(TinyMATWriterFile* mat, const char* name, const cv::Point3_<T>& p) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y, p.z);
+}
+
+
+
+/*! \brief write a cv::Point3_<T> as row-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the point to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVPoint3AsRow(TinyMATWriterFile* mat, const char* name, const cv::Point3_<T>& p) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y, p.z);
+}
+
+
+/*! \brief write a cv::Scalar_<T> as column-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the cv::Scalar_<T> to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVScalarAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Scalar_<T>& p) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p[0], p[1], p[2], p[3]);
+}
+
+
+
+/*! \brief write a cv::Scalar_<T> as row-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the cv::Scalar_<T> to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVScalarAsRow(TinyMATWriterFile* mat, const char* name, const cv::Scalar_<T>& p) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, p[0], p[1], p[2], p[3]);
+}
+
+
+/*! \brief write a cv::Size_<T> as row-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the size-object to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVSizeAsRow(TinyMATWriterFile* mat, const char* name, const cv::Size_<T>& p) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.width, p.height);
+}
+
+/*! \brief write a cv::Size_<T> as column-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the size-object to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVSizeAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Size_<T>& p) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.width, p.height);
+}
+
+
+/*! \brief write a cv::Rect_<T> as row-vector \c [x,y,width,height]
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the rectangle-object to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRectAsRow(TinyMATWriterFile* mat, const char* name, const cv::Rect_<T>& p) {
+  TinyMATWriter_writeVectorAsRow<T>(mat, name, p.x, p.y, p.width, p.height);
+}
+
+/*! \brief write a cv::Rect_<T> as column-vector \c [x;y;width;height]
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the rectangle-object to write
+
+*/
+template <typename T>
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRectAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Rect_<T>& p) {
+  TinyMATWriter_writeVectorAsColumn<T>(mat, name, p.x, p.y, p.width, p.height);
+}
+
+
+
+/*! \brief write a cv::Range as row-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the Range-object to write
+
+*/
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRangeAsRow(TinyMATWriterFile* mat, const char* name, const cv::Range& p) {
+  TinyMATWriter_writeVectorAsRow(mat, name, p.start, p.end);
+}
+
+/*! \brief write a cv::Range as column-vector
+\ingroup tinymatwriter_opencv
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param p the rectangle-object to write
+
+*/
+TINYMATWRITER_EXPORT inline void TinyMATWriter_writeCVRangeAsColumn(TinyMATWriterFile* mat, const char* name, const cv::Range& p) {
+  TinyMATWriter_writeVectorAsColumn(mat, name, p.start, p.end);
+}
+
+
+/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
+\ingroup tinymatwriter_opencv
+
+This is a performance-optimized specialization.
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param data_vec the array to write. This container has to implement the function size() and
+an iterator with tool-functions begin() and end()
+
+*/
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2d>& data_vec);
+
+/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
+\ingroup tinymatwriter_opencv
+
+This is a performance-optimized specialization.
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param data_vec the array to write. This container has to implement the function size() and
+an iterator with tool-functions begin() and end()
+
+*/
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2i>& data_vec);
+
+/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
+\ingroup tinymatwriter_opencv
+
+This is a performance-optimized specialization.
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param data_vec the array to write. This container has to implement the function size() and
+an iterator with tool-functions begin() and end()
+
+*/
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2f>& data_vec);
+
+/*! \brief write a 1-dimensional std::vector of values as a row-vector into a MAT-file
+\ingroup tinymatwriter_opencv
+
+This is a performance-optimized specialization.
+
+\param mat the MAT-file to write into
+\param name variable name for the new array
+\param data_vec the array to write. This container has to implement the function size() and
+an iterator with tool-functions begin() and end()
+
+*/
+template <>
+void TinyMATWriter_writeContainerAsRow(TinyMATWriterFile* mat, const char* name, const std::vector<cv::Point2l>& data_vec);
+
+#endif
+
+
+#ifdef TINYMAT_USES_QVARIANT
+/*! \brief write a 1-dimensional QVariantList into a MAT-file as a cell array
+    \ingroup tinymatwriter_qt
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantList(TinyMATWriterFile* mat, const char* name, const QVariantList& data);
+/*! \brief write a 1-dimensional QStringList into a MAT-file as a cell array
+    \ingroup tinymatwriter_qt
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeQStringList(TinyMATWriterFile* mat, const char* name, const QStringList& data);
+/*! \brief write a 1-dimensional QVariantList (as a list of columns) into a MAT-file as a cell array
+    \ingroup tinymatwriter_qt
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the array to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantMatrix_listofcols(TinyMATWriterFile* mat, const char* name, const QList<QList<QVariant> >& data);
+/*! \brief write a QVariantMap into a MAT-file as a struct
+    \ingroup tinymatwriter_qt
+
+    \param mat the MAT-file to write into
+    \param name variable name for the new array
+    \param data the map to write
+
+  */
+TINYMATWRITER_EXPORT void TinyMATWriter_writeQVariantMap(TinyMATWriterFile* mat, const char* name, const QVariantMap& data);
+
+#endif
+
+/*! \brief close a given MAT file
+    \ingroup tinymatwriter
+
+    \param tiff TIFF file to close
+
+    This function also releases memory allocated in TinyMATWriter_open() in \a tiff.
+ */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_close(TinyMATWriterFile* mat);
+
+/*! \brief close a given MAT file and hand the memory buffer with the complete file over to the caller
+    \ingroup tinymatwriter
+
+    \param mat the MAT-file to close (opened with TinyMATWriter_openMemory() or with \c TINYMAT_BACKEND_MEMORY )
+    \param[out] data receives the buffer, which has to be released with TinyMATWriter_freeBuffer()
+    \param[out] size receives the size of the file in bytes
+    \return \c TRUE on success. \c FALSE, if \a mat does not use \c TINYMAT_BACKEND_MEMORY or parts of the file have already been flushed
+            (see TinyMATWriter_setMemoryLimit() ), then \a data is set to \c NULL, but \a mat is closed anyway
+
+    The buffer is not copied, so it can be sent over the network or wrapped into a JavaScript \c Uint8Array directly.
+    If \a mat also has a file, it is written as with TinyMATWriter_close().
+ */
+extern "C" TINYMATWRITER_EXPORT int TinyMATWriter_closeAndTakeBuffer(TinyMATWriterFile* mat, uint8_t** data, size_t* size);
+
+/*! \brief releases a buffer returned by TinyMATWriter_closeAndTakeBuffer()
+    \ingroup tinymatwriter
+ */
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_freeBuffer(uint8_t* data);
+
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims);
+
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrix2D_rowmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows);
+
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeString_exp(TinyMATWriterFile* mat, const char* name, const char* data, uint32_t slen);
+
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrixND_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, const int32_t* sizes, uint32_t ndims);
+
+extern "C" TINYMATWRITER_EXPORT void TinyMATWriter_writeMatrix2D_colmajor_exp_double(TinyMATWriterFile* mat, const char* name, const double* data_real, int32_t cols, int32_t rows);
+
+extern "C" TINYMATWRITER_EXPORT long TinyMATWriter_ftell(TinyMATWriterFile* file);
+
+extern "C" TINYMATWRITER_EXPORT uint8_t* TinyMATWriter_data(TinyMATWriterFile* file);
+
+#endif // TINYMATWRITER_H